@@ -0,0 +1,125 @@
+// Code generation microbenchmark: generated C++ bytes per second
+//
+// Builds a synthetic program with many routines, analyzes it once per
+// iteration (untimed) and times CppGenerator::generate on it.
+
+#include "../include/lexer.h"
+#include "../include/parser.h"
+#include "../include/symbol_table.h"
+#include "../include/type_checker.h"
+#include "../include/cpp_generator.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace rpascal;
+
+namespace {
+
+std::string syntheticProgram(int routines) {
+    std::ostringstream src;
+    src << "program CodegenBench;\n\n"
+        << "type\n"
+        << "  TPoint = record\n"
+        << "    x, y: integer;\n"
+        << "  end;\n"
+        << "  TVec = array[1..16] of integer;\n\n"
+        << "var\n"
+        << "  total: integer;\n"
+        << "  v: TVec;\n\n";
+    for (int k = 0; k < routines; ++k) {
+        src << "function Work" << k << "(a: integer; b: integer): integer;\n"
+            << "var\n"
+            << "  i, acc: integer;\n"
+            << "  p: TPoint;\n"
+            << "begin\n"
+            << "  acc := 0;\n"
+            << "  for i := 1 to a do\n"
+            << "  begin\n"
+            << "    if (i mod 3 = 0) and (b > 0) then\n"
+            << "      acc := acc + i * b\n"
+            << "    else\n"
+            << "      acc := acc - i div 2;\n"
+            << "    v[(i mod 16) + 1] := acc;\n"
+            << "  end;\n"
+            << "  p.x := acc;\n"
+            << "  p.y := b;\n"
+            << "  Work" << k << " := p.x + p.y;\n"
+            << "end;\n\n";
+    }
+    src << "begin\n"
+        << "  total := 0;\n";
+    for (int k = 0; k < routines; ++k) {
+        src << "  total := total + Work" << k << "(" << (k + 5) << ", " << (k % 7) << ");\n";
+    }
+    src << "  writeln('total = ', total);\n"
+        << "end.\n";
+    return src.str();
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [--routines N] [--iterations N] [--serial]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int routines = 2000;
+    int iterations = 10;
+    bool serial = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--routines" && i + 1 < argc) {
+            routines = std::atoi(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else if (arg == "--serial") {
+            serial = true;
+        } else {
+            printUsage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::string source = syntheticProgram(routines);
+    Parser parser(std::make_unique<Lexer>(source));
+    auto program = parser.parseProgram();
+    if (parser.hasErrors() || !program) {
+        std::cerr << "Synthetic program failed to parse\n";
+        return 1;
+    }
+
+    size_t totalBytes = 0;
+    std::chrono::duration<double> elapsed{0};
+    for (int iter = 0; iter < iterations; ++iter) {
+        // Code generation defines symbols as it goes, so every run starts
+        // from a freshly analyzed table
+        auto symbolTable = std::make_shared<SymbolTable>();
+        SemanticAnalyzer analyzer(symbolTable);
+        if (!analyzer.analyze(*program)) {
+            std::cerr << "Synthetic program failed semantic analysis\n";
+            return 1;
+        }
+
+        CppGenerator generator(symbolTable, analyzer.getUnitLoader());
+        generator.setParallelRoutines(!serial);
+        auto start = std::chrono::steady_clock::now();
+        std::string code = generator.generate(*program);
+        elapsed += std::chrono::steady_clock::now() - start;
+        totalBytes += code.size();
+    }
+
+    double seconds = elapsed.count();
+    double bytesPerSecond = seconds > 0 ? static_cast<double>(totalBytes) / seconds : 0.0;
+    std::cout << "benchmark=codegen"
+              << " routines=" << routines
+              << " iterations=" << iterations
+              << " mode=" << (serial ? "serial" : "parallel")
+              << " bytes=" << totalBytes
+              << " seconds=" << seconds
+              << " bytes_per_second=" << static_cast<long long>(bytesPerSecond) << "\n";
+    return 0;
+}
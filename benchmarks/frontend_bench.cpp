@@ -0,0 +1,212 @@
+// Frontend scaling benchmark
+//
+// Generates a synthetic program (see synthetic_program.h), then times each
+// compiler phase separately: lexing and parsing the program, semantic
+// analysis (which also loads the used units) and C++ generation, and
+// optionally the backend C++ compiler. Prints one JSON object per run with
+// the median time of each phase, so results can be compared across commits.
+
+#include "../include/lexer.h"
+#include "../include/parser.h"
+#include "../include/symbol_table.h"
+#include "../include/type_checker.h"
+#include "../include/cpp_generator.h"
+#include "synthetic_program.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace rpascal;
+using namespace rpascal::bench;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+bool writeFile(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+    return static_cast<bool>(file);
+}
+
+bool writeProject(const SyntheticProject& project, const std::filesystem::path& dir) {
+    std::filesystem::create_directories(dir);
+    bool ok = writeFile(dir / project.program.fileName, project.program.source);
+    for (const auto& unit : project.units) {
+        ok = writeFile(dir / unit.fileName, unit.source) && ok;
+    }
+    return ok;
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "Program shape:\n"
+              << "  --procedures N      Top-level functions (default 200)\n"
+              << "  --depth N           Nested loop depth in each function (default 3)\n"
+              << "  --records N         Record types (default 10)\n"
+              << "  --no-sets           Leave out set and case statements\n"
+              << "  --units N           Used units (default 2)\n"
+              << "  --unit-functions N  Functions per unit (default 20)\n"
+              << "Run:\n"
+              << "  --iterations N      Runs per phase; the median is reported (default 5)\n"
+              << "  --backend           Also time the C++ compiler on the generated code\n"
+              << "  --cxx <compiler>    Backend compiler (default $CXX or g++)\n"
+              << "  --work-dir <dir>    Where generated files are written\n"
+              << "  --emit <dir>        Only write the synthetic sources to <dir> and exit\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    SyntheticOptions shape;
+    int iterations = 5;
+    bool backend = false;
+    const char* cxxEnv = std::getenv("CXX");
+    std::string cxx = cxxEnv && *cxxEnv ? cxxEnv : "g++";
+    std::filesystem::path workDir = std::filesystem::temp_directory_path() / "rpascal_bench";
+    std::string emitDir;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--procedures" && hasValue) {
+            shape.procedures = std::atoi(argv[++i]);
+        } else if (arg == "--depth" && hasValue) {
+            shape.nestingDepth = std::atoi(argv[++i]);
+        } else if (arg == "--records" && hasValue) {
+            shape.records = std::atoi(argv[++i]);
+        } else if (arg == "--no-sets") {
+            shape.setsAndCases = false;
+        } else if (arg == "--units" && hasValue) {
+            shape.units = std::atoi(argv[++i]);
+        } else if (arg == "--unit-functions" && hasValue) {
+            shape.unitFunctions = std::atoi(argv[++i]);
+        } else if (arg == "--iterations" && hasValue) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--backend") {
+            backend = true;
+        } else if (arg == "--cxx" && hasValue) {
+            cxx = argv[++i];
+        } else if (arg == "--work-dir" && hasValue) {
+            workDir = argv[++i];
+        } else if (arg == "--emit" && hasValue) {
+            emitDir = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    SyntheticProject project = generateSyntheticProject(shape);
+    if (!emitDir.empty()) {
+        if (!writeProject(project, emitDir)) {
+            std::cerr << "Error: Could not write synthetic sources to " << emitDir << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (!writeProject(project, workDir)) {
+        std::cerr << "Error: Could not write synthetic sources to " << workDir.string() << "\n";
+        return 1;
+    }
+
+    std::map<std::string, std::vector<double>> timings;
+    size_t tokenCount = 0;
+    size_t generatedBytes = 0;
+    const std::string& source = project.program.source;
+
+    for (int iter = 0; iter < iterations; ++iter) {
+        auto start = Clock::now();
+        std::vector<Token> tokens = Lexer(source).tokenizeAll();
+        timings["lex"].push_back(secondsSince(start));
+        tokenCount = tokens.size();
+
+        start = Clock::now();
+        Parser parser(std::make_unique<Lexer>(std::move(tokens)));
+        auto program = parser.parseProgram();
+        timings["parse"].push_back(secondsSince(start));
+        if (parser.hasErrors() || !program) {
+            std::cerr << "Error: Synthetic program failed to parse\n";
+            return 1;
+        }
+
+        start = Clock::now();
+        auto symbolTable = std::make_shared<SymbolTable>();
+        SemanticAnalyzer analyzer(symbolTable);
+        analyzer.getUnitLoader()->setCacheEnabled(false);
+        analyzer.getUnitLoader()->setSearchPaths({workDir.string()});
+        bool analyzed = analyzer.analyze(*program);
+        timings["analyze"].push_back(secondsSince(start));
+        if (!analyzed || analyzer.hasErrors()) {
+            std::cerr << "Error: Synthetic program failed semantic analysis\n";
+            for (const auto& error : analyzer.getErrors()) {
+                std::cerr << "  " << error << "\n";
+            }
+            return 1;
+        }
+
+        start = Clock::now();
+        CppGenerator generator(symbolTable, analyzer.getUnitLoader());
+        std::string cppCode = generator.generate(*program);
+        timings["codegen"].push_back(secondsSince(start));
+        generatedBytes = cppCode.size();
+
+        if (backend) {
+            std::filesystem::path cppFile = workDir / "synthetic.cpp";
+            std::filesystem::path exeFile = workDir / "synthetic";
+            writeFile(cppFile, cppCode);
+            std::string command = cxx + " -std=c++17 -O2 \"" + cppFile.string() + "\" -o \"" + exeFile.string() + "\"";
+            start = Clock::now();
+            int status = std::system(command.c_str());
+            timings["backend"].push_back(secondsSince(start));
+            if (status != 0) {
+                std::cerr << "Error: Backend compiler failed: " << command << "\n";
+                return 1;
+            }
+        }
+    }
+
+    double frontend = median(timings["lex"]) + median(timings["parse"]) +
+                      median(timings["analyze"]) + median(timings["codegen"]);
+    std::cout << "{\"benchmark\":\"frontend\""
+              << ",\"procedures\":" << shape.procedures
+              << ",\"depth\":" << shape.nestingDepth
+              << ",\"records\":" << shape.records
+              << ",\"sets_and_cases\":" << (shape.setsAndCases ? "true" : "false")
+              << ",\"units\":" << shape.units
+              << ",\"unit_functions\":" << shape.unitFunctions
+              << ",\"iterations\":" << iterations
+              << ",\"source_bytes\":" << source.size()
+              << ",\"tokens\":" << tokenCount
+              << ",\"generated_bytes\":" << generatedBytes
+              << ",\"seconds\":{";
+    for (const char* phase : {"lex", "parse", "analyze", "codegen"}) {
+        std::cout << "\"" << phase << "\":" << median(timings[phase]) << ",";
+    }
+    std::cout << "\"frontend\":" << frontend;
+    if (backend) {
+        std::cout << ",\"backend\":" << median(timings["backend"])
+                  << ",\"total\":" << frontend + median(timings["backend"]);
+    }
+    std::cout << "}}\n";
+    return 0;
+}
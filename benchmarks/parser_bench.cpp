@@ -0,0 +1,113 @@
+// Expression parsing microbenchmark: source bytes parsed per second
+//
+// Builds an expression-heavy synthetic program (many mixed-precedence
+// assignments plus one very long table-initializer style sum), lexes it
+// once and times parsing the token stream.
+
+#include "../include/lexer.h"
+#include "../include/parser.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace rpascal;
+
+namespace {
+
+std::string syntheticProgram(int statements, int terms, int chainLength) {
+    static const char* ops[] = {" + ", " * ", " - ", " div ", " mod ", " + "};
+    std::ostringstream src;
+    src << "program ParserBench;\n\n"
+        << "var\n"
+        << "  a, b, c, total: integer;\n"
+        << "  flag: boolean;\n\n"
+        << "begin\n"
+        << "  a := 3;\n"
+        << "  b := 5;\n"
+        << "  c := 7;\n";
+    for (int s = 0; s < statements; ++s) {
+        src << "  total := ";
+        for (int t = 0; t < terms; ++t) {
+            if (t > 0) {
+                src << ops[(s + t) % 6];
+            }
+            if (t % 4 == 3) {
+                src << "(a - " << t << ")";
+            } else {
+                src << (t % 3 == 0 ? "a" : t % 3 == 1 ? "b" : "c");
+            }
+        }
+        src << ";\n";
+        src << "  flag := (total > a) and (b <= c) or not (a = " << s << ");\n";
+    }
+    src << "  total := 0";
+    for (int i = 0; i < chainLength; ++i) {
+        src << " + " << (i % 97);
+    }
+    src << ";\n"
+        << "  writeln(total);\n"
+        << "end.\n";
+    return src.str();
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName
+              << " [--statements N] [--terms N] [--chain N] [--iterations N]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int statements = 5000;
+    int terms = 24;
+    int chainLength = 20000;
+    int iterations = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--statements" && i + 1 < argc) {
+            statements = std::atoi(argv[++i]);
+        } else if (arg == "--terms" && i + 1 < argc) {
+            terms = std::atoi(argv[++i]);
+        } else if (arg == "--chain" && i + 1 < argc) {
+            chainLength = std::atoi(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::atoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::string source = syntheticProgram(statements, terms, chainLength);
+    std::vector<Token> tokens = Lexer(source).tokenizeAll();
+    std::chrono::duration<double> elapsed{0};
+    for (int iter = 0; iter < iterations; ++iter) {
+        auto lexer = std::make_unique<Lexer>(tokens);
+        auto start = std::chrono::steady_clock::now();
+        Parser parser(std::move(lexer));
+        auto program = parser.parseProgram();
+        elapsed += std::chrono::steady_clock::now() - start;
+        if (parser.hasErrors() || !program) {
+            std::cerr << "Synthetic program failed to parse\n";
+            return 1;
+        }
+    }
+
+    double seconds = elapsed.count();
+    size_t totalBytes = source.size() * static_cast<size_t>(iterations);
+    double bytesPerSecond = seconds > 0 ? static_cast<double>(totalBytes) / seconds : 0.0;
+    std::cout << "benchmark=parser"
+              << " statements=" << statements
+              << " terms=" << terms
+              << " chain=" << chainLength
+              << " iterations=" << iterations
+              << " tokens=" << tokens.size()
+              << " bytes=" << totalBytes
+              << " seconds=" << seconds
+              << " bytes_per_second=" << static_cast<long long>(bytesPerSecond) << "\n";
+    return 0;
+}
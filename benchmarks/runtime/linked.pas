@@ -0,0 +1,51 @@
+program LinkedAlloc;
+
+{ Allocation-heavy linked list building, traversal and disposal }
+
+type
+  PNode = ^TNode;
+  TNode = record
+    value: integer;
+    next: PNode;
+  end;
+
+const
+  Rounds = 50;
+  Nodes = 100000;
+
+var
+  head, node, nextNode: PNode;
+  pass, i, count, checksum: integer;
+
+begin
+  checksum := 0;
+  for pass := 1 to Rounds do
+  begin
+    head := nil;
+    for i := 1 to Nodes do
+    begin
+      new(node);
+      node^.value := (i * 7 + pass) mod 1000;
+      node^.next := head;
+      head := node;
+    end;
+
+    count := 0;
+    node := head;
+    while node <> nil do
+    begin
+      checksum := (checksum + node^.value) mod 1000000;
+      count := count + 1;
+      node := node^.next;
+    end;
+
+    while head <> nil do
+    begin
+      nextNode := head^.next;
+      dispose(head);
+      head := nextNode;
+    end;
+  end;
+  writeln('nodes per round: ', count);
+  writeln('checksum: ', checksum);
+end.
@@ -0,0 +1,110 @@
+program NBody;
+
+{ Planetary n-body simulation with records of reals }
+
+const
+  Bodies = 5;
+  Steps = 2000000;
+  SolarMass = 39.47841760435743;
+  DaysPerYear = 365.24;
+
+type
+  TBody = record
+    x, y, z: real;
+    vx, vy, vz: real;
+    mass: real;
+  end;
+
+var
+  bodies: array[1..5] of TBody;
+  step: integer;
+
+procedure InitBodies(scale: real);
+var
+  i: integer;
+begin
+  bodies[1].x := 0.0; bodies[1].y := 0.0; bodies[1].z := 0.0;
+  bodies[1].vx := 0.0; bodies[1].vy := 0.0; bodies[1].vz := 0.0;
+  bodies[1].mass := 1.0;
+
+  bodies[2].x := 4.84143144246472090; bodies[2].y := -1.16032004402742839; bodies[2].z := -0.103622044471123109;
+  bodies[2].vx := 0.00166007664274403694; bodies[2].vy := 0.00769901118419740425; bodies[2].vz := -0.0000690460016972063023;
+  bodies[2].mass := 0.000954791938424326609;
+
+  bodies[3].x := 8.34336671824457987; bodies[3].y := 4.12479856412430479; bodies[3].z := -0.403523417114321381;
+  bodies[3].vx := -0.00276742510726862411; bodies[3].vy := 0.00499852801234917238; bodies[3].vz := 0.0000230417297573763929;
+  bodies[3].mass := 0.000285885980666130812;
+
+  bodies[4].x := 12.8943695621391310; bodies[4].y := -15.1111514016986312; bodies[4].z := -0.223307578892655734;
+  bodies[4].vx := 0.00296460137564761618; bodies[4].vy := 0.00237847173959480950; bodies[4].vz := -0.0000296589568540237556;
+  bodies[4].mass := 0.0000436624404335156298;
+
+  bodies[5].x := 15.3796971148509165; bodies[5].y := -25.9193146099879641; bodies[5].z := 0.179258772950371181;
+  bodies[5].vx := 0.00268067772490389322; bodies[5].vy := 0.00162824170038242295; bodies[5].vz := -0.0000951592254519715870;
+  bodies[5].mass := 0.0000515138902046611451;
+
+  for i := 1 to Bodies do
+  begin
+    bodies[i].vx := bodies[i].vx * scale;
+    bodies[i].vy := bodies[i].vy * scale;
+    bodies[i].vz := bodies[i].vz * scale;
+    bodies[i].mass := bodies[i].mass * SolarMass;
+  end;
+end;
+
+function Energy(): real;
+var
+  i, j: integer;
+  e, dx, dy, dz: real;
+begin
+  e := 0.0;
+  for i := 1 to Bodies do
+  begin
+    e := e + 0.5 * bodies[i].mass *
+      (bodies[i].vx * bodies[i].vx + bodies[i].vy * bodies[i].vy + bodies[i].vz * bodies[i].vz);
+    for j := i + 1 to Bodies do
+    begin
+      dx := bodies[i].x - bodies[j].x;
+      dy := bodies[i].y - bodies[j].y;
+      dz := bodies[i].z - bodies[j].z;
+      e := e - bodies[i].mass * bodies[j].mass / sqrt(dx * dx + dy * dy + dz * dz);
+    end;
+  end;
+  Energy := e;
+end;
+
+procedure Advance(dt: real);
+var
+  i, j: integer;
+  dx, dy, dz, dist2, mag: real;
+begin
+  for i := 1 to Bodies do
+    for j := i + 1 to Bodies do
+    begin
+      dx := bodies[i].x - bodies[j].x;
+      dy := bodies[i].y - bodies[j].y;
+      dz := bodies[i].z - bodies[j].z;
+      dist2 := dx * dx + dy * dy + dz * dz;
+      mag := dt / (dist2 * sqrt(dist2));
+      bodies[i].vx := bodies[i].vx - dx * bodies[j].mass * mag;
+      bodies[i].vy := bodies[i].vy - dy * bodies[j].mass * mag;
+      bodies[i].vz := bodies[i].vz - dz * bodies[j].mass * mag;
+      bodies[j].vx := bodies[j].vx + dx * bodies[i].mass * mag;
+      bodies[j].vy := bodies[j].vy + dy * bodies[i].mass * mag;
+      bodies[j].vz := bodies[j].vz + dz * bodies[i].mass * mag;
+    end;
+  for i := 1 to Bodies do
+  begin
+    bodies[i].x := bodies[i].x + dt * bodies[i].vx;
+    bodies[i].y := bodies[i].y + dt * bodies[i].vy;
+    bodies[i].z := bodies[i].z + dt * bodies[i].vz;
+  end;
+end;
+
+begin
+  InitBodies(DaysPerYear);
+  writeln('energy before: ', Energy():0:9);
+  for step := 1 to Steps do
+    Advance(0.01);
+  writeln('energy after:  ', Energy():0:9);
+end.
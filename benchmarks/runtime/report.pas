@@ -0,0 +1,30 @@
+program ReportWriter;
+
+{ Formatted text report written to a file }
+
+const
+  Rows = 1000000;
+
+var
+  report: text;
+  i, total: integer;
+  amount: real;
+
+begin
+  total := 0;
+  assign(report, 'report.txt');
+  rewrite(report);
+  writeln(report, 'Quarterly report');
+  writeln(report, '================');
+  for i := 1 to Rows do
+  begin
+    amount := (i mod 1000) * 1.25;
+    total := (total + (i * 37) mod 10000) mod 1000000;
+    writeln(report, 'Row ', i:8, '  account ', (i * 37) mod 10000:6, '  amount ', amount:10:2);
+  end;
+  writeln(report, 'End of report');
+  close(report);
+
+  writeln('rows: ', Rows);
+  writeln('total: ', total);
+end.
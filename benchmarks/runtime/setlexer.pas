@@ -0,0 +1,66 @@
+program SetLexer;
+
+{ Character-class scanning driven by set membership }
+
+type
+  TCharSet = set of char;
+
+const
+  Passes = 40;
+
+var
+  source: string;
+  letters, digits, spaces, operators: TCharSet;
+  i, pass, identifiers, numbers, symbols, whitespace: integer;
+  c: char;
+
+begin
+  letters := ['a'..'z', 'A'..'Z', '_'];
+  digits := ['0', '1', '2', '3', '4', '5', '6', '7', '8', '9'];
+  spaces := [' ', #9, #10, #13];
+  operators := ['+', '-', '*', '/', '=', '<', '>', '(', ')', ';', ':', ',', '.'];
+
+  source := '';
+  for i := 1 to 200 do
+    source := source + 'total := total + value_' + inttostr(i) + ' * (x1 - 42) / rate;' + #10;
+
+  identifiers := 0;
+  numbers := 0;
+  symbols := 0;
+  whitespace := 0;
+  for pass := 1 to Passes do
+  begin
+    i := 1;
+    while i <= length(source) do
+    begin
+      c := source[i];
+      if c in letters then
+      begin
+        while (i <= length(source)) and ((source[i] in letters) or (source[i] in digits)) do
+          i := i + 1;
+        identifiers := identifiers + 1;
+      end
+      else if c in digits then
+      begin
+        while (i <= length(source)) and (source[i] in digits) do
+          i := i + 1;
+        numbers := numbers + 1;
+      end
+      else if c in spaces then
+      begin
+        whitespace := whitespace + 1;
+        i := i + 1;
+      end
+      else
+      begin
+        if c in operators then
+          symbols := symbols + 1;
+        i := i + 1;
+      end;
+    end;
+  end;
+  writeln('identifiers: ', identifiers);
+  writeln('numbers: ', numbers);
+  writeln('symbols: ', symbols);
+  writeln('whitespace: ', whitespace);
+end.
@@ -0,0 +1,39 @@
+program Sieve;
+
+{ Sieve of Eratosthenes over a large global boolean array, repeated }
+
+const
+  Limit = 2000000;
+  Rounds = 40;
+
+var
+  composite: array[0..2000000] of boolean;
+  i, j, pass, count: integer;
+
+begin
+  count := 0;
+  for pass := 1 to Rounds do
+  begin
+    for i := 0 to Limit do
+      composite[i] := false;
+    count := 0;
+    i := 2;
+    while i * i <= Limit do
+    begin
+      if not composite[i] then
+      begin
+        j := i * i;
+        while j <= Limit do
+        begin
+          composite[j] := true;
+          j := j + i;
+        end;
+      end;
+      i := i + 1;
+    end;
+    for i := 2 to Limit do
+      if not composite[i] then
+        count := count + 1;
+  end;
+  writeln('primes below ', Limit, ': ', count);
+end.
@@ -0,0 +1,39 @@
+program StringWork;
+
+{ String building, searching and number parsing }
+
+const
+  Records = 1000000;
+
+var
+  line, field: string;
+  i, p, k, value, total, lengthSum: integer;
+
+begin
+  total := 0;
+  lengthSum := 0;
+  for i := 1 to Records do
+  begin
+    { Build a comma separated record }
+    line := 'item' + inttostr(i) + ',' + inttostr(i) + ',' + inttostr(i mod 97) + ',end';
+    lengthSum := lengthSum + length(line);
+
+    { Parse it back: the second field with strtoint, the third by hand }
+    p := pos(',', line);
+    line := copy(line, p + 1, length(line) - p);
+    p := pos(',', line);
+    field := copy(line, 1, p - 1);
+    total := total + strtoint(field) mod 1000;
+    line := copy(line, p + 1, length(line) - p);
+    value := 0;
+    k := 1;
+    while (k <= length(line)) and (line[k] >= '0') and (line[k] <= '9') do
+    begin
+      value := value * 10 + ord(line[k]) - ord('0');
+      k := k + 1;
+    end;
+    total := total + value;
+  end;
+  writeln('characters: ', lengthSum);
+  writeln('checksum: ', total);
+end.
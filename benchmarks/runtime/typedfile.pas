@@ -0,0 +1,51 @@
+program TypedFileScan;
+
+{ Write a typed file of records, then scan it several times }
+
+type
+  TSample = record
+    id: integer;
+    reading: integer;
+  end;
+  TSampleFile = file of TSample;
+
+const
+  Samples = 1000000;
+  Scans = 10;
+
+var
+  f: TSampleFile;
+  sample: TSample;
+  i, scan, count, maxReading, total: integer;
+
+begin
+  assign(f, 'typedfile.dat');
+  rewrite(f);
+  for i := 1 to Samples do
+  begin
+    sample.id := i;
+    sample.reading := (i * 31) mod 977;
+    write(f, sample);
+  end;
+  close(f);
+
+  total := 0;
+  maxReading := 0;
+  for scan := 1 to Scans do
+  begin
+    reset(f);
+    count := 0;
+    while not eof(f) do
+    begin
+      read(f, sample);
+      count := count + 1;
+      total := (total + sample.reading) mod 1000000;
+      if sample.reading > maxReading then
+        maxReading := sample.reading;
+    end;
+    close(f);
+  end;
+  writeln('records: ', count);
+  writeln('max reading: ', maxReading);
+  writeln('checksum: ', total);
+end.
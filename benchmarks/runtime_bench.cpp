@@ -0,0 +1,273 @@
+// Runtime benchmark harness for generated executables
+//
+// Compiles every program in the runtime corpus (benchmarks/runtime/*.pas)
+// with bin/rpascal, runs each several times and reports the median wall
+// time, peak resident set size and executable size, next to the values in
+// a stored baseline file.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Measurement {
+    double seconds = 0.0;
+    long peakRssKb = 0;
+    long long binaryBytes = 0;
+};
+
+struct RunResult {
+    bool ok = false;
+    double seconds = 0.0;
+    long peakRssKb = 0;
+};
+
+// Run a program in workDir with its output discarded
+RunResult runProcess(const std::vector<std::string>& args, const fs::path& workDir) {
+    RunResult result;
+    auto start = std::chrono::steady_clock::now();
+#ifdef _WIN32
+    std::string command = "cd /d \"" + workDir.string() + "\" &&";
+    for (const auto& arg : args) {
+        command += " \"" + arg + "\"";
+    }
+    command += " >NUL 2>&1";
+    result.ok = std::system(command.c_str()) == 0;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+#else
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (chdir(workDir.c_str()) != 0) {
+            _exit(127);
+        }
+        int devNull = open("/dev/null", O_WRONLY);
+        if (devNull >= 0) {
+            dup2(devNull, STDOUT_FILENO);
+            dup2(devNull, STDERR_FILENO);
+        }
+        std::vector<char*> argv;
+        for (const auto& arg : args) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    if (pid < 0) {
+        return result;
+    }
+    int status = 0;
+    struct rusage usage {};
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        return result;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#ifdef __APPLE__
+    result.peakRssKb = usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    result.peakRssKb = usage.ru_maxrss;        // kilobytes on Linux
+#endif
+#endif
+    return result;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+// Baseline file: one "name seconds peak_rss_kb binary_bytes" line per program
+std::map<std::string, Measurement> readBaseline(const fs::path& path) {
+    std::map<std::string, Measurement> baseline;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string name;
+        Measurement m;
+        if (fields >> name >> m.seconds >> m.peakRssKb >> m.binaryBytes) {
+            baseline[name] = m;
+        }
+    }
+    return baseline;
+}
+
+bool writeBaseline(const fs::path& path, const std::map<std::string, Measurement>& results) {
+    std::ofstream file(path);
+    file << "# name median_seconds peak_rss_kb binary_bytes\n";
+    for (const auto& [name, m] : results) {
+        file << name << " " << m.seconds << " " << m.peakRssKb << " " << m.binaryBytes << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+std::string percentChange(double current, double base) {
+    if (base <= 0.0) {
+        return "n/a";
+    }
+    std::ostringstream out;
+    out << std::showpos << std::fixed << std::setprecision(1) << (current - base) * 100.0 / base << "%";
+    return out.str();
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "  --rpascal <path>     Compiler to benchmark (default bin/rpascal)\n"
+              << "  --corpus <dir>       Directory of benchmark programs (default benchmarks/runtime)\n"
+              << "  --work-dir <dir>     Scratch directory for executables and their files\n"
+              << "  --runs N             Runs per program; the median is reported (default 5)\n"
+              << "  --baseline <file>    Baseline to compare against (default <corpus>/baseline.txt)\n"
+              << "  --update-baseline    Store this run's results as the new baseline\n"
+              << "  --filter <text>      Only run programs whose name contains <text>\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    fs::path rpascal = "bin/rpascal";
+    fs::path corpus = "benchmarks/runtime";
+    fs::path workDir = fs::temp_directory_path() / "rpascal_runtime_bench";
+    fs::path baselinePath;
+    int runs = 5;
+    bool updateBaseline = false;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--rpascal" && hasValue) {
+            rpascal = argv[++i];
+        } else if (arg == "--corpus" && hasValue) {
+            corpus = argv[++i];
+        } else if (arg == "--work-dir" && hasValue) {
+            workDir = argv[++i];
+        } else if (arg == "--runs" && hasValue) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--baseline" && hasValue) {
+            baselinePath = argv[++i];
+        } else if (arg == "--update-baseline") {
+            updateBaseline = true;
+        } else if (arg == "--filter" && hasValue) {
+            filter = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    if (baselinePath.empty()) {
+        baselinePath = corpus / "baseline.txt";
+    }
+    if (!fs::exists(rpascal)) {
+        std::cerr << "Error: Compiler not found: " << rpascal.string() << "\n";
+        return 1;
+    }
+    rpascal = fs::absolute(rpascal);
+
+    std::vector<fs::path> programs;
+    for (const auto& entry : fs::directory_iterator(corpus)) {
+        if (entry.path().extension() == ".pas" &&
+            entry.path().stem().string().find(filter) != std::string::npos) {
+            programs.push_back(entry.path());
+        }
+    }
+    std::sort(programs.begin(), programs.end());
+    if (programs.empty()) {
+        std::cerr << "Error: No benchmark programs in " << corpus.string() << "\n";
+        return 1;
+    }
+
+    fs::create_directories(workDir);
+    auto baseline = readBaseline(baselinePath);
+    std::map<std::string, Measurement> results;
+    bool failed = false;
+
+    std::cout << std::left << std::setw(12) << "program"
+              << std::right << std::setw(11) << "median s" << std::setw(9) << "vs base"
+              << std::setw(12) << "peak KiB" << std::setw(9) << "vs base"
+              << std::setw(12) << "bytes" << std::setw(9) << "vs base" << "\n";
+
+    for (const auto& source : programs) {
+        std::string name = source.stem().string();
+        fs::path localSource = workDir / source.filename();
+        fs::copy_file(source, localSource, fs::copy_options::overwrite_existing);
+        fs::path executable = workDir / name;
+#ifdef _WIN32
+        executable += ".exe";
+#endif
+
+        RunResult build = runProcess({rpascal.string(), localSource.filename().string(), "-o", executable.string()}, workDir);
+        if (!build.ok || !fs::exists(executable)) {
+            std::cerr << name << ": compilation failed\n";
+            failed = true;
+            continue;
+        }
+
+        std::vector<double> times;
+        long peakRss = 0;
+        for (int run = 0; run < runs; ++run) {
+            RunResult result = runProcess({executable.string()}, workDir);
+            if (!result.ok) {
+                std::cerr << name << ": run failed\n";
+                failed = true;
+                break;
+            }
+            times.push_back(result.seconds);
+            peakRss = std::max(peakRss, result.peakRssKb);
+        }
+        if (static_cast<int>(times.size()) != runs) {
+            continue;
+        }
+
+        Measurement m;
+        m.seconds = median(times);
+        m.peakRssKb = peakRss;
+        m.binaryBytes = static_cast<long long>(fs::file_size(executable));
+        results[name] = m;
+
+        auto base = baseline.find(name);
+        bool hasBase = base != baseline.end();
+        std::cout << std::left << std::setw(12) << name << std::right
+                  << std::setw(11) << std::fixed << std::setprecision(4) << m.seconds
+                  << std::setw(9) << (hasBase ? percentChange(m.seconds, base->second.seconds) : "new")
+                  << std::setw(12) << m.peakRssKb
+                  << std::setw(9) << (hasBase ? percentChange(static_cast<double>(m.peakRssKb), static_cast<double>(base->second.peakRssKb)) : "new")
+                  << std::setw(12) << m.binaryBytes
+                  << std::setw(9) << (hasBase ? percentChange(static_cast<double>(m.binaryBytes), static_cast<double>(base->second.binaryBytes)) : "new")
+                  << "\n";
+    }
+
+    if (updateBaseline) {
+        // Keep entries for programs that were filtered out of this run
+        for (const auto& [name, m] : results) {
+            baseline[name] = m;
+        }
+        if (!writeBaseline(baselinePath, baseline)) {
+            std::cerr << "Error: Could not write baseline " << baselinePath.string() << "\n";
+            return 1;
+        }
+        std::cout << "Baseline written to " << baselinePath.string() << "\n";
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+#include "synthetic_program.h"
+#include <sstream>
+
+namespace rpascal {
+namespace bench {
+
+namespace {
+
+std::string unitName(int unit) {
+    return "SynUnit" + std::to_string(unit);
+}
+
+std::string unitFunctionName(int unit, int function) {
+    return "Unit" + std::to_string(unit) + "Fn" + std::to_string(function);
+}
+
+SyntheticFile generateUnit(const SyntheticOptions& options, int unit) {
+    std::ostringstream src;
+    src << "unit " << unitName(unit) << ";\n\n"
+        << "interface\n\n";
+    for (int f = 0; f < options.unitFunctions; ++f) {
+        src << "function " << unitFunctionName(unit, f) << "(x: integer): integer;\n";
+    }
+    src << "\nimplementation\n\n";
+    for (int f = 0; f < options.unitFunctions; ++f) {
+        src << "function " << unitFunctionName(unit, f) << "(x: integer): integer;\n"
+            << "begin\n"
+            << "  " << unitFunctionName(unit, f) << " := x * " << (f + 2) << " + " << unit << ";\n"
+            << "end;\n\n";
+    }
+    src << "end.\n";
+    return {unitName(unit) + ".pas", src.str()};
+}
+
+// Nested for loops with an if/else at the innermost level
+void generateNestedBlock(std::ostringstream& src, int depth, int level, const std::string& indent) {
+    if (level == depth) {
+        std::string inner = depth > 0 ? "i" + std::to_string(depth - 1) : "x";
+        src << indent << "if (" << inner << " + x) mod 2 = 0 then\n"
+            << indent << "  acc := acc + " << inner << "\n"
+            << indent << "else\n"
+            << indent << "  acc := acc - 1;\n";
+        return;
+    }
+    src << indent << "for i" << level << " := 1 to 3 do\n"
+        << indent << "begin\n";
+    generateNestedBlock(src, depth, level + 1, indent + "  ");
+    src << indent << "end;\n";
+}
+
+void generateFunction(std::ostringstream& src, const SyntheticOptions& options, int index) {
+    std::string name = "Proc" + std::to_string(index);
+    src << "function " << name << "(x: integer): integer;\n"
+        << "var\n"
+        << "  acc: integer;\n";
+    for (int level = 0; level < options.nestingDepth; ++level) {
+        src << "  i" << level << ": integer;\n";
+    }
+    if (options.setsAndCases) {
+        src << "  digits: TDigits;\n";
+    }
+    src << "begin\n"
+        << "  acc := 0;\n";
+    generateNestedBlock(src, options.nestingDepth, 0, "  ");
+
+    if (options.setsAndCases) {
+        src << "  digits := [1, 3, 5, " << (index % 10) << "];\n"
+            << "  case x mod 4 of\n"
+            << "    0: acc := acc + 1;\n"
+            << "    1: acc := acc - 1;\n"
+            << "    2: acc := acc * 2;\n"
+            << "  else\n"
+            << "    acc := acc div 2;\n"
+            << "  end;\n"
+            << "  if (x mod 10) in digits then\n"
+            << "    acc := acc + 3;\n";
+    }
+
+    if (options.records > 0) {
+        std::string rec = "rec" + std::to_string(index % options.records);
+        src << "  " << rec << ".id := x;\n"
+            << "  " << rec << ".score := acc;\n"
+            << "  acc := " << rec << ".score + " << rec << ".id;\n";
+    }
+
+    if (options.units > 0 && options.unitFunctions > 0) {
+        src << "  acc := acc + " << unitFunctionName(index % options.units, index % options.unitFunctions) << "(x);\n";
+    }
+
+    src << "  " << name << " := acc;\n"
+        << "end;\n\n";
+}
+
+} // namespace
+
+SyntheticProject generateSyntheticProject(const SyntheticOptions& options) {
+    SyntheticProject project;
+    for (int u = 0; u < options.units; ++u) {
+        project.units.push_back(generateUnit(options, u));
+    }
+
+    std::ostringstream src;
+    src << "program Synthetic;\n\n";
+    if (options.units > 0) {
+        src << "uses ";
+        for (int u = 0; u < options.units; ++u) {
+            src << (u > 0 ? ", " : "") << unitName(u);
+        }
+        src << ";\n\n";
+    }
+
+    if (options.setsAndCases || options.records > 0) {
+        src << "type\n";
+        if (options.setsAndCases) {
+            src << "  TDigits = set of 0..9;\n";
+        }
+        for (int r = 0; r < options.records; ++r) {
+            src << "  TRec" << r << " = record\n"
+                << "    id: integer;\n"
+                << "    score: integer;\n"
+                << "    name: string;\n"
+                << "  end;\n";
+        }
+        src << "\n";
+    }
+
+    src << "var\n"
+        << "  total: integer;\n";
+    for (int r = 0; r < options.records; ++r) {
+        src << "  rec" << r << ": TRec" << r << ";\n";
+    }
+    src << "\n";
+
+    for (int p = 0; p < options.procedures; ++p) {
+        generateFunction(src, options, p);
+    }
+
+    src << "begin\n"
+        << "  total := 0;\n";
+    for (int p = 0; p < options.procedures; ++p) {
+        src << "  total := total + Proc" << p << "(" << (p % 50) << ");\n";
+    }
+    src << "  writeln('total = ', total);\n"
+        << "end.\n";
+
+    project.program = {"synthetic.pas", src.str()};
+    return project;
+}
+
+} // namespace bench
+} // namespace rpascal
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace rpascal {
+namespace bench {
+
+// Shape of a generated benchmark program
+struct SyntheticOptions {
+    int procedures = 200;      // top-level functions in the program
+    int nestingDepth = 3;      // depth of nested for/if blocks in each function
+    int records = 10;          // record types (and one global of each)
+    bool setsAndCases = true;  // set membership and case statements in bodies
+    int units = 2;             // units used by the program
+    int unitFunctions = 20;    // functions exported by each unit
+};
+
+struct SyntheticFile {
+    std::string fileName;
+    std::string source;
+};
+
+struct SyntheticProject {
+    SyntheticFile program;
+    std::vector<SyntheticFile> units;
+};
+
+// Build a valid, deterministic Pascal program (and its units) of the given shape
+SyntheticProject generateSyntheticProject(const SyntheticOptions& options);
+
+} // namespace bench
+} // namespace rpascal
@@ -343,12 +343,29 @@ public:
     bool isDownto() const { return isDownto_; }
     Statement* getBody() const { return body_.get(); }
     
+    // parallel for / {$PARALLEL}: iterations run on the runtime thread pool.
+    // Reduction operators are "+", "*", "min" and "max"; private variables
+    // get a fresh copy per chunk of iterations
+    struct Reduction {
+        std::string op;
+        std::string variable;
+    };
+    void setParallel(bool parallel) { parallel_ = parallel; }
+    bool isParallel() const { return parallel_; }
+    void addReduction(const std::string& op, const std::string& variable) { reductions_.push_back({op, variable}); }
+    const std::vector<Reduction>& getReductions() const { return reductions_; }
+    void addPrivate(const std::string& variable) { privates_.push_back(variable); }
+    const std::vector<std::string>& getPrivates() const { return privates_; }
+    
 private:
     std::string variable_;
     std::unique_ptr<Expression> start_;
     std::unique_ptr<Expression> end_;
     bool isDownto_;
     std::unique_ptr<Statement> body_;
+    bool parallel_ = false;
+    std::vector<Reduction> reductions_;
+    std::vector<std::string> privates_;
 };
 
 class RepeatStatement : public Statement {
@@ -413,9 +430,18 @@ public:
     const std::vector<std::unique_ptr<Expression>>& getWithExpressions() const { return withExpressions_; }
     Statement* getBody() const { return body_.get(); }
     
+    // Name the body uses for a with expression that isn't a plain variable,
+    // e.g. with a[i] do; empty when the variable is used directly
+    void setAlias(size_t index, const std::string& alias) {
+        if (aliases_.size() <= index) aliases_.resize(index + 1);
+        aliases_[index] = alias;
+    }
+    std::string getAlias(size_t index) const { return index < aliases_.size() ? aliases_[index] : ""; }
+    
 private:
     std::vector<std::unique_ptr<Expression>> withExpressions_;
     std::unique_ptr<Statement> body_;
+    std::vector<std::string> aliases_;
 };
 
 class LabelStatement : public Statement {
@@ -526,9 +552,14 @@ public:
     const std::string& getName() const { return name_; }
     const std::string& getDefinition() const { return definition_; }
     
+    // {$SOA}: store an array of records as one array per field
+    void setStructOfArrays(bool soa) { structOfArrays_ = soa; }
+    bool isStructOfArrays() const { return structOfArrays_; }
+    
 private:
     std::string name_;
     std::string definition_;
+    bool structOfArrays_ = false;
 };
 
 // Record field declaration
@@ -599,10 +630,14 @@ public:
     const VariantPart* getVariantPart() const { return variantPart_.get(); }
     bool hasVariantPart() const { return variantPart_ != nullptr; }
     
+    void setPacked(bool packed) { packed_ = packed; }
+    bool isPacked() const { return packed_; }
+    
 private:
     std::string name_;
     std::vector<RecordField> fields_;
     std::unique_ptr<VariantPart> variantPart_;
+    bool packed_ = false;
 };
 
 class VariableDeclaration : public Declaration {
@@ -621,11 +656,21 @@ public:
     ParameterMode getParameterMode() const { return parameterMode_; }
     void setParameterMode(ParameterMode mode) { parameterMode_ = mode; }
     
+    // Declared in a threadvar section: one instance per thread
+    void setThreadLocal(bool threadLocal) { threadLocal_ = threadLocal; }
+    bool isThreadLocal() const { return threadLocal_; }
+    
+    // A var parameter that never aliases anything else its routine reaches
+    void setNoAlias(bool noAlias) { noAlias_ = noAlias; }
+    bool isNoAlias() const { return noAlias_; }
+    
 private:
     std::string name_;
     std::string type_;
     std::unique_ptr<Expression> initializer_;
     ParameterMode parameterMode_;
+    bool threadLocal_ = false;
+    bool noAlias_ = false;
 };
 
 class ProcedureDeclaration : public Declaration {
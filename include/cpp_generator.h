@@ -3,11 +3,16 @@
 #include "ast.h"
 #include "symbol_table.h"
 #include "unit_loader.h"
+#include "output_buffer.h"
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace rpascal {
 
@@ -22,6 +27,58 @@ public:
     // Generate C++ code for the entire program
     std::string generate(Program& program);
     
+    // Generate a header/source pair for a unit compiled on its own
+    std::string generateUnitHeader(Unit& unit);
+    std::string generateUnitSource(Unit& unit);
+    
+    // Include used units' headers instead of inlining their code
+    void setSeparateUnits(bool separate) { separateUnits_ = separate; }
+    
+    // Generate independent procedures/functions on worker threads (default on)
+    void setParallelRoutines(bool parallel) { parallelRoutines_ = parallel; }
+    
+    // Instrument every procedure/function with entry/exit probes and write a
+    // profile report when the generated program exits
+    void setProfiling(bool enabled) { profiling_ = enabled; }
+    
+    // Record routine spans, file operations and large allocations in a
+    // per-thread ring buffer that the program writes out as a Chrome trace
+    void setTracing(bool enabled) { tracing_ = enabled; }
+    
+    // Route New/Dispose/GetMem/FreeMem through per-site accounting and write
+    // heap statistics and a leak report when the program exits
+    void setHeapStats(bool enabled) { heapStats_ = enabled; }
+    
+    // Local variables larger than this many bytes are placed in a per-thread
+    // frame arena instead of on the stack; 0 keeps every local on the stack
+    static constexpr size_t DEFAULT_LOCAL_HEAP_THRESHOLD = 64 * 1024;
+    void setLocalHeapThreshold(size_t bytes) { localHeapThreshold_ = bytes; }
+    
+    // Include the SIGPROF sampling profiler; it runs when onByDefault is set
+    // or the program finds RPASCAL_SAMPLE_PROFILE in its environment
+    void setSampleProfiling(bool include, bool onByDefault) {
+        samplerRuntime_ = include;
+        sampleByDefault_ = onByDefault;
+    }
+    
+    // Emit #line directives so compiler diagnostics, debuggers and profilers
+    // point at the Pascal source; cppFile is where the C++ will be written
+    void setLineDirectives(bool enabled) { lineDirectives_ = enabled; }
+    void setSourceFiles(const std::string& pascalFile, const std::string& cppFile) {
+        sourceFile_ = pascalFile;
+        cppFile_ = cppFile;
+    }
+    
+    // Size, alignment and padding of every record type generated so far
+    std::string getLayoutReport() const;
+    
+    // Loops annotated for vectorisation (and why others weren't), aligned
+    // arrays and __restrict parameters, in generation order
+    std::string getVectorReport() const;
+    
+    // Header file name used for a unit in separate compilation
+    static std::string unitHeaderName(const std::string& unitName);
+    
     // Visitor pattern implementation
     void visit(LiteralExpression& node) override;
     void visit(IdentifierExpression& node) override;
@@ -63,12 +120,43 @@ public:
     void visit(Program& node) override;
     
 private:
+    // Per-routine task generator sharing the parent's type metadata. It must
+    // copy every per-program member a routine visitor reads, or routines would
+    // generate differently above PARALLEL_ROUTINE_THRESHOLD
+    CppGenerator(const CppGenerator& parent, std::shared_ptr<SymbolTable> symbolTable);
+    
+    // Below this many routines the threading overhead outweighs the gain
+    static constexpr size_t PARALLEL_ROUTINE_THRESHOLD = 8;
+    
     std::shared_ptr<SymbolTable> symbolTable_;
     UnitLoader* unitLoader_;
-    std::ostringstream output_;
+    OutputBuffer output_;
     int indentLevel_;
     std::string currentFunction_;
     std::string currentFunctionOriginalName_;
+    bool separateUnits_;
+    bool parallelRoutines_;
+    bool profiling_;
+    bool tracing_;
+    bool heapStats_;
+    bool samplerRuntime_;
+    bool sampleByDefault_;
+    size_t localHeapThreshold_;
+    bool generatingLocals_;     // visiting a routine's var section
+    
+    // Routine being generated, for parameter types and the vector report
+    const std::vector<std::unique_ptr<VariableDeclaration>>* routineParameters_;
+    std::string routineName_;
+    std::vector<std::string> vectorReport_;
+    
+    // #line state: the Pascal file being generated, the C++ output file, and
+    // where the last directive pointed (empty file = mapped to the C++ itself)
+    bool lineDirectives_;
+    std::string sourceFile_;
+    std::string cppFile_;
+    std::string lastDirectiveFile_;
+    size_t lastDirectiveLine_;
+    size_t lastDirectiveCppLine_;
     
     // Array type information for proper indexing
     struct ArrayDimension {
@@ -94,25 +182,101 @@ private:
         int size() const { return static_cast<int>(values.size()); }
     };
     
-    std::map<std::string, ArrayTypeInfo> arrayTypes_;
-    std::map<std::string, EnumTypeInfo> enumTypes_;
+    // Filled while generating global type definitions, read-only afterwards
+    // (shared with per-routine task generators)
+    std::shared_ptr<std::map<std::string, ArrayTypeInfo>> arrayTypes_;
+    std::shared_ptr<std::map<std::string, EnumTypeInfo>> enumTypes_;
+    
+    // Pascal type string -> C++ type, filled by mapPascalTypeToCpp; valid
+    // until the next type definition or routine scope change
+    std::unordered_map<std::string, std::string> typeMappingCache_;
+    
+    // Lowercase names of types whose C++ form has constructors (strings, sets,
+    // files, records holding them); such variant fields can't share a union
+    std::unordered_set<std::string> nonTrivialTypes_;
+    
+    // Lowercase names of units already emitted for the current file
+    std::unordered_set<std::string> emittedUnits_;
+    
+    // Fields of records without a variant part by lowercase record name;
+    // {$SOA} arrays of these become one array per field
+    std::unordered_map<std::string, std::vector<RecordField>> plainRecordFields_;
+    
+    // Record layouts as the C++ compiler will lay the structs out
+    struct TypeLayout {
+        size_t size;
+        size_t align;
+    };
+    struct FieldLayout {
+        std::string name;
+        std::string type;
+        size_t offset;
+        size_t size;
+        bool variant;
+    };
+    struct RecordLayout {
+        std::string name;
+        size_t size = 0;
+        size_t align = 1;
+        size_t padding = 0;
+        bool packRequested = false;
+        bool packed = false;
+        std::string unknownField;   // first field whose size isn't known
+        std::vector<FieldLayout> fields;
+    };
+    std::vector<RecordLayout> recordLayouts_;
     
     // Helper methods
-    void emit(const std::string& code);
-    void emitLine(const std::string& line);
+    void emit(std::string_view code);
+    void emitLine(std::string_view line);
     void emitIndent();
+    void emitLineDirective(const ASTNode& node);
+    void emitCppLineDirective();
+    void emitRoutineProbes(const std::string& routineName, const ASTNode& node);
+    void emitSampleRoutineName(const std::string& cppName, const std::string& routineName);
     void increaseIndent();
     void decreaseIndent();
     
     // Code generation helpers
     std::string generateHeaders();
     std::string generateRuntimeIncludes();
+    std::string generateClockRuntime();
+    std::string generateProfilerRuntime();
+    std::string generateTraceRuntime();
+    std::string generateSamplerRuntime();
+    std::string generateHeapStatsRuntime();
+    std::string generateInstrumentationRuntimes();  // Runtimes enabled by the instrumentation options
+    void generateRoutines(const std::vector<Declaration*>& routines);
+    void emitUnitInterfacePrototype(Declaration* decl);
+    void emitUsedUnit(const std::string& unitName);
+    void emitUnitInitialization(Unit& unit);
     std::string generateForwardDeclarations(const std::vector<std::unique_ptr<Declaration>>& declarations);
     std::string mapPascalOperatorToCpp(TokenType operator_);
     std::string mapPascalTypeToCpp(const std::string& pascalType);
+    std::string mapPascalTypeToCppUncached(const std::string& pascalType);
+    bool hasTrivialStorage(const std::string& pascalType) const;
+    static std::string narrowestIntegerType(long long low, long long high);
+    bool isNarrowOrdinal(const std::string& pascalType) const;
+    std::optional<TypeLayout> typeLayout(const std::string& pascalType) const;
+    int arrayElementCount(const std::string& bounds) const;
+    unsigned packedElementBits(const std::string& elementType) const;
+    std::string packedArrayType(const std::string& elementType, int count);
+    void splitVariantFields(const VariantPart& variantPart, std::vector<const RecordField*>& ownStorage,
+                            std::vector<std::vector<const RecordField*>>& overlaid) const;
+    RecordLayout computeRecordLayout(const RecordTypeDefinition& node, bool packed) const;
     std::string mapPascalFunctionToCpp(const std::string& functionName);
     void generateRecordDefinition(const std::string& typeName, const std::string& definition);
-    void generateArrayDefinition(const std::string& typeName, const std::string& definition);
+    void generateArrayDefinition(const std::string& typeName, const std::string& definition, bool structOfArrays = false);
+    void generateParallelFor(ForStatement& node);
+    const VariableDeclaration* routineParameter(const std::string& name) const;
+    std::string variableTypeName(const std::string& name) const;
+    bool isNumericType(const std::string& pascalType) const;
+    std::string numericArrayElement(const std::string& pascalType) const;
+    size_t vectorAlignment(const std::string& pascalType) const;
+    std::string elementwiseLoopBlocker(ForStatement& node) const;
+    void reportVector(const std::string& text);
+    void reportRestrictParameters(const std::vector<std::unique_ptr<VariableDeclaration>>& parameters);
+    bool generateStructOfArrays(const std::string& typeName, const std::string& elementType, int count);
     void generatePointerDefinition(const std::string& typeName, const std::string& definition);
     void generateSetDefinition(const std::string& typeName, const std::string& definition);
     void generateBoundedStringDefinition(const std::string& typeName, const std::string& definition);
@@ -124,6 +288,7 @@ private:
     void generateExpression(Expression* expr);
     void generateStatement(Statement* stmt);
     void generateFunctionCall(CallExpression& node);
+    std::string resolveCallName(const std::string& functionName, const std::vector<Expression*>& arguments);
     void generateBuiltinCall(CallExpression& node, const std::string& functionName);
     
     // Built-in function helper methods (organized by category)
@@ -135,6 +300,8 @@ private:
     bool generateDateTimeFunctionCall(CallExpression& node, const std::string& lowerName);
     bool generateSystemFunctionCall(CallExpression& node, const std::string& lowerName);
     bool generateMemoryFunctionCall(CallExpression& node, const std::string& lowerName);
+    bool generateThreadFunctionCall(CallExpression& node, const std::string& lowerName);
+    void emitHeapSite(CallExpression& call, Expression* pointer);
     bool generateFileFunctionCall(CallExpression& node, const std::string& lowerName);
     
     // Variable and function management
@@ -153,8 +320,11 @@ private:
     bool isBuiltinConstant(const std::string& name);
     int getBuiltinConstantValue(const std::string& name);
     bool isStringExpression(Expression* expr);
+    bool isTypedFileVariable(const std::string& name);
     bool needsCharToStringConversion(AssignmentStatement& node);
     std::string escapeCppString(const std::string& str);
+    // Spelling of a Pascal identifier in C++: reserved words get a pas_ prefix
+    static std::string cppIdentifier(const std::string& name);
     std::vector<std::string> expandEnumRange(const std::string& startName, const std::string& endName);
 };
 
@@ -11,6 +11,9 @@ class Lexer {
 public:
     explicit Lexer(const std::string& source);
     
+    // Replay a previously tokenized stream (e.g. from a .rpu unit cache)
+    explicit Lexer(std::vector<Token> tokens);
+    
     // Get the next token from the source
     Token nextToken();
     
@@ -23,6 +26,9 @@ public:
     // Get current position info
     SourceLocation getCurrentLocation() const;
     
+    // Tokenize the remaining source, including the trailing EOF token
+    std::vector<Token> tokenizeAll();
+    
     // Error handling
     bool hasErrors() const { return !errors_.empty(); }
     const std::vector<std::string>& getErrors() const { return errors_; }
@@ -35,6 +41,11 @@ private:
     size_t column_;
     size_t lineStart_;
     
+    // Pre-tokenized stream used instead of the source when replaying
+    bool replaying_;
+    std::vector<Token> replayTokens_;
+    size_t replayIndex_;
+    
     // Error collection
     std::vector<std::string> errors_;
     
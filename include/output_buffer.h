@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rpascal {
+
+// Append-only text buffer built from fixed-size chunks. Growing it never
+// moves text that has already been written, unlike a single string/stream.
+class OutputBuffer {
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    void append(std::string_view text);
+    void append(char c);
+
+    // Total number of bytes written
+    size_t size() const { return size_; }
+
+    // Number of complete lines written, and whether the next byte starts a line
+    size_t lineCount() const { return lines_; }
+    bool atLineStart() const { return size_ == 0 || chunks_.back().back() == '\n'; }
+
+    // Drop everything written after the first newSize bytes
+    void truncate(size_t newSize);
+    void clear();
+
+    // Join the chunks into one string
+    std::string str() const;
+
+private:
+    std::vector<std::string> chunks_;
+    size_t size_ = 0;
+    size_t lines_ = 0;
+
+    std::string& writableChunk();
+};
+
+} // namespace rpascal
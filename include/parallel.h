@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace rpascal {
+
+// Run task(0..count-1) on a small pool of worker threads.
+// maxWorkers of 0 means one worker per hardware thread.
+inline void runParallel(size_t count, const std::function<void(size_t)>& task, size_t maxWorkers = 0) {
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t workers = std::min(count, maxWorkers == 0 ? hardware : maxWorkers);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+    
+    std::atomic<size_t> nextIndex{0};
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (size_t w = 0; w < workers; ++w) {
+        threads.emplace_back([&]() {
+            for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+                task(i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace rpascal
@@ -27,6 +27,7 @@ private:
     std::unique_ptr<Lexer> lexer_;
     Token currentToken_;
     std::vector<std::string> errors_;
+    std::vector<std::string> pendingDirectives_;  // {$...} seen just before currentToken_
     
     // Token management
     void advance();
@@ -34,6 +35,7 @@ private:
     bool check(TokenType type) const;
     Token consume(TokenType type, const std::string& message);
     bool isAtEnd() const;
+    bool takeDirective(const std::string& name, std::string* arguments = nullptr);
     
     // Error handling
     void addError(const std::string& message);
@@ -58,6 +60,7 @@ private:
     std::unique_ptr<AssignmentStatement> parseAssignmentStatement(std::unique_ptr<Expression> target);
     std::unique_ptr<IfStatement> parseIfStatement();
     std::unique_ptr<WhileStatement> parseWhileStatement();
+    void parseParallelClauses(ForStatement& loop, const std::string& clauses);
     std::unique_ptr<ForStatement> parseForStatement();
     std::unique_ptr<RepeatStatement> parseRepeatStatement();
     std::unique_ptr<CaseStatement> parseCaseStatement();
@@ -66,12 +69,7 @@ private:
     std::unique_ptr<ExpressionStatement> parseExpressionStatement();
     
     std::unique_ptr<Expression> parseExpression();
-    std::unique_ptr<Expression> parseOrExpression();
-    std::unique_ptr<Expression> parseAndExpression();
-    std::unique_ptr<Expression> parseEqualityExpression();
-    std::unique_ptr<Expression> parseRelationalExpression();
-    std::unique_ptr<Expression> parseAdditiveExpression();
-    std::unique_ptr<Expression> parseMultiplicativeExpression();
+    std::unique_ptr<Expression> parseBinaryExpression(int minPrecedence);
     std::unique_ptr<Expression> parseUnaryExpression();
     std::unique_ptr<Expression> parsePrimaryExpression();
     std::unique_ptr<Expression> parseCallExpression(std::unique_ptr<Expression> callee);
@@ -47,6 +47,10 @@ public:
     void setTypeDefinition(const std::string& definition) { typeDefinition_ = definition; }
     const std::string& getTypeDefinition() const { return typeDefinition_; }
     
+    // Predeclared identifiers (the real type names) may be redeclared by a program
+    void setPredeclared(bool predeclared) { predeclared_ = predeclared; }
+    bool isPredeclared() const { return predeclared_; }
+    
     // For variables with custom types
     void setTypeName(const std::string& typeName) { typeName_ = typeName; }
     const std::string& getTypeName() const { return typeName_; }
@@ -58,14 +62,20 @@ public:
     const std::string& getPointeeTypeName() const { return pointeeTypeName_; }
     
     // For functions and procedures
-    void addParameter(const std::string& paramName, DataType paramType) {
+    void addParameter(const std::string& paramName, DataType paramType, const std::string& typeName = "") {
         parameters_.push_back({paramName, paramType});
+        parameterTypeNames_.push_back(typeName);
     }
     
     const std::vector<std::pair<std::string, DataType>>& getParameters() const {
         return parameters_;
     }
     
+    // Declared type name of a parameter, e.g. "single" where the data type is REAL
+    std::string getParameterTypeName(size_t index) const {
+        return index < parameterTypeNames_.size() ? parameterTypeNames_[index] : "";
+    }
+    
     void setReturnType(DataType returnType) { returnType_ = returnType; }
     DataType getReturnType() const { return returnType_; }
     
@@ -82,17 +92,21 @@ private:
     int scopeLevel_;
     std::string typeDefinition_;  // For custom types, stores the definition string
     std::string typeName_;        // For variables, stores the original type name  
+    bool predeclared_ = false;
     DataType pointeeType_ = DataType::UNKNOWN;  // For pointer types, the pointed-to type
     std::string pointeeTypeName_; // For pointer types, the pointed-to type name
     std::vector<std::pair<std::string, DataType>> parameters_;
+    std::vector<std::string> parameterTypeNames_;
     DataType returnType_ = DataType::VOID;
 };
 
 // Scope for managing nested scopes
 class Scope {
 public:
-    explicit Scope(int level, Scope* parent = nullptr) 
-        : level_(level), parent_(parent) {}
+    // A scope that extendsParent shares its parent's namespace: local lookups
+    // also see the parent's symbols (used for per-task overlays of the global scope)
+    explicit Scope(int level, Scope* parent = nullptr, bool extendsParent = false) 
+        : level_(level), parent_(parent), extendsParent_(extendsParent) {}
     
     void define(const std::string& name, std::shared_ptr<Symbol> symbol);
     std::shared_ptr<Symbol> lookup(const std::string& name);
@@ -113,6 +127,7 @@ public:
 private:
     int level_;
     Scope* parent_;
+    bool extendsParent_;
     std::unordered_map<std::string, std::shared_ptr<Symbol>> symbols_;
     std::unordered_map<std::string, std::vector<std::shared_ptr<Symbol>>> overloadedSymbols_;
 };
@@ -123,6 +138,13 @@ public:
     SymbolTable();
     ~SymbolTable() = default;
     
+    // Private overlay on top of another table's current scope. Definitions go
+    // to the overlay only, so several overlays can share a read-only base
+    // from different threads. The base table must outlive the overlay.
+    explicit SymbolTable(Scope* baseScope);
+    
+    Scope* getCurrentScope() const { return currentScope_; }
+    
     // Scope management
     void enterScope();
     void exitScope();
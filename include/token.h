@@ -20,6 +20,7 @@ enum class TokenType {
     CONST,
     TYPE,
     VAR,
+    THREADVAR,
     PROCEDURE,
     FUNCTION,
     BEGIN,
@@ -106,6 +107,7 @@ enum class TokenType {
     NEWLINE,
     WHITESPACE,
     COMMENT,
+    DIRECTIVE,      // {$...} compiler directive, value is the text after '$'
     INVALID
 };
 
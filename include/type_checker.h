@@ -11,6 +11,7 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <map>
 
 namespace rpascal {
 
@@ -22,6 +23,9 @@ public:
     // Analyze the entire program
     bool analyze(Program& program);
     
+    // Analyze a unit on its own (separate compilation)
+    bool analyzeUnit(Unit& unit);
+    
     // Error handling
     bool hasErrors() const;
     const std::vector<std::string>& getErrors() const;
@@ -32,6 +36,11 @@ public:
     // Get unit loader for further use
     UnitLoader* getUnitLoader() const { return unitLoader_.get(); }
     
+    // Turn outer for loops with independent iterations into parallel loops,
+    // and report every loop considered (and why it was left alone)
+    void setAutoParallel(bool enabled) { autoParallel_ = enabled; }
+    std::string getAutoParallelReport() const;
+    
     // Visitor pattern implementation
     void visit(LiteralExpression& node) override;
     void visit(IdentifierExpression& node) override;
@@ -87,6 +96,7 @@ private:
         DataType recordType;         // Type of the with variable
     };
     std::vector<WithContext> withContextStack_;
+    int withAliasCount_ = 0;
     
     // Label tracking for goto statements
     std::set<std::string> declaredLabels_;
@@ -96,6 +106,64 @@ private:
     std::unique_ptr<UnitLoader> unitLoader_;
     
     // Helper methods
+    // parallel for: the innermost parallel loop whose body is being checked,
+    // and how many ordinary loops deep inside that body we are
+    ForStatement* parallelLoop_ = nullptr;
+    int parallelNesting_ = 0;
+    void checkParallelWrite(Expression* target, const SourceLocation& location);
+    void checkParallelLoop(ForStatement& node);
+    
+    // Var array parameters that never alias anything else the routine can
+    // reach are marked for __restrict. Tracked over the program's own routines:
+    // the globals each one names, its calls, and what every call passes by
+    // reference. An object is "global:x", "local:R.x", "*" (unknown) or "%i",
+    // whatever the calling routine's i-th parameter refers to
+    struct AliasRoutine {
+        std::vector<const std::vector<std::unique_ptr<VariableDeclaration>>*> declarations;  // forward and body
+        std::set<std::string> globals;
+        std::set<const Symbol*> callees;
+        std::vector<std::set<std::string>> objects;  // per parameter
+        std::string impurity;   // why it can't run in parallel with itself, besides globals and callees
+    };
+    struct AliasCall {
+        const Symbol* caller;               // nullptr for the main block
+        const Symbol* callee;
+        std::vector<std::string> objects;   // per argument, "" when passed by value
+    };
+    bool aliasTracking_ = false;
+    const Symbol* aliasRoutine_ = nullptr;
+    std::map<const Symbol*, AliasRoutine> aliasRoutines_;
+    std::vector<AliasCall> aliasCalls_;
+    std::vector<std::pair<const Symbol*, std::string>> escapedObjects_;  // operands of @
+    void trackAliasRoutine(const Symbol* routine, const std::vector<std::unique_ptr<VariableDeclaration>>& parameters);
+    void trackAliasCall(const Symbol* callee, const std::vector<std::unique_ptr<Expression>>& arguments);
+    void trackAliasGlobal(Expression* expr);
+    std::string aliasObject(Expression* expr);
+    void markNoAliasParameters();
+    bool isFixedArrayType(std::string type);
+    
+    // --auto-parallel: outer for loops of the program, checked in two steps.
+    // While a loop is visited its own statements are checked; once every
+    // routine has been seen, that the routines it calls are pure (no var
+    // parameters, no globals, no I/O) and that the parameters it needs
+    // unaliased were marked so
+    struct AutoParallelLoop {
+        ForStatement* loop;
+        const Symbol* routine;               // nullptr for the main block
+        std::string blocker;                 // why not, "" while it still qualifies
+        std::set<const Symbol*> callees;
+        std::vector<const VariableDeclaration*> mustNotAlias;
+        std::vector<std::string> privates;   // control variables of inner loops
+    };
+    static constexpr long long AUTO_PARALLEL_MIN_ITERATIONS = 10000;   // for straight-line bodies
+    bool autoParallel_ = false;
+    AutoParallelLoop* autoParallelLoop_ = nullptr;   // the loop whose body is being visited
+    std::vector<std::unique_ptr<AutoParallelLoop>> autoParallelLoops_;
+    std::vector<std::string> autoParallelReport_;
+    std::string autoParallelBlocker(ForStatement& node, AutoParallelLoop& loop);
+    void trackAliasBuiltin(const std::string& functionName);
+    void applyAutoParallel();
+    
     void addError(const std::string& message);
     void addError(const std::string& message, const SourceLocation& location);
     DataType getExpressionType(Expression* expr);
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "token.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rpascal {
+
+// Contents of a precompiled unit file (.rpu): the unit's token stream, which
+// lets the loader skip lexing. Tokens depend only on the unit's own source,
+// so that is the only hash it records.
+struct UnitCacheEntry {
+    uint64_t sourceHash = 0;
+    std::vector<Token> tokens;
+};
+
+// Reads and writes .rpu token cache files
+class UnitCache {
+public:
+    // FNV-1a 64-bit hash of unit source text
+    static uint64_t hashContent(const std::string& content);
+    
+    // Cache file path for a unit source file (foo.pas -> foo.rpu)
+    static std::string cachePathFor(const std::string& sourcePath);
+    
+    // Read a cache file (memory-mapped where supported); false if missing or corrupt
+    static bool read(const std::string& cachePath, UnitCacheEntry& entry);
+    
+    // Write a cache file; false if it could not be written
+    static bool write(const std::string& cachePath, const UnitCacheEntry& entry);
+};
+
+} // namespace rpascal
@@ -3,10 +3,13 @@
 #include "ast.h"
 #include "parser.h"
 #include "lexer.h"
+#include "unit_cache.h"
 #include <memory>
 #include <string>
 #include <unordered_map>
-#include <filesystem>
+#include <vector>
+#include <atomic>
+#include <mutex>
 
 namespace rpascal {
 
@@ -18,6 +21,23 @@ public:
     // Load a unit by name, returns nullptr if not found or parse error
     std::unique_ptr<Unit> loadUnit(const std::string& unitName);
     
+    // Load every unit reachable from rootUnits, parsing independent units in
+    // parallel. Returns false (see getErrors) if the uses graph has a cycle.
+    bool loadUnitGraph(const std::vector<std::string>& rootUnits);
+    
+    // Units from the last loadUnitGraph call, dependencies before dependents
+    const std::vector<std::string>& getLoadOrder() const { return loadOrder_; }
+    
+    // Errors from the last loadUnitGraph call
+    bool hasErrors() const { return !errors_.empty(); }
+    const std::vector<std::string>& getErrors() const { return errors_; }
+    
+    // Source files of all units loaded from disk, in load order
+    const std::vector<std::string>& getLoadedUnitFiles() const { return loadedUnitFiles_; }
+    
+    // Absolute path of the file a loaded unit came from (empty for built-in units)
+    std::string getUnitFile(const std::string& unitName) const;
+    
     // Check if a unit is already loaded
     bool isUnitLoaded(const std::string& unitName) const;
     
@@ -27,21 +47,68 @@ public:
     // Add search path for unit files
     void addSearchPath(const std::string& path);
     
+    // Replace the search paths (e.g. from -I options); searched in order
+    void setSearchPaths(const std::vector<std::string>& paths);
+    const std::vector<std::string>& getSearchPaths() const { return searchPaths_; }
+    
     // Clear all loaded units
     void clearUnits();
     
+    // Check whether a unit name refers to a compiler built-in unit
+    static bool isBuiltinUnit(const std::string& unitName);
+    
+    // Enable or disable reading/writing precompiled .rpu unit files
+    void setCacheEnabled(bool enabled) { cacheEnabled_ = enabled; }
+    bool isCacheEnabled() const { return cacheEnabled_; }
+    
 private:
     // Find unit file in search paths
     std::string findUnitFile(const std::string& unitName);
     
+    // Directory listing of one search path, keyed by lower-case file name
+    struct DirectoryIndex {
+        std::string path;
+        std::unordered_map<std::string, std::vector<std::string>> files;
+    };
+    
+    // Listings of the existing search paths in search order, read on the
+    // first lookup and kept for the rest of the compile
+    const std::vector<DirectoryIndex>& searchIndex();
+    
+    // Find, lex and parse a unit file without touching the loaded-unit cache.
+    // Safe to call from several threads at once; messages go to diagnostics.
+    std::unique_ptr<Unit> parseUnitFile(const std::string& unitName, std::string& unitFile, std::string& diagnostics);
+    
+    void addError(const std::string& error);
+    
     // Load unit file content
     std::string loadFileContent(const std::string& filePath);
     
-    // Cache of loaded units
+    // Load the token stream from a .rpu file if it is still valid for this source
+    bool loadCachedTokens(const std::string& cachePath, uint64_t sourceHash, std::vector<Token>& tokens);
+    
+    // Write a .rpu file for a freshly lexed unit
+    void writeCache(const std::string& cachePath, uint64_t sourceHash, std::vector<Token> tokens);
+    
+    // Cache of loaded units, keyed by lower-case name
     std::unordered_map<std::string, std::unique_ptr<Unit>> loadedUnits_;
+    std::vector<std::string> loadedUnitFiles_;
+    std::unordered_map<std::string, std::string> unitFiles_;
     
     // Search paths for unit files
     std::vector<std::string> searchPaths_;
+    
+    // Shared by parallel unit parses; the mutex only guards building it
+    std::vector<DirectoryIndex> searchIndex_;
+    std::atomic<bool> searchIndexBuilt_;
+    std::mutex indexMutex_;
+    
+    // Result of the last loadUnitGraph call
+    std::vector<std::string> loadOrder_;
+    std::vector<std::string> errors_;
+    
+    // Whether .rpu unit files are used
+    bool cacheEnabled_;
 };
 
 } // namespace rpascal
\ No newline at end of file
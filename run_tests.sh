@@ -20,6 +20,40 @@ fi
 echo "Compiler found: $RPASCAL"
 echo
 
+# Regression tests compare their standard output with tests/expected/<name>.out;
+# reports the instrumented builds print on stderr are not compared.
+# run_expected <name> [compiler options...]
+REGRESSION_FAILURES=0
+run_expected() {
+    local name=$1
+    shift
+    rm -f $TESTS_DIR/$name
+    if ! $RPASCAL "$@" $TESTS_DIR/$name.pas > /dev/null 2>&1 || [ ! -f "$TESTS_DIR/$name" ]; then
+        echo "FAILED: $name failed to compile"
+        REGRESSION_FAILURES=$((REGRESSION_FAILURES + 1))
+        return
+    fi
+    if ./$TESTS_DIR/$name | diff -u $TESTS_DIR/expected/$name.out -; then
+        echo "PASSED: $name"
+    else
+        echo "FAILED: $name output differs from $TESTS_DIR/expected/$name.out"
+        REGRESSION_FAILURES=$((REGRESSION_FAILURES + 1))
+    fi
+    rm -f $TESTS_DIR/$name
+}
+
+# check <description> <command...>: passes when the command succeeds
+check() {
+    local description=$1
+    shift
+    if "$@" > /dev/null 2>&1; then
+        echo "PASSED: $description"
+    else
+        echo "FAILED: $description"
+        REGRESSION_FAILURES=$((REGRESSION_FAILURES + 1))
+    fi
+}
+
 echo "--- Running Test Runner (Information) ---"
 $RPASCAL $TESTS_DIR/test_runner.pas
 if [ -f "$TESTS_DIR/test_runner" ]; then
@@ -183,6 +217,126 @@ else
 fi
 echo
 
+echo "--- Regression Tests (output compared with tests/expected) ---"
+run_expected test_serial_codegen
+run_expected test_parallel_codegen
+run_expected test_type_mapping
+run_expected test_expressions
+run_expected test_runtime_kernels
+run_expected test_line_directives -g --keep-cpp
+check "#line directives point at test_line_directives.pas" grep -q '^#line [0-9]* ".*test_line_directives.pas"' $TESTS_DIR/test_line_directives.cpp
+rm -f $TESTS_DIR/test_line_directives.cpp
+# Above the parallel threshold the routines come from task generators; the
+# glue after them must still be mapped back to the C++ file
+run_expected test_parallel_codegen -g --keep-cpp
+check "#line maps the code after parallel routines back to test_parallel_codegen.cpp" grep -q '^#line [0-9]* ".*test_parallel_codegen.cpp"' $TESTS_DIR/test_parallel_codegen.cpp
+rm -f $TESTS_DIR/test_parallel_codegen.cpp
+
+# Instrumented builds: the output is unchanged and the report is written
+export RPASCAL_PROFILE_OUT=$TESTS_DIR/test_profile
+run_expected test_profile --profile
+unset RPASCAL_PROFILE_OUT
+check "profile counts the 22343 calls of Fib" grep -q ' 22343 .* Fib (test_profile.pas:9)' $TESTS_DIR/test_profile.profile.txt
+rm -f $TESTS_DIR/test_profile.profile.txt $TESTS_DIR/test_profile.out.*
+export RPASCAL_TRACE_OUT=$TESTS_DIR/test_trace.json
+run_expected test_trace --trace
+unset RPASCAL_TRACE_OUT
+check "trace records the ReadLines span" grep -q '"name":"ReadLines","cat":"routine"' $TESTS_DIR/test_trace.json
+check "trace tags file operations with the file name" grep -q '"name":"Reset","cat":"io".*"file":"test_trace.tmp"' $TESTS_DIR/test_trace.json
+check "trace records the 80000-byte New" grep -q '"name":"New","cat":"memory".*"bytes":80000' $TESTS_DIR/test_trace.json
+rm -f $TESTS_DIR/test_trace.json test_trace.tmp
+export RPASCAL_SAMPLE_OUT=$TESTS_DIR/test_sample_profile
+run_expected test_sample_profile --sample-profile
+unset RPASCAL_SAMPLE_OUT
+check "sample profile reports the achieved rate" grep -q '^Sampling profile: TestSampleProfile, .* Hz achieved' $TESTS_DIR/test_sample_profile.samples.txt
+check "sample profile maps samples to Churn's Pascal lines" grep -q ' test_sample_profile.pas:1[56]  Churn$' $TESTS_DIR/test_sample_profile.samples.txt
+rm -f $TESTS_DIR/test_sample_profile.samples.txt $TESTS_DIR/test_sample_profile.folded
+export RPASCAL_HEAP_OUT=$TESTS_DIR/test_heap_stats.heap.txt
+run_expected test_heap_stats --heap-stats
+unset RPASCAL_HEAP_OUT
+check "heap stats count 11 allocations and 10 frees" grep -q '^  allocations 11, frees 10,' $TESTS_DIR/test_heap_stats.heap.txt
+check "heap stats credit the list nodes to their New site" grep -q ' 10  *10 .* test_heap_stats.pas:23  TNode$' $TESTS_DIR/test_heap_stats.heap.txt
+check "heap stats report the leaked integer" grep -q '^  1 blocks, 4 bytes from test_heap_stats.pas:40 (integer)$' $TESTS_DIR/test_heap_stats.heap.txt
+rm -f $TESTS_DIR/test_heap_stats.heap.txt
+run_expected test_variant_records
+run_expected test_packed
+$RPASCAL --layout-report -o $TESTS_DIR/test_packed_layout $TESTS_DIR/test_packed.pas > $TESTS_DIR/test_packed.layout 2>&1
+check "layout report shows TLoose padding" grep -q '^TLoose: size 12, align 4, padding 6$' $TESTS_DIR/test_packed.layout
+check "layout report shows TTight without padding" grep -q '^TTight: size 6, align 1, padding 0, packed$' $TESTS_DIR/test_packed.layout
+rm -f $TESTS_DIR/test_packed_layout $TESTS_DIR/test_packed.layout
+run_expected test_narrow_types
+$RPASCAL --layout-report -o $TESTS_DIR/test_narrow_types_layout $TESTS_DIR/test_narrow_types.pas > $TESTS_DIR/test_narrow_types.layout 2>&1
+check "narrow enum and subrange fields take one byte each" grep -q '^TPixel: size 5, align 1, padding 0$' $TESTS_DIR/test_narrow_types.layout
+rm -f $TESTS_DIR/test_narrow_types_layout $TESTS_DIR/test_narrow_types.layout
+run_expected test_soa --keep-cpp
+check "TParticles is stored as one array per field" grep -q '^// {\$SOA} TParticles: TParticle stored as one array per field$' $TESTS_DIR/test_soa.cpp
+rm -f $TESTS_DIR/test_soa.cpp
+run_expected test_frame_arena --keep-cpp
+check "4 MB locals are placed in the frame arena" grep -q 'pascal_frame::Local<TBuffer, 64> pascal_frame_buffer;' $TESTS_DIR/test_frame_arena.cpp
+$RPASCAL --local-heap-threshold 0 --keep-cpp -o $TESTS_DIR/test_frame_arena_stack $TESTS_DIR/test_frame_arena.pas > /dev/null 2>&1
+check "--local-heap-threshold 0 keeps locals on the stack" sh -c "! grep -q 'pascal_frame::Local<' $TESTS_DIR/test_frame_arena.cpp"
+rm -f $TESTS_DIR/test_frame_arena.cpp $TESTS_DIR/test_frame_arena_stack
+# Three threads even on a single-core machine, so chunks really interleave
+export RPASCAL_THREADS=3
+run_expected test_parallel_for
+unset RPASCAL_THREADS
+run_expected test_vectorize
+$RPASCAL --vec-report -o $TESTS_DIR/test_vectorize_report $TESTS_DIR/test_vectorize.pas > $TESTS_DIR/test_vectorize.report 2>&1
+check "element-wise loops are annotated" grep -q '^  program: line 37, for i annotated with omp simd$' $TESTS_DIR/test_vectorize.report
+check "the prefix loop is not annotated" grep -q '^  program: line 45, for i not annotated: reads a at an offset while writing it$' $TESTS_DIR/test_vectorize.report
+check "Scale's parameters are marked restrict" grep -q '^  Scale: var parameters dst, src marked __restrict$' $TESTS_DIR/test_vectorize.report
+check "AddInto's aliased parameters are not marked restrict" sh -c "! grep -q 'AddInto: var parameters' $TESTS_DIR/test_vectorize.report"
+rm -f $TESTS_DIR/test_vectorize_report $TESTS_DIR/test_vectorize.report
+export RPASCAL_THREADS=3
+run_expected test_auto_parallel --auto-parallel
+unset RPASCAL_THREADS
+$RPASCAL --auto-parallel --par-report -o $TESTS_DIR/test_auto_parallel_report $TESTS_DIR/test_auto_parallel.pas > $TESTS_DIR/test_auto_parallel.report 2>&1
+check "independent loops are parallelised" grep -q '^  line 26, program: for i parallelised$' $TESTS_DIR/test_auto_parallel.report
+check "loops calling a pure function are parallelised" grep -q '^  line 39, program: for i parallelised$' $TESTS_DIR/test_auto_parallel.report
+check "the prefix sum stays serial" grep -q '^  line 30, program: for i not parallelised: uses prefix' $TESTS_DIR/test_auto_parallel.report
+check "the scalar sum stays serial" grep -q '^  line 35, program: for i not parallelised: assigns shared variable total$' $TESTS_DIR/test_auto_parallel.report
+check "short loops stay serial" grep -q '^  line 44, program: for i not parallelised: only 100 iterations' $TESTS_DIR/test_auto_parallel.report
+check "loops doing I/O stay serial" grep -q '^  line 48, program: for i not parallelised: calls Show, which calls writeln$' $TESTS_DIR/test_auto_parallel.report
+rm -f $TESTS_DIR/test_auto_parallel_report $TESTS_DIR/test_auto_parallel.report
+run_expected test_cpp_keywords
+run_expected test_real_types
+run_expected test_threads
+run_expected test_units -I $TESTS_DIR/units
+run_expected test_unit_paths -I $TESTS_DIR/units -I $TESTS_DIR/unitpath
+run_expected test_synthetic -I $TESTS_DIR/units
+
+# Precompiled units: written on first use, read back, rebuilt when damaged
+rm -f $TESTS_DIR/units/textstats.rpu
+run_expected test_unit_cache -I $TESTS_DIR/units
+check "textstats.rpu written" test -f $TESTS_DIR/units/textstats.rpu
+run_expected test_unit_cache -I $TESTS_DIR/units
+echo "not a unit cache" > $TESTS_DIR/units/textstats.rpu
+run_expected test_unit_cache -I $TESTS_DIR/units
+check "damaged textstats.rpu rewritten" grep -q RPU $TESTS_DIR/units/textstats.rpu
+
+# Dependency files: -MD writes <output>.d, -MF names the file
+rm -f $TESTS_DIR/test_depfile.d $TESTS_DIR/test_depfile.mk
+run_expected test_depfile -I $TESTS_DIR/units -MD
+check "test_depfile.d names the program and its units" sh -c "grep -q '^$TESTS_DIR/test_depfile:' $TESTS_DIR/test_depfile.d &&
+    grep -q 'test_depfile.pas' $TESTS_DIR/test_depfile.d &&
+    grep -q 'units/geometry.pas' $TESTS_DIR/test_depfile.d &&
+    grep -q 'units/shapesbase.pas' $TESTS_DIR/test_depfile.d"
+run_expected test_depfile -I $TESTS_DIR/units -MF $TESTS_DIR/test_depfile.mk
+check "-MF writes the named dependency file" grep -q 'units/geometry.pas' $TESTS_DIR/test_depfile.mk
+rm -f $TESTS_DIR/test_depfile.d $TESTS_DIR/test_depfile.mk
+
+# Project build: a clean build compiles everything, a second one nothing,
+# and changing a code generation option rebuilds everything again
+PROJECT_DIR=$TESTS_DIR/project
+rm -rf $PROJECT_DIR/rpascal_build $PROJECT_DIR/test_project
+check "--build compiles the project" sh -c "$RPASCAL --build $PROJECT_DIR | grep -q '2 of 2 units and 1 of 1 programs rebuilt'"
+check "--build project output" sh -c "./$PROJECT_DIR/test_project | diff -u $TESTS_DIR/expected/test_project.out -"
+check "--build rebuilds nothing when up to date" sh -c "$RPASCAL --build $PROJECT_DIR | grep -q '0 of 2 units and 0 of 1 programs rebuilt'"
+check "--build -g rebuilds the project" sh -c "$RPASCAL -g --build $PROJECT_DIR | grep -q '2 of 2 units and 1 of 1 programs rebuilt'"
+rm -rf $PROJECT_DIR/rpascal_build $PROJECT_DIR/test_project
+echo "Regression failures: $REGRESSION_FAILURES"
+echo
+
 echo "==================================================="
 echo "               Test Suite Complete"
 echo "==================================================="
@@ -204,4 +358,6 @@ echo "  - Labels and goto statements"
 echo "  - All major Pascal language constructs"
 echo
 echo "Check individual test outputs above for details."
-echo
\ No newline at end of file
+echo
+# Non-zero when a regression test failed
+exit $((REGRESSION_FAILURES > 0 ? 1 : 0))
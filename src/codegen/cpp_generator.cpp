@@ -1,14 +1,33 @@
 #include "../include/cpp_generator.h"
+#include "../include/parallel.h"
 #include <algorithm>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <set>
+#include <tuple>
 
 namespace rpascal {
 
 CppGenerator::CppGenerator(std::shared_ptr<SymbolTable> symbolTable, UnitLoader* unitLoader)
-    : symbolTable_(symbolTable), unitLoader_(unitLoader), indentLevel_(0) {}
+    : symbolTable_(symbolTable), unitLoader_(unitLoader), indentLevel_(0), separateUnits_(false),
+      parallelRoutines_(true), profiling_(false), tracing_(false), heapStats_(false), samplerRuntime_(false), sampleByDefault_(false),
+      localHeapThreshold_(DEFAULT_LOCAL_HEAP_THRESHOLD), generatingLocals_(false), routineParameters_(nullptr), lineDirectives_(false), lastDirectiveLine_(0), lastDirectiveCppLine_(0),
+      arrayTypes_(std::make_shared<std::map<std::string, ArrayTypeInfo>>()),
+      enumTypes_(std::make_shared<std::map<std::string, EnumTypeInfo>>()) {}
+
+CppGenerator::CppGenerator(const CppGenerator& parent, std::shared_ptr<SymbolTable> symbolTable)
+    : symbolTable_(symbolTable), unitLoader_(parent.unitLoader_), indentLevel_(parent.indentLevel_),
+      separateUnits_(parent.separateUnits_), parallelRoutines_(false), profiling_(parent.profiling_),
+      tracing_(parent.tracing_), heapStats_(parent.heapStats_), samplerRuntime_(parent.samplerRuntime_), sampleByDefault_(parent.sampleByDefault_),
+      localHeapThreshold_(parent.localHeapThreshold_), generatingLocals_(false), routineParameters_(nullptr),
+      lineDirectives_(parent.lineDirectives_), sourceFile_(parent.sourceFile_), cppFile_(parent.cppFile_),
+      lastDirectiveLine_(0), lastDirectiveCppLine_(0),
+      arrayTypes_(parent.arrayTypes_), enumTypes_(parent.enumTypes_),
+      typeMappingCache_(parent.typeMappingCache_), nonTrivialTypes_(parent.nonTrivialTypes_),
+      plainRecordFields_(parent.plainRecordFields_), recordLayouts_(parent.recordLayouts_) {}
 
 std::string CppGenerator::generate(Program& program) {
-    output_.str("");
     output_.clear();
     indentLevel_ = 0;
     
@@ -16,6 +35,105 @@ std::string CppGenerator::generate(Program& program) {
     return output_.str();
 }
 
+std::string CppGenerator::generateUnitHeader(Unit& unit) {
+    output_.clear();
+    indentLevel_ = 0;
+    emittedUnits_.clear();
+    
+    emitLine("#pragma once");
+    emitLine(generateHeaders());
+    emitLine(generateRuntimeIncludes());
+    emitLine("");
+    
+    // Units used by this unit's interface are included, never inlined
+    bool wasSeparate = separateUnits_;
+    separateUnits_ = true;
+    if (unit.getUsesClause()) {
+        const_cast<UsesClause*>(unit.getUsesClause())->accept(*this);
+    }
+    separateUnits_ = wasSeparate;
+    
+    emitLine("// Interface of unit " + unit.getName());
+    for (const auto& decl : unit.getInterfaceDeclarations()) {
+        emitUnitInterfacePrototype(decl.get());
+    }
+    
+    return output_.str();
+}
+
+std::string CppGenerator::generateUnitSource(Unit& unit) {
+    output_.clear();
+    indentLevel_ = 0;
+    
+    emitLine("// Generated by RPascal Compiler");
+    emitLine("#include \"" + unitHeaderName(unit.getName()) + "\"");
+    // The unit's routines report to the same (inline) profiler, trace and
+    // sampler state as the program they are linked into
+    emit(generateInstrumentationRuntimes());
+    emitLine("");
+    
+    std::string programFile = sourceFile_;
+    if (unitLoader_ && !unitLoader_->getUnitFile(unit.getName()).empty()) {
+        sourceFile_ = unitLoader_->getUnitFile(unit.getName());
+    }
+    
+    emitLine("// Implementation of unit " + unit.getName());
+    for (const auto& decl : unit.getImplementationDeclarations()) {
+        decl->accept(*this);
+    }
+    
+    emitUnitInitialization(unit);
+    emitCppLineDirective();
+    sourceFile_ = programFile;
+    
+    return output_.str();
+}
+
+std::string CppGenerator::unitHeaderName(const std::string& unitName) {
+    std::string lowerName = unitName;
+    std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), 
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lowerName + ".h";
+}
+
+void CppGenerator::emitUnitInterfacePrototype(Declaration* decl) {
+    // Routines get a prototype under their mangled name plus an inline
+    // forwarder under the plain name, since call sites may use either
+    std::string returnType = "void";
+    std::string name;
+    const std::vector<std::unique_ptr<VariableDeclaration>>* params = nullptr;
+    if (auto funcDecl = dynamic_cast<FunctionDeclaration*>(decl)) {
+        returnType = mapPascalTypeToCpp(funcDecl->getReturnType());
+        name = funcDecl->getName();
+        params = &funcDecl->getParameters();
+    } else if (auto procDecl = dynamic_cast<ProcedureDeclaration*>(decl)) {
+        name = procDecl->getName();
+        params = &procDecl->getParameters();
+    }
+    
+    if (!params) {
+        // Interface variables are inline so every including file shares one definition
+        if (dynamic_cast<VariableDeclaration*>(decl)) {
+            emit("inline ");
+        }
+        decl->accept(*this);
+        return;
+    }
+    
+    std::string paramList = generateParameterList(*params);
+    std::string mangledName = generateMangledFunctionName(name, *params);
+    emitLine(returnType + " " + mangledName + "(" + paramList + ");");
+    if (mangledName != cppIdentifier(name)) {
+        std::string args;
+        for (size_t i = 0; i < params->size(); ++i) {
+            if (i > 0) args += ", ";
+            args += cppIdentifier((*params)[i]->getName());
+        }
+        emitLine("inline " + returnType + " " + cppIdentifier(name) + "(" + paramList + ") { " +
+                 (returnType == "void" ? "" : "return ") + mangledName + "(" + args + "); }");
+    }
+}
+
 void CppGenerator::visit(LiteralExpression& node) {
     const Token& token = node.getToken();
     
@@ -60,7 +178,7 @@ void CppGenerator::visit(IdentifierExpression& node) {
         if (symbol && symbol->getSymbolType() == SymbolType::CONSTANT && 
             symbol->getDataType() == DataType::CUSTOM) {
             // This is a user-defined enumeration constant, emit as-is
-            emit(name);
+            emit(cppIdentifier(name));
             return;
         }
     }
@@ -73,7 +191,7 @@ void CppGenerator::visit(IdentifierExpression& node) {
     
     // Check if this is a with field access
     if (node.isWithFieldAccess()) {
-        emit(node.getWithVariable() + "." + name);
+        emit(cppIdentifier(node.getWithVariable()) + "." + cppIdentifier(name));
         return;
     }
     
@@ -90,7 +208,7 @@ void CppGenerator::visit(IdentifierExpression& node) {
     }
     
     // Regular variable or constant reference
-    emit(name);
+    emit(cppIdentifier(name));
 }
 
 void CppGenerator::visit(BinaryExpression& node) {
@@ -254,6 +372,16 @@ void CppGenerator::visit(BinaryExpression& node) {
         // Otherwise fall through to standard numeric addition
     }
     
+    // Real division: integer operands are promoted, real ones keep their width
+    if (node.getOperator().getType() == TokenType::DIVIDE) {
+        emit("(pascal_real(");
+        node.getLeft()->accept(*this);
+        emit(") / pascal_real(");
+        node.getRight()->accept(*this);
+        emit("))");
+        return;
+    }
+    
     // Standard binary operators
     emit("(");
     node.getLeft()->accept(*this);
@@ -291,12 +419,12 @@ void CppGenerator::visit(FieldAccessExpression& node) {
         // Use -> syntax instead of *(ptr).field
         dereferenceExpr->getOperand()->accept(*this);
         emit("->");
-        emit(node.getFieldName());
+        emit(cppIdentifier(node.getFieldName()));
     } else {
         // Regular field access
         node.getObject()->accept(*this);
         emit(".");
-        emit(node.getFieldName());
+        emit(cppIdentifier(node.getFieldName()));
     }
 }
 
@@ -315,6 +443,10 @@ void CppGenerator::visit(ArrayIndexExpression& node) {
         if (symbol && symbol->getSymbolType() == SymbolType::VARIABLE) {
             arrayTypeName = symbol->getTypeName();
             arrayDataType = symbol->getDataType();
+            // Packed arrays are indexed like any other
+            if (arrayTypeName.rfind("packed ", 0) == 0) {
+                arrayTypeName.erase(0, 7);
+            }
         }
     }
     
@@ -333,8 +465,8 @@ void CppGenerator::visit(ArrayIndexExpression& node) {
     }
     
     // Check if we have array type information
-    auto arrayTypeIt = arrayTypes_.find(arrayTypeName);
-    if (arrayTypeIt != arrayTypes_.end()) {
+    auto arrayTypeIt = arrayTypes_->find(arrayTypeName);
+    if (arrayTypeIt != arrayTypes_->end()) {
         // Use stored array type info (for complex multi-dimensional arrays)
         const ArrayTypeInfo& info = arrayTypeIt->second;
         
@@ -365,8 +497,8 @@ void CppGenerator::visit(ArrayIndexExpression& node) {
                 for (size_t j = i + 1; j < info.dimensions.size(); ++j) {
                     int dimSize;
                     if (info.dimensions[j].isEnumRange) {
-                        auto enumIt = enumTypes_.find(info.dimensions[j].enumTypeName);
-                        dimSize = enumIt != enumTypes_.end() ? enumIt->second.size() : 1;
+                        auto enumIt = enumTypes_->find(info.dimensions[j].enumTypeName);
+                        dimSize = enumIt != enumTypes_->end() ? enumIt->second.size() : 1;
                     } else {
                         dimSize = info.dimensions[j].endIndex - info.dimensions[j].startIndex + 1;
                     }
@@ -648,17 +780,21 @@ void CppGenerator::visit(RangeExpression& node) {
 }
 
 void CppGenerator::visit(FormattedExpression& node) {
-    // For formatted output in C++, we'll use the main expression
-    // Width and precision will be handled by the output stream
-    // For now, just output the expression (formatting will be done at runtime)
-    const_cast<Expression*>(node.getExpression())->accept(*this);
-    
-    // TODO: In a full implementation, we could generate proper formatting code
-    // For Pascal format "expr:width:precision", we could generate:
-    // std::setw(width) << std::setprecision(precision) << expr
+    // expr:width[:precision] becomes the formatted text, so it works for
+    // Write, WriteLn and Str alike
+    emit("pascal_format(");
+    emitForOutput(const_cast<Expression*>(node.getExpression()));
+    emit(", ");
+    const_cast<Expression*>(node.getWidth())->accept(*this);
+    if (node.getPrecision()) {
+        emit(", ");
+        const_cast<Expression*>(node.getPrecision())->accept(*this);
+    }
+    emit(")");
 }
 
 void CppGenerator::visit(ExpressionStatement& node) {
+    emitLineDirective(node);
     emitIndent();
     node.getExpression()->accept(*this);
     emitLine(";");
@@ -671,6 +807,7 @@ void CppGenerator::visit(CompoundStatement& node) {
 }
 
 void CppGenerator::visit(AssignmentStatement& node) {
+    emitLineDirective(node);
     emitIndent();
     
     // Special handling for Pascal function return value assignment
@@ -697,6 +834,7 @@ void CppGenerator::visit(AssignmentStatement& node) {
 }
 
 void CppGenerator::visit(IfStatement& node) {
+    emitLineDirective(node);
     emitIndent();
     emit("if (");
     node.getCondition()->accept(*this);
@@ -717,6 +855,7 @@ void CppGenerator::visit(IfStatement& node) {
 }
 
 void CppGenerator::visit(WhileStatement& node) {
+    emitLineDirective(node);
     emitIndent();
     emit("while (");
     node.getCondition()->accept(*this);
@@ -730,24 +869,78 @@ void CppGenerator::visit(WhileStatement& node) {
 }
 
 void CppGenerator::visit(ForStatement& node) {
+    emitLineDirective(node);
+    if (node.isParallel()) {
+        generateParallelFor(node);
+        return;
+    }
+    
+    // Element-wise loops are handed to the C++ compiler's vectoriser with
+    // #pragma omp simd, which needs the plain ++/-- form of the loop
+    std::string blocker = elementwiseLoopBlocker(node);
+    reportVector("line " + std::to_string(node.getLocation().line) + ", for " + node.getVariable() +
+                 (blocker.empty() ? " annotated with omp simd" : " not annotated: " + blocker));
+    if (blocker.empty()) {
+        std::string variable = cppIdentifier(node.getVariable());
+        emitIndent();
+        emitLine("#pragma omp simd");
+        emitIndent();
+        emit("for (" + variable + " = ");
+        node.getStart()->accept(*this);
+        emit("; " + variable + (node.isDownto() ? " >= " : " <= "));
+        node.getEnd()->accept(*this);
+        emitLine("; " + std::string(node.isDownto() ? "--" : "++") + variable + ") {");
+        increaseIndent();
+        node.getBody()->accept(*this);
+        decreaseIndent();
+        emitIndent();
+        emitLine("}");
+        return;
+    }
     emitIndent();
+    
+    // A byte, enum or small subrange control variable would wrap around at the
+    // end of its range instead of failing the loop test, so count with an int
+    bool narrowVariable = false;
+    if (symbolTable_) {
+        auto symbol = symbolTable_->lookup(node.getVariable());
+        narrowVariable = symbol && symbol->getSymbolType() == SymbolType::VARIABLE &&
+                         isNarrowOrdinal(symbol->getTypeName());
+    }
+    if (narrowVariable) {
+        std::string counter = "pascal_for_" + node.getVariable();
+        emit("for (int " + counter + " = static_cast<int>(");
+        node.getStart()->accept(*this);
+        emit("); " + counter + (node.isDownto() ? " >= " : " <= ") + "static_cast<int>(");
+        node.getEnd()->accept(*this);
+        emitLine("); " + std::string(node.isDownto() ? "--" : "++") + counter + ") {");
+        increaseIndent();
+        emitIndent();
+        emitLine(cppIdentifier(node.getVariable()) + " = static_cast<decltype(" + cppIdentifier(node.getVariable()) + ")>(" + counter + ");");
+        node.getBody()->accept(*this);
+        decreaseIndent();
+        emitIndent();
+        emitLine("}");
+        return;
+    }
+    
     if (node.isDownto()) {
         // For downto loops: for (var = start; var >= end; var--)
         // Special handling for enum types
-        emit("for (" + node.getVariable() + " = ");
+        emit("for (" + cppIdentifier(node.getVariable()) + " = ");
         node.getStart()->accept(*this);
-        emit("; " + node.getVariable() + " >= ");
+        emit("; " + cppIdentifier(node.getVariable()) + " >= ");
         node.getEnd()->accept(*this);
-        emit("; " + node.getVariable() + " = static_cast<decltype(" + node.getVariable() + ")>(static_cast<int>(" + node.getVariable() + ") - 1)");
+        emit("; " + cppIdentifier(node.getVariable()) + " = static_cast<decltype(" + cppIdentifier(node.getVariable()) + ")>(static_cast<int>(" + cppIdentifier(node.getVariable()) + ") - 1)");
         emitLine(") {");
     } else {
         // For to loops: for (var = start; var <= end; var++)
         // Special handling for enum types
-        emit("for (" + node.getVariable() + " = ");
+        emit("for (" + cppIdentifier(node.getVariable()) + " = ");
         node.getStart()->accept(*this);
-        emit("; " + node.getVariable() + " <= ");
+        emit("; " + cppIdentifier(node.getVariable()) + " <= ");
         node.getEnd()->accept(*this);
-        emit("; " + node.getVariable() + " = static_cast<decltype(" + node.getVariable() + ")>(static_cast<int>(" + node.getVariable() + ") + 1)");
+        emit("; " + cppIdentifier(node.getVariable()) + " = static_cast<decltype(" + cppIdentifier(node.getVariable()) + ")>(static_cast<int>(" + cppIdentifier(node.getVariable()) + ") + 1)");
         emitLine(") {");
     }
     
@@ -758,7 +951,389 @@ void CppGenerator::visit(ForStatement& node) {
     emitLine("}");
 }
 
+// parallel for: the body becomes a lambda over a chunk of iterations that
+// the pascal_parallel pool runs on several threads. The control variable,
+// private variables and reduction variables are redeclared inside it, so each
+// chunk works on its own copies; reductions are folded into the originals
+// under a lock when the chunk ends
+void CppGenerator::generateParallelFor(ForStatement& node) {
+    std::string variable = cppIdentifier(node.getVariable());
+    emitIndent();
+    emitLine("{");
+    increaseIndent();
+    
+    // Types are taken before the lambda, where the names still mean the originals
+    auto declareType = [&](const std::string& name) {
+        emitIndent();
+        emitLine("using pascal_par_type_" + name + " = std::remove_reference_t<decltype(" + name + ")>;");
+    };
+    declareType(variable);
+    for (const auto& name : node.getPrivates()) {
+        declareType(cppIdentifier(name));
+    }
+    for (const auto& reduction : node.getReductions()) {
+        std::string name = cppIdentifier(reduction.variable);
+        declareType(name);
+        emitIndent();
+        emitLine("auto& pascal_par_total_" + name + " = " + name + ";");
+    }
+    if (!node.getReductions().empty()) {
+        emitIndent();
+        emitLine("std::mutex pascal_par_mutex;");
+    }
+    
+    // downto visits the same iterations; their order is unspecified anyway
+    emitIndent();
+    emit("pascal_parallel::forRange(static_cast<long long>(");
+    (node.isDownto() ? node.getEnd() : node.getStart())->accept(*this);
+    emit("), static_cast<long long>(");
+    (node.isDownto() ? node.getStart() : node.getEnd())->accept(*this);
+    emitLine("), [&](long long pascal_par_low, long long pascal_par_high) {");
+    increaseIndent();
+    
+    auto reductionCode = [](const std::string& op) {
+        if (op == "*") return '*';
+        if (op == "min") return '<';
+        if (op == "max") return '>';
+        return '+';
+    };
+    for (const auto& privateName : node.getPrivates()) {
+        std::string name = cppIdentifier(privateName);
+        emitIndent();
+        emitLine("pascal_par_type_" + name + " " + name + "{};");
+    }
+    for (const auto& reduction : node.getReductions()) {
+        std::string name = cppIdentifier(reduction.variable);
+        emitIndent();
+        emitLine("pascal_par_type_" + name + " " + name + " = pascal_parallel::identity<pascal_par_type_" + name +
+                 ">('" + reductionCode(reduction.op) + "');");
+    }
+    // Each chunk is itself vectorised when the body is element-wise
+    std::string blocker = elementwiseLoopBlocker(node);
+    reportVector("line " + std::to_string(node.getLocation().line) + ", parallel for " + node.getVariable() +
+                 (blocker.empty() ? " chunks annotated with omp simd" : " chunks not annotated: " + blocker));
+    if (blocker.empty()) {
+        emitIndent();
+        emitLine("#pragma omp simd");
+    }
+    emitIndent();
+    emitLine("for (long long pascal_par_index = pascal_par_low; pascal_par_index <= pascal_par_high; ++pascal_par_index) {");
+    increaseIndent();
+    emitIndent();
+    emitLine("pascal_par_type_" + variable + " " + variable + " = static_cast<pascal_par_type_" + variable + ">(pascal_par_index);");
+    node.getBody()->accept(*this);
+    decreaseIndent();
+    emitIndent();
+    emitLine("}");
+    
+    if (!node.getReductions().empty()) {
+        emitIndent();
+        emitLine("std::lock_guard<std::mutex> pascal_par_lock(pascal_par_mutex);");
+        for (const auto& reduction : node.getReductions()) {
+            std::string name = cppIdentifier(reduction.variable);
+            std::string total = "pascal_par_total_" + name;
+            emitIndent();
+            if (reduction.op == "min") {
+                emitLine("if (" + name + " < " + total + ") " + total + " = " + name + ";");
+            } else if (reduction.op == "max") {
+                emitLine("if (" + name + " > " + total + ") " + total + " = " + name + ";");
+            } else {
+                emitLine(total + " = " + total + " " + reduction.op + " " + name + ";");
+            }
+        }
+    }
+    decreaseIndent();
+    emitIndent();
+    emitLine("});");
+    decreaseIndent();
+    emitIndent();
+    emitLine("}");
+}
+
+const VariableDeclaration* CppGenerator::routineParameter(const std::string& name) const {
+    if (!routineParameters_) return nullptr;
+    for (const auto& param : *routineParameters_) {
+        if (param->getName() == name) return param.get();
+    }
+    return nullptr;
+}
+
+// Pascal type of a variable or parameter in scope, "" for anything else
+std::string CppGenerator::variableTypeName(const std::string& name) const {
+    if (auto param = routineParameter(name)) return param->getType();
+    if (!symbolTable_) return "";
+    auto symbol = symbolTable_->lookup(name);
+    if (!symbol || symbol->getSymbolType() != SymbolType::VARIABLE) return "";
+    return symbol->getTypeName();
+}
+
+// Integer, real and numeric subrange types, through type aliases
+bool CppGenerator::isNumericType(const std::string& pascalType) const {
+    std::string type = pascalType;
+    for (int depth = 0; depth < 8 && !type.empty(); ++depth) {
+        std::string lowerType = type;
+        std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (lowerType == "integer" || lowerType == "real" || lowerType == "byte" ||
+            lowerType == "single" || lowerType == "double" || lowerType == "extended") return true;
+        size_t rangePos = lowerType.find("..");
+        if (rangePos != std::string::npos) {
+            try {
+                std::stoll(lowerType.substr(0, rangePos));
+                std::stoll(lowerType.substr(rangePos + 2));
+                return true;
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        if (!symbolTable_) return false;
+        auto symbol = symbolTable_->lookup(type);
+        if (!symbol || symbol->getSymbolType() != SymbolType::TYPE_DEF || symbol->getTypeDefinition() == type) {
+            return false;
+        }
+        type = symbol->getTypeDefinition();
+    }
+    return false;
+}
+
+// Element type of a fixed one-dimensional array of numbers, or of such
+// arrays, through type aliases; "" for any other type
+std::string CppGenerator::numericArrayElement(const std::string& pascalType) const {
+    std::string type = pascalType;
+    for (int depth = 0; depth < 8 && !type.empty(); ++depth) {
+        type.erase(0, type.find_first_not_of(" \t\n\r"));
+        type.erase(type.find_last_not_of(" \t\n\r") + 1);
+        std::string lowerType = type;
+        std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (lowerType.rfind("array[", 0) == 0) {
+            size_t bracketEnd = type.find(']');
+            size_t ofPos = type.find(" of ", bracketEnd == std::string::npos ? 0 : bracketEnd);
+            if (bracketEnd == std::string::npos || ofPos == std::string::npos) return "";
+            std::string bounds = lowerType.substr(6, bracketEnd - 6);
+            if (bounds.find(',') != std::string::npos || bounds.find("..") == std::string::npos) return "";
+            std::string elementType = type.substr(ofPos + 4);
+            elementType.erase(0, elementType.find_first_not_of(" \t\n\r"));
+            if (isNumericType(elementType) || !numericArrayElement(elementType).empty()) return elementType;
+            return "";
+        }
+        if (!symbolTable_) return "";
+        auto symbol = symbolTable_->lookup(type);
+        if (!symbol || symbol->getSymbolType() != SymbolType::TYPE_DEF || symbol->getTypeDefinition() == type) {
+            return "";
+        }
+        type = symbol->getTypeDefinition();
+    }
+    return "";
+}
+
+// Numeric arrays spanning a vector register or more start on a 32-byte
+// boundary (AVX), on a cache line (64, also AVX-512) from 1 KB up; 0 = as is
+size_t CppGenerator::vectorAlignment(const std::string& pascalType) const {
+    if (numericArrayElement(pascalType).empty()) return 0;
+    auto layout = typeLayout(pascalType);
+    if (!layout || layout->size < 64) return 0;
+    return layout->size >= 1024 ? 64 : 32;
+}
+
+// Why a for loop can't carry #pragma omp simd, "" if it can. The loop must
+// count an integer over bounds it doesn't change and only assign numeric
+// array elements at the control variable, from numbers, scalars, pure math
+// functions and other elements. Elements at an offset from the control
+// variable may only be read from arrays the loop doesn't write, and then
+// no array involved may be a parameter that could alias another one
+std::string CppGenerator::elementwiseLoopBlocker(ForStatement& node) const {
+    const std::string& variable = node.getVariable();
+    std::string controlType = variableTypeName(variable);
+    std::transform(controlType.begin(), controlType.end(), controlType.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (controlType != "integer") {
+        return "control variable " + variable + " is not an integer variable";
+    }
+    
+    static const std::set<std::string> pureFunctions = {
+        "abs", "sqr", "sqrt", "sin", "cos", "arctan", "exp", "ln", "trunc", "round"
+    };
+    std::set<std::string> written;   // arrays assigned at the control variable
+    std::set<std::string> shifted;   // arrays read at any other index
+    std::string blocker;
+    
+    auto isControl = [&](Expression* expr) {
+        auto identifier = dynamic_cast<IdentifierExpression*>(expr);
+        return identifier && identifier->getName() == variable;
+    };
+    auto isConstant = [&](Expression* expr) {
+        if (auto literal = dynamic_cast<LiteralExpression*>(expr)) {
+            return literal->getToken().getType() == TokenType::INTEGER_LITERAL;
+        }
+        auto identifier = dynamic_cast<IdentifierExpression*>(expr);
+        if (!identifier || !symbolTable_ || routineParameter(identifier->getName())) return false;
+        auto symbol = symbolTable_->lookup(identifier->getName());
+        return symbol && symbol->getSymbolType() == SymbolType::CONSTANT;
+    };
+    
+    // inBound: part of a loop bound, which may read neither arrays nor the control variable
+    std::function<bool(Expression*, bool)> pure = [&](Expression* expr, bool inBound) -> bool {
+        if (auto literal = dynamic_cast<LiteralExpression*>(expr)) {
+            TokenType type = literal->getToken().getType();
+            if (type == TokenType::INTEGER_LITERAL || type == TokenType::REAL_LITERAL) return true;
+            blocker = "uses a non-numeric literal";
+            return false;
+        }
+        if (auto identifier = dynamic_cast<IdentifierExpression*>(expr)) {
+            const std::string& name = identifier->getName();
+            if (name == variable) {
+                if (!inBound) return true;
+                blocker = "a bound uses the control variable";
+                return false;
+            }
+            if (auto param = routineParameter(name)) {
+                if (param->getParameterMode() == ParameterMode::VALUE && isNumericType(param->getType())) return true;
+                blocker = param->getParameterMode() == ParameterMode::VALUE ? "reads " + name + ", which is not numeric"
+                                                                            : "reads var parameter " + name;
+                return false;
+            }
+            auto symbol = symbolTable_ ? symbolTable_->lookup(name) : nullptr;
+            if (symbol && symbol->getSymbolType() == SymbolType::CONSTANT) return true;
+            if (symbol && symbol->getSymbolType() == SymbolType::VARIABLE && isNumericType(symbol->getTypeName())) return true;
+            if (symbol && (symbol->getSymbolType() == SymbolType::FUNCTION || symbol->getSymbolType() == SymbolType::PROCEDURE)) {
+                blocker = "calls " + name;
+            } else {
+                blocker = "reads " + name + ", which is not a numeric variable";
+            }
+            return false;
+        }
+        if (auto binary = dynamic_cast<BinaryExpression*>(expr)) {
+            switch (binary->getOperator().getType()) {
+                case TokenType::PLUS: case TokenType::MINUS: case TokenType::MULTIPLY:
+                case TokenType::DIVIDE: case TokenType::DIV: case TokenType::MOD:
+                    return pure(binary->getLeft(), inBound) && pure(binary->getRight(), inBound);
+                default:
+                    blocker = "uses operator " + binary->getOperator().getValue();
+                    return false;
+            }
+        }
+        if (auto unary = dynamic_cast<UnaryExpression*>(expr)) {
+            TokenType type = unary->getOperator().getType();
+            if (type == TokenType::MINUS || type == TokenType::PLUS) return pure(unary->getOperand(), inBound);
+            blocker = "uses operator " + unary->getOperator().getValue();
+            return false;
+        }
+        if (auto access = dynamic_cast<ArrayIndexExpression*>(expr)) {
+            auto array = dynamic_cast<IdentifierExpression*>(access->getArray());
+            if (inBound) {
+                blocker = "a bound reads an array";
+                return false;
+            }
+            if (!array || access->getIndices().size() != 1 ||
+                !isNumericType(numericArrayElement(variableTypeName(array->getName())))) {
+                blocker = "reads an element that is not from a one-dimensional numeric array";
+                return false;
+            }
+            Expression* index = access->getIndex();
+            if (isControl(index)) return true;
+            auto offset = dynamic_cast<BinaryExpression*>(index);
+            bool plusOrMinus = offset && (offset->getOperator().getType() == TokenType::PLUS ||
+                                          offset->getOperator().getType() == TokenType::MINUS);
+            if (isConstant(index) ||
+                (plusOrMinus && isControl(offset->getLeft()) && isConstant(offset->getRight())) ||
+                (offset && offset->getOperator().getType() == TokenType::PLUS &&
+                 isConstant(offset->getLeft()) && isControl(offset->getRight()))) {
+                shifted.insert(array->getName());
+                return true;
+            }
+            blocker = "reads " + array->getName() + " at an index other than " + variable + " plus a constant";
+            return false;
+        }
+        if (auto call = dynamic_cast<CallExpression*>(expr)) {
+            auto callee = dynamic_cast<IdentifierExpression*>(call->getCallee());
+            std::string name = callee ? callee->getName() : "";
+            std::transform(name.begin(), name.end(), name.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (pureFunctions.count(name) == 0) {
+                blocker = "calls " + (callee ? callee->getName() : std::string("a routine"));
+                return false;
+            }
+            for (const auto& argument : call->getArguments()) {
+                if (!pure(argument.get(), inBound)) return false;
+            }
+            return true;
+        }
+        blocker = "uses an expression other than arithmetic on numbers and array elements";
+        return false;
+    };
+    
+    if (!pure(node.getStart(), true) || !pure(node.getEnd(), true)) {
+        return blocker;
+    }
+    
+    std::function<bool(Statement*)> elementwise = [&](Statement* statement) -> bool {
+        if (!statement) return true;
+        if (auto compound = dynamic_cast<CompoundStatement*>(statement)) {
+            for (const auto& inner : compound->getStatements()) {
+                if (!elementwise(inner.get())) return false;
+            }
+            return true;
+        }
+        auto assignment = dynamic_cast<AssignmentStatement*>(statement);
+        if (!assignment) {
+            blocker = dynamic_cast<ForStatement*>(statement) ? "body contains another loop"
+                                                              : "body contains statements other than assignments";
+            return false;
+        }
+        auto target = dynamic_cast<ArrayIndexExpression*>(assignment->getTarget());
+        auto array = target ? dynamic_cast<IdentifierExpression*>(target->getArray()) : nullptr;
+        if (!array) {
+            auto scalar = dynamic_cast<IdentifierExpression*>(assignment->getTarget());
+            blocker = scalar ? "assigns scalar " + scalar->getName() : "assigns something other than an array element";
+            return false;
+        }
+        if (target->getIndices().size() != 1 || !isControl(target->getIndex()) ||
+            !isNumericType(numericArrayElement(variableTypeName(array->getName())))) {
+            blocker = "assigns " + array->getName() + " other than as a numeric element at " + variable;
+            return false;
+        }
+        written.insert(array->getName());
+        return pure(assignment->getValue(), false);
+    };
+    if (!elementwise(node.getBody())) {
+        return blocker;
+    }
+    
+    if (!shifted.empty()) {
+        for (const auto& name : shifted) {
+            if (written.count(name)) return "reads " + name + " at an offset while writing it";
+        }
+        std::set<std::string> arrays = written;
+        arrays.insert(shifted.begin(), shifted.end());
+        for (const auto& name : arrays) {
+            auto param = routineParameter(name);
+            if (param && param->getParameterMode() != ParameterMode::VALUE && !param->isNoAlias()) {
+                return name + " may alias another array";
+            }
+        }
+    }
+    return "";
+}
+
+void CppGenerator::reportVector(const std::string& text) {
+    vectorReport_.push_back((routineName_.empty() ? std::string("program") : routineName_) + ": " + text);
+}
+
+void CppGenerator::reportRestrictParameters(const std::vector<std::unique_ptr<VariableDeclaration>>& parameters) {
+    std::string names;
+    for (const auto& param : parameters) {
+        if (param->isNoAlias()) {
+            names += (names.empty() ? "" : ", ") + param->getName();
+        }
+    }
+    if (!names.empty()) {
+        reportVector("var parameters " + names + " marked __restrict");
+    }
+}
+
 void CppGenerator::visit(RepeatStatement& node) {
+    emitLineDirective(node);
     emitIndent();
     emitLine("do {");
     
@@ -773,6 +1348,7 @@ void CppGenerator::visit(RepeatStatement& node) {
 }
 
 void CppGenerator::visit(CaseStatement& node) {
+    emitLineDirective(node);
     emitIndent();
     emit("switch (");
     node.getExpression()->accept(*this);
@@ -886,13 +1462,19 @@ void CppGenerator::visit(CaseStatement& node) {
 }
 
 void CppGenerator::visit(WithStatement& node) {
+    emitLineDirective(node);
     // Generate nested scopes with reference aliases for each with expression
     // Example: with point, person.address do x := 10;
-    // Becomes: { auto& __with_0 = point; { auto& __with_1 = person.address; x = 10; } }
+    // Becomes: { auto&& __with_0 = point; { auto&& pascal_with_0 = person.address; pascal_with_0.x = 10; } }
+    // auto&& also binds the element proxies of {$SOA} arrays
     
     for (size_t i = 0; i < node.getWithExpressions().size(); ++i) {
+        std::string alias = node.getAlias(i);
+        if (alias.empty()) {
+            alias = "__with_" + std::to_string(i);
+        }
         emitIndent();
-        emit("{ auto& __with_" + std::to_string(i) + " = ");
+        emit("{ auto&& " + alias + " = ");
         node.getWithExpressions()[i]->accept(*this);
         emitLine(";");
         increaseIndent();
@@ -910,26 +1492,28 @@ void CppGenerator::visit(WithStatement& node) {
 }
 
 void CppGenerator::visit(LabelStatement& node) {
+    emitLineDirective(node);
     // Generate C++ label
     emitIndent();
     emitLine("label_" + node.getLabel() + ":;");
 }
 
 void CppGenerator::visit(GotoStatement& node) {
+    emitLineDirective(node);
     // Generate C++ goto statement
     emitIndent();
     emitLine("goto label_" + node.getTarget() + ";");
 }
 
 void CppGenerator::visit(BreakStatement& node) {
-    (void)node; // Suppress unused parameter warning
+    emitLineDirective(node);
     // Generate C++ break statement
     emitIndent();
     emitLine("break;");
 }
 
 void CppGenerator::visit(ContinueStatement& node) {
-    (void)node; // Suppress unused parameter warning
+    emitLineDirective(node);
     // Generate C++ continue statement
     emitIndent();
     emitLine("continue;");
@@ -937,7 +1521,7 @@ void CppGenerator::visit(ContinueStatement& node) {
 
 void CppGenerator::visit(ConstantDeclaration& node) {
     emitIndent();
-    emit("const auto " + node.getName() + " = ");
+    emit("const auto " + cppIdentifier(node.getName()) + " = ");
     node.getValue()->accept(*this);
     emitLine(";");
 }
@@ -952,6 +1536,18 @@ void CppGenerator::visit(LabelDeclaration& node) {
 void CppGenerator::visit(TypeDefinition& node) {
     const std::string& definition = node.getDefinition();
     
+    bool isEnum = definition.length() > 2 && definition[0] == '(' && definition.back() == ')';
+    if (!isEnum && !hasTrivialStorage(definition)) {
+        std::string lowerName = node.getName();
+        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        nonTrivialTypes_.insert(lowerName);
+    }
+    
+    if (node.isStructOfArrays() && definition.find("array[") == std::string::npos) {
+        emitLine("// {$SOA} ignored: " + node.getName() + " is not an array type");
+    }
+    
     // Handle enumeration types
     if (definition.length() > 2 && definition[0] == '(' && definition.back() == ')') {
         generateEnumDefinition(node.getName(), definition);
@@ -962,7 +1558,7 @@ void CppGenerator::visit(TypeDefinition& node) {
     } 
     // Handle array types
     else if (definition.find("array[") != std::string::npos) {
-        generateArrayDefinition(node.getName(), definition);
+        generateArrayDefinition(node.getName(), definition, node.isStructOfArrays());
     } 
     // Handle set types
     else if (definition.find("set of") != std::string::npos) {
@@ -986,36 +1582,69 @@ void CppGenerator::visit(TypeDefinition& node) {
     }
     // Handle text files
     else if (definition == "text") {
-        emitLine("using " + node.getName() + " = PascalFile;");
+        emitLine("using " + cppIdentifier(node.getName()) + " = PascalFile;");
     }
     // Handle untyped files
     else if (definition == "file") {
-        emitLine("using " + node.getName() + " = PascalFile;");
+        emitLine("using " + cppIdentifier(node.getName()) + " = PascalFile;");
     }
     else {
         // For other types, generate a comment for now
         emitLine("// Type definition: " + node.getName() + " = " + definition);
-        emitLine("using " + node.getName() + " = int; // TODO: implement proper type");
+        emitLine("using " + cppIdentifier(node.getName()) + " = int; // TODO: implement proper type");
     }
+    
+    // The enum and array tables may have changed, and mappings depend on them
+    typeMappingCache_.clear();
 }
 
 void CppGenerator::visit(RecordTypeDefinition& node) {
+    bool trivial = true;
+    for (const auto& field : node.getFields()) {
+        trivial = trivial && hasTrivialStorage(field.getType());
+    }
+    if (node.hasVariantPart()) {
+        for (const auto& variantCase : node.getVariantPart()->getCases()) {
+            for (const auto& field : variantCase->getFields()) {
+                trivial = trivial && hasTrivialStorage(field.getType());
+            }
+        }
+    }
+    
+    // Packed records drop all padding. Strings, sets and files keep their
+    // alignment: a misaligned object with constructors isn't worth the risk
+    bool packed = node.isPacked() && trivial;
+    if (packed) {
+        emitLine("#pragma pack(push, 1)");
+    } else if (node.isPacked()) {
+        emitLine("// packed ignored: " + node.getName() + " has fields with constructors");
+    }
+    recordLayouts_.push_back(computeRecordLayout(node, packed));
+    typeMappingCache_.clear();
+    if (!node.hasVariantPart()) {
+        std::string lowerName = node.getName();
+        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        plainRecordFields_[lowerName] = node.getFields();
+    }
+    
     // Generate C++ struct definition from RecordTypeDefinition AST node
-    emitLine("struct " + node.getName() + " {");
+    emitLine("struct " + cppIdentifier(node.getName()) + " {");
     increaseIndent();
     
     // Generate field declarations from the AST fields
     for (const auto& field : node.getFields()) {
         emitIndent();
-        emitLine(mapPascalTypeToCpp(field.getType()) + " " + field.getName() + ";");
+        emitLine(mapPascalTypeToCpp(field.getType()) + " " + cppIdentifier(field.getName()) + ";");
     }
     
     // Generate variant part if present
     if (node.hasVariantPart()) {
         const VariantPart* variantPart = node.getVariantPart();
         
-        // Check if the selector field is already defined in regular fields
-        bool selectorAlreadyDefined = false;
+        // Check if the selector field is already defined in regular fields;
+        // a tagless variant part has no selector field at all
+        bool selectorAlreadyDefined = variantPart->getSelectorName().empty();
         for (const auto& field : node.getFields()) {
             if (field.getName() == variantPart->getSelectorName()) {
                 selectorAlreadyDefined = true;
@@ -1026,17 +1655,45 @@ void CppGenerator::visit(RecordTypeDefinition& node) {
         // Generate the selector field only if not already defined
         if (!selectorAlreadyDefined) {
             emitIndent();
-            emitLine(mapPascalTypeToCpp(variantPart->getSelectorType()) + " " + variantPart->getSelectorName() + ";");
+            emitLine(mapPascalTypeToCpp(variantPart->getSelectorType()) + " " + cppIdentifier(variantPart->getSelectorName()) + ";");
         }
         
-        // For variant records, generate all variant fields as regular fields
-        // This simplifies the implementation and matches Pascal's behavior where
-        // all variant fields are accessible (with programmer responsibility for correctness)
-        for (const auto& variantCase : variantPart->getCases()) {
-            for (const auto& field : variantCase->getFields()) {
+        // As in Turbo Pascal the variant cases overlay each other after the
+        // fixed part, so the record is as large as its largest case rather than
+        // all cases together
+        std::vector<const RecordField*> ownStorage;
+        std::vector<std::vector<const RecordField*>> overlaid;
+        splitVariantFields(*variantPart, ownStorage, overlaid);
+        
+        for (const RecordField* field : ownStorage) {
+            emitIndent();
+            emitLine(mapPascalTypeToCpp(field->getType()) + " " + cppIdentifier(field->getName()) + ";");
+        }
+        
+        if (!overlaid.empty()) {
+            emitIndent();
+            emitLine("union {");
+            increaseIndent();
+            for (const auto& caseFields : overlaid) {
+                if (caseFields.size() == 1) {
+                    emitIndent();
+                    emitLine(mapPascalTypeToCpp(caseFields[0]->getType()) + " " + cppIdentifier(caseFields[0]->getName()) + ";");
+                    continue;
+                }
                 emitIndent();
-                emitLine(mapPascalTypeToCpp(field.getType()) + " " + field.getName() + ";");
+                emitLine("struct {");
+                increaseIndent();
+                for (const RecordField* field : caseFields) {
+                    emitIndent();
+                    emitLine(mapPascalTypeToCpp(field->getType()) + " " + cppIdentifier(field->getName()) + ";");
+                }
+                decreaseIndent();
+                emitIndent();
+                emitLine("};");
             }
+            decreaseIndent();
+            emitIndent();
+            emitLine("};");
         }
         
         // Add constructor to handle initialization
@@ -1044,50 +1701,198 @@ void CppGenerator::visit(RecordTypeDefinition& node) {
         emitIndent();
         emitLine("// Default constructor");
         emitIndent();
-        emit(node.getName() + "() : ");
+        emit(cppIdentifier(node.getName()) + "()");
         
-        // Initialize all fields
+        // Initialize the fixed fields, the selector and the fields outside the union
         bool first = true;
-        for (const auto& field : node.getFields()) {
-            if (!first) emit(", ");
-            emit(field.getName() + "()");
+        auto initialize = [&](const std::string& name) {
+            emit(first ? " : " : ", ");
+            emit(cppIdentifier(name) + "()");
             first = false;
+        };
+        for (const auto& field : node.getFields()) {
+            initialize(field.getName());
         }
-        
-        if (variantPart) {
-            // Only initialize selector if not already initialized in regular fields
-            if (!selectorAlreadyDefined) {
-                if (!first) emit(", ");
-                emit(variantPart->getSelectorName() + "()");
-                first = false;
-            }
-            
-            for (const auto& variantCase : variantPart->getCases()) {
-                for (const auto& field : variantCase->getFields()) {
-                    if (!first) emit(", ");
-                    emit(field.getName() + "()");
-                    first = false;
-                }
-            }
+        if (!selectorAlreadyDefined) {
+            initialize(variantPart->getSelectorName());
+        }
+        for (const RecordField* field : ownStorage) {
+            initialize(field->getName());
         }
         
-        emitLine(" {}");
+        if (overlaid.empty()) {
+            emitLine(" {}");
+        } else {
+            // The union is the last member: zero from its start to the end of the record
+            std::string unionStart = cppIdentifier(overlaid.front().front()->getName());
+            emitLine(" {");
+            increaseIndent();
+            emitIndent();
+            emitLine("std::memset(static_cast<void*>(&" + unionStart + "), 0, reinterpret_cast<char*>(this + 1) - reinterpret_cast<char*>(&" + unionStart + "));");
+            decreaseIndent();
+            emitIndent();
+            emitLine("}");
+        }
+    }
+    
+    if (!trivial) {
+        std::string lowerName = node.getName();
+        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        nonTrivialTypes_.insert(lowerName);
     }
     
     decreaseIndent();
     emitLine("};");
+    if (packed) {
+        emitLine("#pragma pack(pop)");
+    }
     emitLine("");
 }
 
-void CppGenerator::visit(VariableDeclaration& node) {
-    std::string cppType = mapPascalTypeToCpp(node.getType());
-    emitIndent();
-    emit(cppType + " " + node.getName());
-    
-    // Register variable in symbol table for proper lookups
-    if (symbolTable_) {
-        DataType dataType = symbolTable_->resolveDataType(node.getType());
-        auto symbol = std::make_shared<Symbol>(node.getName(), SymbolType::VARIABLE, dataType);
+void CppGenerator::splitVariantFields(const VariantPart& variantPart, std::vector<const RecordField*>& ownStorage,
+                                      std::vector<std::vector<const RecordField*>>& overlaid) const {
+    // Fields with constructors (strings, sets, files) can't live in a union;
+    // they get their own storage before it
+    for (const auto& variantCase : variantPart.getCases()) {
+        std::vector<const RecordField*> caseFields;
+        for (const auto& field : variantCase->getFields()) {
+            if (hasTrivialStorage(field.getType())) {
+                caseFields.push_back(&field);
+            } else {
+                ownStorage.push_back(&field);
+            }
+        }
+        if (!caseFields.empty()) {
+            overlaid.push_back(std::move(caseFields));
+        }
+    }
+}
+
+CppGenerator::RecordLayout CppGenerator::computeRecordLayout(const RecordTypeDefinition& node, bool packed) const {
+    // Mirrors the struct emitted by visit(RecordTypeDefinition&): fixed fields,
+    // selector, variant fields with their own storage, then the union
+    RecordLayout layout;
+    layout.name = node.getName();
+    layout.packRequested = node.isPacked();
+    layout.packed = packed;
+    
+    auto roundUp = [](size_t value, size_t align) { return (value + align - 1) / align * align; };
+    size_t payload = 0;
+    auto place = [&](const RecordField& field, size_t& offset, size_t& align) -> std::optional<size_t> {
+        auto type = typeLayout(field.getType());
+        if (!type) {
+            if (layout.unknownField.empty()) {
+                layout.unknownField = field.getName() + ": " + field.getType();
+            }
+            return std::nullopt;
+        }
+        size_t fieldAlign = packed ? 1 : type->align;
+        offset = roundUp(offset, fieldAlign);
+        size_t at = offset;
+        offset += type->size;
+        align = std::max(align, fieldAlign);
+        return at;
+    };
+    
+    std::vector<const RecordField*> sequential;
+    for (const auto& field : node.getFields()) {
+        sequential.push_back(&field);
+    }
+    std::vector<const RecordField*> ownStorage;
+    std::vector<std::vector<const RecordField*>> overlaid;
+    RecordField selector("", "");
+    if (const VariantPart* variantPart = node.getVariantPart()) {
+        bool selectorAlreadyDefined = variantPart->getSelectorName().empty();
+        for (const auto& field : node.getFields()) {
+            selectorAlreadyDefined = selectorAlreadyDefined || field.getName() == variantPart->getSelectorName();
+        }
+        if (!selectorAlreadyDefined) {
+            selector = RecordField(variantPart->getSelectorName(), variantPart->getSelectorType());
+            sequential.push_back(&selector);
+        }
+        splitVariantFields(*variantPart, ownStorage, overlaid);
+        sequential.insert(sequential.end(), ownStorage.begin(), ownStorage.end());
+    }
+    
+    size_t offset = 0;
+    for (const RecordField* field : sequential) {
+        auto at = place(*field, offset, layout.align);
+        if (!at) return layout;
+        layout.fields.push_back({field->getName(), field->getType(), *at, offset - *at, false});
+        payload += offset - *at;
+    }
+    
+    if (!overlaid.empty()) {
+        // Lay out each case on its own, then put the union where it fits
+        size_t unionSize = 0;
+        size_t unionAlign = 1;
+        size_t largestCase = 0;
+        std::vector<FieldLayout> caseFields;
+        for (const auto& fields : overlaid) {
+            size_t caseOffset = 0;
+            size_t caseAlign = 1;
+            size_t caseBytes = 0;
+            for (const RecordField* field : fields) {
+                auto at = place(*field, caseOffset, caseAlign);
+                if (!at) return layout;
+                caseFields.push_back({field->getName(), field->getType(), *at, caseOffset - *at, true});
+                caseBytes += caseOffset - *at;
+            }
+            unionSize = std::max(unionSize, roundUp(caseOffset, caseAlign));
+            unionAlign = std::max(unionAlign, caseAlign);
+            largestCase = std::max(largestCase, caseBytes);
+        }
+        offset = roundUp(offset, unionAlign);
+        for (auto& field : caseFields) {
+            field.offset += offset;
+            layout.fields.push_back(field);
+        }
+        offset += roundUp(unionSize, unionAlign);
+        layout.align = std::max(layout.align, unionAlign);
+        payload += largestCase;
+    }
+    
+    // An empty struct still occupies a byte
+    layout.size = std::max<size_t>(roundUp(offset, layout.align), 1);
+    layout.padding = layout.size - payload;
+    return layout;
+}
+
+void CppGenerator::visit(VariableDeclaration& node) {
+    std::string cppType = mapPascalTypeToCpp(node.getType());
+    emitIndent();
+    
+    // Locals too large for the stack go to the per-thread frame arena; the
+    // variable is a reference to the block, released when the routine returns
+    std::optional<TypeLayout> layout;
+    if (generatingLocals_ && localHeapThreshold_ > 0 && !node.getInitializer()) {
+        layout = typeLayout(node.getType());
+    }
+    size_t alignment = vectorAlignment(node.getType());
+    if (alignment) {
+        reportVector("var " + node.getName() + " aligned to " + std::to_string(alignment) + " bytes");
+    }
+    if (layout && layout->size > localHeapThreshold_) {
+        std::string localType = cppType + (alignment ? ", " + std::to_string(alignment) : "");
+        emitLine("pascal_frame::Local<" + localType + "> pascal_frame_" + node.getName() + "; // " +
+                 std::to_string(layout->size) + " bytes");
+        emitIndent();
+        emit(cppType + "& " + cppIdentifier(node.getName()) + " = *pascal_frame_" + node.getName());
+    } else {
+        if (node.isThreadLocal()) {
+            emit("thread_local ");
+        }
+        emit(cppType + " " + cppIdentifier(node.getName()));
+        if (alignment) {
+            emit(" alignas(" + std::to_string(alignment) + ")");
+        }
+    }
+    
+    // Register variable in symbol table for proper lookups
+    if (symbolTable_) {
+        DataType dataType = symbolTable_->resolveDataType(node.getType());
+        auto symbol = std::make_shared<Symbol>(node.getName(), SymbolType::VARIABLE, dataType);
         symbol->setTypeName(node.getType()); // Use original Pascal type name, not C++ mapped type
         
         // Handle pointer types - set pointee information
@@ -1135,15 +1940,24 @@ void CppGenerator::visit(ProcedureDeclaration& node) {
         emitLine("");
     }
     
+    // Type names may resolve differently while this routine's names are defined
+    typeMappingCache_.clear();
     std::string mangledName = generateMangledFunctionName(node.getName(), node.getParameters());
+    routineParameters_ = &node.getParameters();
+    routineName_ = node.getName();
+    reportRestrictParameters(node.getParameters());
+    emitLineDirective(node);
     emitLine("void " + mangledName + "(" + generateParameterList(node.getParameters()) + ") {");
     
     increaseIndent();
+    emitRoutineProbes(node.getName(), node);
     
     // Generate local variable declarations
+    generatingLocals_ = true;
     for (const auto& localVar : node.getLocalVariables()) {
         localVar->accept(*this);
     }
+    generatingLocals_ = false;
     
     // Enter procedure scope and add parameters for proper type resolution during code generation
     symbolTable_->enterScope();
@@ -1155,13 +1969,17 @@ void CppGenerator::visit(ProcedureDeclaration& node) {
     }
     
     node.getBody()->accept(*this);
+    routineParameters_ = nullptr;
+    routineName_.clear();
     
     // Exit procedure scope
     symbolTable_->exitScope();
+    typeMappingCache_.clear();
     
     decreaseIndent();
     
     emitLine("}");
+    emitSampleRoutineName(mangledName, node.getName());
     emitLine("");
 }
 
@@ -1183,21 +2001,30 @@ void CppGenerator::visit(FunctionDeclaration& node) {
         nestedDecl->accept(*this);
     }
     
+    // Type names may resolve differently while this routine's names are defined
+    typeMappingCache_.clear();
     std::string returnType = mapPascalTypeToCpp(node.getReturnType());
     std::string mangledName = generateMangledFunctionName(node.getName(), node.getParameters());
     
+    routineParameters_ = &node.getParameters();
+    routineName_ = node.getName();
+    reportRestrictParameters(node.getParameters());
+    emitLineDirective(node);
     emitLine(returnType + " " + mangledName + "(" + generateParameterList(node.getParameters()) + ") {");
     
     increaseIndent();
+    emitRoutineProbes(node.getName(), node);
     
     // Declare return variable (Pascal functions assign to function name)
     emitIndent();
     emitLine(returnType + " " + node.getName() + "_result;");
     
     // Generate local variable declarations
+    generatingLocals_ = true;
     for (const auto& localVar : node.getLocalVariables()) {
         localVar->accept(*this);
     }
+    generatingLocals_ = false;
     
     // Enter function scope and add parameters for proper type resolution during code generation
     symbolTable_->enterScope();
@@ -1213,9 +2040,12 @@ void CppGenerator::visit(FunctionDeclaration& node) {
     node.getBody()->accept(*this);
     currentFunction_ = "";
     currentFunctionOriginalName_ = "";
+    routineParameters_ = nullptr;
+    routineName_.clear();
     
     // Exit function scope
     symbolTable_->exitScope();
+    typeMappingCache_.clear();
     
     // Return the result
     emitIndent();
@@ -1224,18 +2054,23 @@ void CppGenerator::visit(FunctionDeclaration& node) {
     decreaseIndent();
     
     emitLine("}");
+    emitSampleRoutineName(mangledName, node.getName());
     emitLine("");
 }
 
 void CppGenerator::visit(Program& node) {
+    emittedUnits_.clear();
+    
     // Generate headers
     emitLine(generateHeaders());
     emitLine(generateRuntimeIncludes());
+    emit(generateInstrumentationRuntimes());
     emitLine("");
     
     // Generate uses clause includes
     if (node.getUsesClause()) {
         node.getUsesClause()->accept(*this);
+        emitCppLineDirective();
     }
     
     // Generate forward declarations
@@ -1263,13 +2098,14 @@ void CppGenerator::visit(Program& node) {
     }
     
     // Generate procedures and functions
+    std::vector<Declaration*> routines;
     for (const auto& decl : node.getDeclarations()) {
-        if (auto procDecl = dynamic_cast<ProcedureDeclaration*>(decl.get())) {
-            procDecl->accept(*this);
-        } else if (auto funcDecl = dynamic_cast<FunctionDeclaration*>(decl.get())) {
-            funcDecl->accept(*this);
+        if (dynamic_cast<ProcedureDeclaration*>(decl.get()) || dynamic_cast<FunctionDeclaration*>(decl.get())) {
+            routines.push_back(decl.get());
         }
     }
+    generateRoutines(routines);
+    emitCppLineDirective();
     
     // Global variables for Pascal command line arguments
     emitLine("// Global variables for Pascal system functions");
@@ -1335,6 +2171,23 @@ void CppGenerator::visit(Program& node) {
     emitLine("pascal_argc = argc;");
     emitIndent();
     emitLine("pascal_argv = argv;");
+    if (profiling_) {
+        emitIndent();
+        emitLine("pascal_profile::start(\"" + escapeCppString(node.getName()) + "\", \"" + escapeCppString(sourceFile_) + "\");");
+    }
+    if (tracing_) {
+        emitIndent();
+        emitLine("pascal_trace::start(\"" + escapeCppString(node.getName()) + "\");");
+    }
+    if (heapStats_) {
+        emitIndent();
+        emitLine("pascal_heap::start(\"" + escapeCppString(node.getName()) + "\");");
+    }
+    if (samplerRuntime_) {
+        emitIndent();
+        emitLine("pascal_sample::start(\"" + escapeCppString(node.getName()) + "\", " +
+                 (sampleByDefault_ ? "true" : "false") + ");");
+    }
     emitLine("");
     
     node.getMainBlock()->accept(*this);
@@ -1346,6 +2199,72 @@ void CppGenerator::visit(Program& node) {
     emitLine("}");
 }
 
+void CppGenerator::generateRoutines(const std::vector<Declaration*>& routines) {
+    if (!parallelRoutines_ || routines.size() < PARALLEL_ROUTINE_THRESHOLD || !symbolTable_) {
+        for (auto* routine : routines) {
+            routine->accept(*this);
+        }
+        return;
+    }
+    
+    // Each routine is generated by its own generator into its own buffer.
+    // Type metadata is shared read-only; symbol definitions go to a private
+    // overlay of the global scope. Buffers are joined in declaration order.
+    std::vector<std::string> buffers(routines.size());
+    std::vector<std::vector<std::string>> reports(routines.size());
+    std::vector<std::shared_ptr<SymbolTable>> overlays(routines.size());
+    std::vector<std::tuple<std::string, size_t, size_t>> lineStates(routines.size());
+    Scope* globalScope = symbolTable_->getCurrentScope();
+    runParallel(routines.size(), [&](size_t i) {
+        overlays[i] = std::make_shared<SymbolTable>(globalScope);
+        CppGenerator task(*this, overlays[i]);
+        routines[i]->accept(task);
+        buffers[i] = task.output_.str();
+        reports[i] = std::move(task.vectorReport_);
+        lineStates[i] = {task.lastDirectiveFile_, task.lastDirectiveLine_, task.lastDirectiveCppLine_};
+    });
+    
+    for (size_t i = 0; i < routines.size(); ++i) {
+        // Carry the task's #line state over, with its C++ line moved to where
+        // the buffer lands, so the glue after the routines maps back to the
+        // C++ file exactly as in serial generation
+        size_t bufferStart = output_.lineCount();
+        emit(buffers[i]);
+        const auto& [directiveFile, directiveLine, directiveCppLine] = lineStates[i];
+        if (!directiveFile.empty()) {
+            lastDirectiveFile_ = directiveFile;
+            lastDirectiveLine_ = directiveLine;
+            lastDirectiveCppLine_ = bufferStart + directiveCppLine;
+        }
+        vectorReport_.insert(vectorReport_.end(), reports[i].begin(), reports[i].end());
+        
+        // Publish the routine's global definitions (its own name, mainly) as
+        // serial generation would, so the main block sees the same symbols
+        for (const auto& [name, symbol] : overlays[i]->getCurrentScope()->getSymbols()) {
+            if (!symbolTable_->lookupLocal(name)) {
+                symbolTable_->define(name, symbol);
+            }
+        }
+    }
+}
+
+bool CppGenerator::isTypedFileVariable(const std::string& name) {
+    if (!symbolTable_) return false;
+    auto symbol = symbolTable_->lookup(name);
+    if (!symbol) return false;
+    
+    // Either declared directly as "file of T" or through a named file type
+    std::string typeName = symbol->getTypeName();
+    if (auto typeSymbol = symbolTable_->lookup(typeName)) {
+        if (typeSymbol->getSymbolType() == SymbolType::TYPE_DEF) {
+            typeName = typeSymbol->getTypeDefinition();
+        }
+    }
+    std::transform(typeName.begin(), typeName.end(), typeName.begin(), 
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return typeName.find("file of") == 0 || typeName.find("pascaltypedfile") != std::string::npos;
+}
+
 bool CppGenerator::isStringExpression(Expression* expr) {
     if (!expr) return false;
     
@@ -1417,18 +2336,88 @@ bool CppGenerator::needsCharToStringConversion(AssignmentStatement& node) {
     return false;
 }
 
-void CppGenerator::emit(const std::string& code) {
-    output_ << code;
+void CppGenerator::emit(std::string_view code) {
+    output_.append(code);
 }
 
-void CppGenerator::emitLine(const std::string& line) {
-    output_ << line << "\n";
+void CppGenerator::emitLine(std::string_view line) {
+    output_.append(line);
+    output_.append('\n');
 }
 
 void CppGenerator::emitIndent() {
-    for (int i = 0; i < indentLevel_; ++i) {
-        output_ << "    ";
+    // Indent table: level n is the first 4*n characters of one run of spaces
+    static constexpr int TABLE_LEVELS = 32;
+    static const std::string indentTable(TABLE_LEVELS * 4, ' ');
+    std::string_view spaces(indentTable);
+    int level = indentLevel_;
+    while (level > TABLE_LEVELS) {
+        output_.append(spaces);
+        level -= TABLE_LEVELS;
+    }
+    output_.append(spaces.substr(0, static_cast<size_t>(level) * 4));
+}
+
+void CppGenerator::emitLineDirective(const ASTNode& node) {
+    if (!lineDirectives_ || sourceFile_.empty()) {
+        return;
+    }
+    // Nodes the parser never positioned keep the default location
+    SourceLocation location = node.getLocation();
+    if (location.position == 0 && location.line <= 1) {
+        return;
+    }
+    if (!output_.atLineStart()) {
+        output_.append('\n');
+    }
+    
+    // Skip the directive if the running line count already lands on this line
+    size_t cppLine = output_.lineCount();
+    if (lastDirectiveFile_ == sourceFile_ &&
+        lastDirectiveLine_ + (cppLine - lastDirectiveCppLine_) == location.line) {
+        return;
     }
+    emitLine("#line " + std::to_string(location.line) + " \"" + escapeCppString(sourceFile_) + "\"");
+    lastDirectiveFile_ = sourceFile_;
+    lastDirectiveLine_ = location.line;
+    lastDirectiveCppLine_ = cppLine + 1;
+}
+
+void CppGenerator::emitRoutineProbes(const std::string& routineName, const ASTNode& node) {
+    if (profiling_) {
+        // The id is assigned on the first call; the scope times the whole body
+        emitIndent();
+        emitLine("static const int pascal_profile_id = pascal_profile::registerRoutine(\"" +
+                 escapeCppString(routineName) + "\", \"" + escapeCppString(sourceFile_) + "\", " +
+                 std::to_string(node.getLocation().line) + ");");
+        emitIndent();
+        emitLine("pascal_profile::Scope pascal_profile_scope(pascal_profile_id);");
+    }
+    if (tracing_) {
+        emitIndent();
+        emitLine("pascal_trace::Scope pascal_trace_scope(\"" + escapeCppString(routineName) + "\");");
+    }
+}
+
+void CppGenerator::emitSampleRoutineName(const std::string& cppName, const std::string& routineName) {
+    // The sampler reports C++ symbols; overloads need their Pascal name back
+    if (!samplerRuntime_ || cppName == routineName) {
+        return;
+    }
+    emitLine("static const bool pascal_sample_name_" + cppName + " = pascal_sample::nameRoutine(\"" +
+             escapeCppString(cppName) + "\", \"" + escapeCppString(routineName) + "\");");
+}
+
+void CppGenerator::emitCppLineDirective() {
+    // Point the following generated glue back at the C++ file itself
+    if (!lineDirectives_ || cppFile_.empty() || lastDirectiveFile_.empty()) {
+        return;
+    }
+    if (!output_.atLineStart()) {
+        output_.append('\n');
+    }
+    emitLine("#line " + std::to_string(output_.lineCount() + 2) + " \"" + escapeCppString(cppFile_) + "\"");
+    lastDirectiveFile_.clear();
 }
 
 void CppGenerator::increaseIndent() {
@@ -1491,6 +2480,7 @@ std::string CppGenerator::generateHeaders() {
            "#include <vector>\n"
            "#include <array>\n"
            "#include <set>\n"
+           "#include <map>\n"
            "#include <algorithm>\n"
            "#include <cstdint>\n"
            "#include <cmath>\n"
@@ -1499,25 +2489,43 @@ std::string CppGenerator::generateHeaders() {
            "#include <memory>\n"
            "#include <type_traits>\n"
            "#include <thread>\n"
+           "#include <mutex>\n"
+           "#include <condition_variable>\n"
+           "#include <atomic>\n"
+           "#include <deque>\n"
+           "#include <functional>\n"
+           "#include <limits>\n"
            "#include <chrono>\n"
            "#include <filesystem>\n"
            "#include <cstring>\n"
-           "#include <cstdlib>\n";
+           "#include <cstdlib>\n"
+           "#include <cstdio>\n"
+           "#include <sstream>\n"
+           "#include <iomanip>\n";
            // Note: Platform-specific includes (windows.h, conio.h) moved to 
            // unit-specific includes to avoid unnecessary Windows API conflicts
 }
 
 std::string CppGenerator::generateRuntimeIncludes() {
-    return "// Using explicit std:: prefixes to avoid name conflicts\n\n"
-           "// Global I/O error tracking\n"
-           "static int g_last_io_error = 0;\n\n"
+    // Guarded and inline so separately compiled unit headers can share it
+    return "#ifndef RPASCAL_RUNTIME_INCLUDED\n"
+           "#define RPASCAL_RUNTIME_INCLUDED\n"
+           "// Using explicit std:: prefixes to avoid name conflicts\n\n"
+           "// var parameters proven not to alias anything else the routine reaches\n"
+           "#if defined(__GNUC__) || defined(__clang__)\n"
+           "#define RPASCAL_RESTRICT __restrict\n"
+           "#else\n"
+           "#define RPASCAL_RESTRICT\n"
+           "#endif\n\n"
+           "// I/O error tracking, one per thread\n"
+           "inline thread_local int g_last_io_error = 0;\n\n"
            "// Pascal string functions\n"
-           "void Delete(std::string& s, int index, int count) {\n"
+           "inline void Delete(std::string& s, int index, int count) {\n"
            "    if (index <= 0 || index > static_cast<int>(s.length())) return;\n"
            "    int startPos = index - 1;  // Convert to 0-based index\n"
            "    s.erase(startPos, count);\n"
            "}\n\n"
-           "void Insert(const std::string& substr, std::string& s, int index) {\n"
+           "inline void Insert(const std::string& substr, std::string& s, int index) {\n"
            "    if (index <= 0) index = 1;\n"
            "    if (index > static_cast<int>(s.length()) + 1) index = s.length() + 1;\n"
            "    int insertPos = index - 1;  // Convert to 0-based index\n"
@@ -1599,8 +2607,8 @@ std::string CppGenerator::generateRuntimeIncludes() {
            "        }\n"
            "    }\n"
            "    \n"
-           "    bool eof() const {\n"
-           "        return stream_.eof();\n"
+           "    bool eof() {\n"
+           "        return !stream_.is_open() || stream_.peek() == std::char_traits<char>::eof();\n"
            "    }\n"
            "    \n"
            "    void write(const T& data) {\n"
@@ -1614,21 +2622,1481 @@ std::string CppGenerator::generateRuntimeIncludes() {
            "    std::fstream& getStream() { return stream_; }\n"
            "    const std::string& getFilename() const { return filename_; }\n"
            "};\n\n"
+           "// Byte and small subranges are stored as (un)signed char but read and\n"
+           "// written as numbers, like any other integer\n"
+           "inline std::ostream& operator<<(std::ostream& out, uint8_t value) { return out << static_cast<int>(value); }\n"
+           "inline std::ostream& operator<<(std::ostream& out, int8_t value) { return out << static_cast<int>(value); }\n"
+           "inline std::istream& operator>>(std::istream& in, uint8_t& value) {\n"
+           "    int number = 0;\n"
+           "    if (in >> number) value = static_cast<uint8_t>(number);\n"
+           "    return in;\n"
+           "}\n"
+           "inline std::istream& operator>>(std::istream& in, int8_t& value) {\n"
+           "    int number = 0;\n"
+           "    if (in >> number) value = static_cast<int8_t>(number);\n"
+           "    return in;\n"
+           "}\n\n"
+           "// Comp: a 64-bit integer that takes part in arithmetic as an extended\n"
+           "// real; real values stored in it are rounded to the nearest integer\n"
+           "struct PascalComp {\n"
+           "    int64_t value = 0;\n"
+           "    PascalComp() = default;\n"
+           "    template<typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>\n"
+           "    PascalComp(T number) {\n"
+           "        if constexpr (std::is_floating_point<T>::value) value = static_cast<int64_t>(std::llrint(number));\n"
+           "        else value = static_cast<int64_t>(number);\n"
+           "    }\n"
+           "    operator long double() const { return static_cast<long double>(value); }\n"
+           "    PascalComp& operator+=(long double number) { return *this = *this + number; }\n"
+           "    PascalComp& operator-=(long double number) { return *this = *this - number; }\n"
+           "    PascalComp& operator*=(long double number) { return *this = *this * number; }\n"
+           "    PascalComp& operator/=(long double number) { return *this = *this / number; }\n"
+           "    PascalComp& operator++() { ++value; return *this; }\n"
+           "    PascalComp& operator--() { --value; return *this; }\n"
+           "    PascalComp operator++(int) { PascalComp old = *this; ++value; return old; }\n"
+           "    PascalComp operator--(int) { PascalComp old = *this; --value; return old; }\n"
+           "};\n"
+           "// Operand of '/': integers become double, reals and Comp keep their width\n"
+           "template<typename T>\n"
+           "constexpr auto pascal_real(T value) {\n"
+           "    if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) return static_cast<double>(value);\n"
+           "    else return value;\n"
+           "}\n"
+           "inline std::istream& operator>>(std::istream& in, PascalComp& number) {\n"
+           "    long double read = 0;\n"
+           "    if (in >> read) number = read;\n"
+           "    return in;\n"
+           "}\n\n"
+           "// Write(value:width[:precision]) field, streamed straight into the output.\n"
+           "// It is right-aligned in width characters; real types are written in\n"
+           "// fixed notation with precision decimals, or without a precision in\n"
+           "// Turbo Pascal's scientific form using as many decimals as width allows\n"
+           "template<typename T>\n"
+           "struct PascalFormat {\n"
+           "    const T& value;\n"
+           "    int width;\n"
+           "    int precision;\n"
+           "    operator std::string() const;   // Str(value:width:precision, s)\n"
+           "};\n"
+           "template<typename T>\n"
+           "PascalFormat<T> pascal_format(const T& value, int width, int precision = -1) { return {value, width, precision}; }\n"
+           "template<typename T>\n"
+           "std::ostream& operator<<(std::ostream& out, const PascalFormat<T>& field) {\n"
+           "    if constexpr (std::is_floating_point<T>::value || std::is_same<T, PascalComp>::value) {\n"
+           "        using Number = std::conditional_t<std::is_same<T, PascalComp>::value, long double, T>;\n"
+           "        bool fixed = field.precision >= 0;\n"
+           "        int decimals = fixed ? field.precision\n"
+           "                             : std::min(std::max(1, field.width - 7), std::numeric_limits<Number>::max_digits10 - 1);\n"
+           "        char buffer[64];\n"
+           "        int length = std::is_same<Number, long double>::value\n"
+           "            ? std::snprintf(buffer, sizeof(buffer), fixed ? \"%*.*Lf\" : \"%*.*LE\", field.width, decimals,\n"
+           "                            static_cast<long double>(field.value))\n"
+           "            : std::snprintf(buffer, sizeof(buffer), fixed ? \"%*.*f\" : \"%*.*E\", field.width, decimals,\n"
+           "                            static_cast<double>(field.value));\n"
+           "        if (length >= 0 && length < static_cast<int>(sizeof(buffer))) {\n"
+           "            out.write(buffer, length);\n"
+           "        } else {\n"
+           "            // Too long for the buffer (huge fixed values or widths): let the stream do it\n"
+           "            std::ios_base::fmtflags flags = out.flags();\n"
+           "            std::streamsize precision = out.precision();\n"
+           "            out << (fixed ? std::fixed : std::scientific) << std::uppercase << std::setprecision(decimals)\n"
+           "                << std::setw(field.width) << static_cast<Number>(field.value);\n"
+           "            out.flags(flags);\n"
+           "            out.precision(precision);\n"
+           "        }\n"
+           "    } else {\n"
+           "        out << std::setw(field.width) << field.value;\n"
+           "    }\n"
+           "    return out;\n"
+           "}\n"
+           "// Comp is written like a real, as Write(c:20) would\n"
+           "inline std::ostream& operator<<(std::ostream& out, PascalComp number) { return out << pascal_format(number, 20); }\n"
+           "template<typename T>\n"
+           "PascalFormat<T>::operator std::string() const {\n"
+           "    std::ostringstream text;\n"
+           "    text << *this;\n"
+           "    return text.str();\n"
+           "}\n\n"
+           "// Packed array of Boolean or a small subrange, Bits (1, 2 or 4) per\n"
+           "// element; elements never straddle a byte\n"
+           "template<typename T, size_t N, unsigned Bits>\n"
+           "class PascalPackedArray {\n"
+           "    static constexpr unsigned PER_BYTE = 8 / Bits;\n"
+           "    static constexpr unsigned MASK = (1u << Bits) - 1;\n"
+           "    std::array<uint8_t, (N + PER_BYTE - 1) / PER_BYTE> bytes_{};\n"
+           "    \n"
+           "public:\n"
+           "    class reference {\n"
+           "        uint8_t& byte_;\n"
+           "        unsigned shift_;\n"
+           "    public:\n"
+           "        reference(uint8_t& byte, unsigned shift) : byte_(byte), shift_(shift) {}\n"
+           "        operator T() const { return static_cast<T>((byte_ >> shift_) & MASK); }\n"
+           "        reference& operator=(T value) {\n"
+           "            byte_ = static_cast<uint8_t>((byte_ & ~(MASK << shift_)) | ((static_cast<unsigned>(value) & MASK) << shift_));\n"
+           "            return *this;\n"
+           "        }\n"
+           "        reference& operator=(const reference& other) { return *this = static_cast<T>(other); }\n"
+           "        // Inc and Dec on an element read, modify and write it back\n"
+           "        reference& operator+=(long long delta) { return *this = static_cast<T>(static_cast<T>(*this) + delta); }\n"
+           "        reference& operator-=(long long delta) { return *this = static_cast<T>(static_cast<T>(*this) - delta); }\n"
+           "        reference& operator++() { return *this += 1; }\n"
+           "        reference& operator--() { return *this -= 1; }\n"
+           "        T operator++(int) { T old = *this; *this += 1; return old; }\n"
+           "        T operator--(int) { T old = *this; *this -= 1; return old; }\n"
+           "    };\n"
+           "    \n"
+           "    reference operator[](size_t i) { return reference(bytes_[i / PER_BYTE], static_cast<unsigned>(i % PER_BYTE) * Bits); }\n"
+           "    T operator[](size_t i) const { return static_cast<T>((bytes_[i / PER_BYTE] >> (i % PER_BYTE * Bits)) & MASK); }\n"
+           "    static constexpr size_t size() { return N; }\n"
+           "    bool operator==(const PascalPackedArray& other) const { return bytes_ == other.bytes_; }\n"
+           "    bool operator!=(const PascalPackedArray& other) const { return bytes_ != other.bytes_; }\n"
+           "};\n\n"
+           "// Local variables above the stack threshold live here instead: a per-thread\n"
+           "// arena handing out blocks in LIFO order, so each one is released when its\n"
+           "// routine returns. Chunks are kept for the next call\n"
+           "namespace pascal_frame {\n"
+           "\n"
+           "constexpr size_t CHUNK_SIZE = 16 * 1024 * 1024;\n"
+           "\n"
+           "struct Chunk {\n"
+           "    std::unique_ptr<unsigned char[]> data;\n"
+           "    size_t size;\n"
+           "};\n"
+           "\n"
+           "struct Arena {\n"
+           "    std::vector<Chunk> chunks;\n"
+           "    size_t chunk = 0;   // chunk being filled\n"
+           "    size_t used = 0;    // bytes in use in that chunk\n"
+           "};\n"
+           "inline Arena& arena() { thread_local Arena a; return a; }\n"
+           "\n"
+           "inline void* allocate(Arena& a, size_t bytes, size_t align) {\n"
+           "    for (; a.chunk < a.chunks.size(); ++a.chunk, a.used = 0) {\n"
+           "        Chunk& c = a.chunks[a.chunk];\n"
+           "        uintptr_t base = reinterpret_cast<uintptr_t>(c.data.get());\n"
+           "        size_t offset = ((base + a.used + align - 1) & ~static_cast<uintptr_t>(align - 1)) - base;\n"
+           "        if (offset + bytes <= c.size) {\n"
+           "            a.used = offset + bytes;\n"
+           "            return c.data.get() + offset;\n"
+           "        }\n"
+           "    }\n"
+           "    size_t size = std::max(bytes + align, CHUNK_SIZE);\n"
+           "    a.chunks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});\n"
+           "    a.chunk = a.chunks.size() - 1;\n"
+           "    a.used = 0;\n"
+           "    return allocate(a, bytes, align);\n"
+           "}\n"
+           "\n"
+           "// A local variable of type T; default-initialised like one on the stack.\n"
+           "// Align can raise the alignment, e.g. for vectorised numeric arrays\n"
+           "template<typename T, size_t Align = alignof(T)>\n"
+           "class Local {\n"
+           "public:\n"
+           "    Local() : chunk_(arena().chunk), used_(arena().used) {\n"
+           "        value_ = new (allocate(arena(), sizeof(T), Align)) T;\n"
+           "    }\n"
+           "    ~Local() {\n"
+           "        value_->~T();\n"
+           "        Arena& a = arena();\n"
+           "        a.chunk = chunk_;\n"
+           "        a.used = used_;\n"
+           "    }\n"
+           "    Local(const Local&) = delete;\n"
+           "    Local& operator=(const Local&) = delete;\n"
+           "    T& operator*() { return *value_; }\n"
+           "\n"
+           "private:\n"
+           "    size_t chunk_;\n"
+           "    size_t used_;\n"
+           "    T* value_;\n"
+           "};\n"
+           "\n"
+           "} // namespace pascal_frame\n\n"
+           "// Thread pool behind parallel for loops. Each loop is cut into chunks that\n"
+           "// are dealt to per-thread deques; a thread works through its own deque from\n"
+           "// the front and steals from the back of the others once it runs dry.\n"
+           "// RPASCAL_THREADS sets the thread count (default: hardware threads)\n"
+           "namespace pascal_parallel {\n"
+           "\n"
+           "struct Chunk { long long low, high; };\n"
+           "\n"
+           "struct Queue {\n"
+           "    std::mutex mutex;\n"
+           "    std::deque<Chunk> chunks;\n"
+           "};\n"
+           "\n"
+           "struct Loop {\n"
+           "    std::function<void(long long, long long)> body;\n"
+           "    std::vector<Queue> queues;\n"
+           "    std::atomic<size_t> pending{0};      // chunks not yet finished\n"
+           "    std::mutex errorMutex;\n"
+           "    std::exception_ptr error;\n"
+           "    explicit Loop(size_t threads) : queues(threads) {}\n"
+           "};\n"
+           "\n"
+           "class Pool {\n"
+           "public:\n"
+           "    explicit Pool(size_t threads) : threads_(threads) {\n"
+           "        // Workers are never joined: the pool lives until the process exits\n"
+           "        for (size_t id = 1; id < threads_; ++id) {\n"
+           "            std::thread([this, id] { workerMain(id); }).detach();\n"
+           "        }\n"
+           "    }\n"
+           "\n"
+           "    size_t threads() const { return threads_; }\n"
+           "\n"
+           "    void run(long long low, long long high, const std::function<void(long long, long long)>& body) {\n"
+           "        std::lock_guard<std::mutex> running(runMutex_);   // one parallel loop at a time\n"
+           "        auto loop = std::make_shared<Loop>(threads_);\n"
+           "        loop->body = body;\n"
+           "        long long count = high - low + 1;\n"
+           "        long long chunkSize = std::max(1LL, count / static_cast<long long>(threads_ * CHUNKS_PER_THREAD));\n"
+           "        size_t chunks = 0;\n"
+           "        for (long long start = low; start <= high; start += chunkSize, ++chunks) {\n"
+           "            loop->queues[chunks % threads_].chunks.push_back({start, std::min(high, start + chunkSize - 1)});\n"
+           "        }\n"
+           "        loop->pending = chunks;\n"
+           "        {\n"
+           "            std::lock_guard<std::mutex> lock(mutex_);\n"
+           "            loop_ = loop;\n"
+           "            ++generation_;\n"
+           "        }\n"
+           "        wake_.notify_all();\n"
+           "        work(*loop, 0);\n"
+           "        while (loop->pending.load(std::memory_order_acquire) > 0) {\n"
+           "            std::this_thread::yield();\n"
+           "        }\n"
+           "        {\n"
+           "            std::lock_guard<std::mutex> lock(mutex_);\n"
+           "            loop_.reset();\n"
+           "        }\n"
+           "        if (loop->error) std::rethrow_exception(loop->error);\n"
+           "    }\n"
+           "\n"
+           "private:\n"
+           "    static constexpr size_t CHUNKS_PER_THREAD = 8;\n"
+           "    size_t threads_;\n"
+           "    std::mutex runMutex_;\n"
+           "    std::mutex mutex_;\n"
+           "    std::condition_variable wake_;\n"
+           "    std::shared_ptr<Loop> loop_;\n"
+           "    uint64_t generation_ = 0;\n"
+           "\n"
+           "    static bool take(Queue& queue, bool fromFront, Chunk& chunk) {\n"
+           "        std::lock_guard<std::mutex> lock(queue.mutex);\n"
+           "        if (queue.chunks.empty()) return false;\n"
+           "        if (fromFront) {\n"
+           "            chunk = queue.chunks.front();\n"
+           "            queue.chunks.pop_front();\n"
+           "        } else {\n"
+           "            chunk = queue.chunks.back();\n"
+           "            queue.chunks.pop_back();\n"
+           "        }\n"
+           "        return true;\n"
+           "    }\n"
+           "\n"
+           "    void work(Loop& loop, size_t id);\n"
+           "\n"
+           "    void workerMain(size_t id) {\n"
+           "        uint64_t seen = 0;\n"
+           "        while (true) {\n"
+           "            std::shared_ptr<Loop> loop;\n"
+           "            {\n"
+           "                std::unique_lock<std::mutex> lock(mutex_);\n"
+           "                wake_.wait(lock, [&] { return generation_ != seen; });\n"
+           "                seen = generation_;\n"
+           "                loop = loop_;\n"
+           "            }\n"
+           "            if (loop) work(*loop, id);\n"
+           "        }\n"
+           "    }\n"
+           "};\n"
+           "\n"
+           "// Set on pool threads and while the caller runs its share of a loop: a\n"
+           "// parallel for nested inside another one runs serially on that thread\n"
+           "inline thread_local bool insideLoop = false;\n"
+           "\n"
+           "inline void Pool::work(Loop& loop, size_t id) {\n"
+           "    insideLoop = true;\n"
+           "    Chunk chunk;\n"
+           "    while (true) {\n"
+           "        bool found = take(loop.queues[id], true, chunk);\n"
+           "        for (size_t other = 1; !found && other < threads_; ++other) {\n"
+           "            found = take(loop.queues[(id + other) % threads_], false, chunk);\n"
+           "        }\n"
+           "        if (!found) break;\n"
+           "        try {\n"
+           "            loop.body(chunk.low, chunk.high);\n"
+           "        } catch (...) {\n"
+           "            std::lock_guard<std::mutex> lock(loop.errorMutex);\n"
+           "            if (!loop.error) loop.error = std::current_exception();\n"
+           "        }\n"
+           "        loop.pending.fetch_sub(1, std::memory_order_release);\n"
+           "    }\n"
+           "    insideLoop = id != 0;\n"
+           "}\n"
+           "\n"
+           "inline size_t threadCount() {\n"
+           "    static const size_t count = [] {\n"
+           "        const char* text = std::getenv(\"RPASCAL_THREADS\");\n"
+           "        long requested = text ? std::atol(text) : 0;\n"
+           "        if (requested > 0) return static_cast<size_t>(requested);\n"
+           "        unsigned hardware = std::thread::hardware_concurrency();\n"
+           "        return hardware > 0 ? static_cast<size_t>(hardware) : static_cast<size_t>(1);\n"
+           "    }();\n"
+           "    return count;\n"
+           "}\n"
+           "\n"
+           "inline Pool& pool() { static Pool* p = new Pool(threadCount()); return *p; }\n"
+           "\n"
+           "// Runs body(low, high) over chunks of [first, last]\n"
+           "template<typename Body>\n"
+           "void forRange(long long first, long long last, Body&& body) {\n"
+           "    if (first > last) return;\n"
+           "    if (insideLoop || threadCount() == 1) {\n"
+           "        body(first, last);\n"
+           "        return;\n"
+           "    }\n"
+           "    pool().run(first, last, std::forward<Body>(body));\n"
+           "}\n"
+           "\n"
+           "// Starting value of each chunk's private copy of a reduction variable;\n"
+           "// op is '+', '*', '<' (min) or '>' (max)\n"
+           "template<typename T> T identity(char op) {\n"
+           "    switch (op) {\n"
+           "        case '*': return static_cast<T>(1);\n"
+           "        case '<': return std::numeric_limits<T>::max();\n"
+           "        case '>': return std::numeric_limits<T>::lowest();\n"
+           "        default: return static_cast<T>(0);\n"
+           "    }\n"
+           "}\n"
+           "\n"
+           "} // namespace pascal_parallel\n\n"
+           "// Threads unit. BeginThread returns a small integer handle; the std::thread\n"
+           "// behind it is kept here until WaitForThread joins it\n"
+           "namespace pascal_threads {\n"
+           "\n"
+           "struct Registry {\n"
+           "    std::mutex mutex;\n"
+           "    std::map<int, std::thread> threads;\n"
+           "    int nextId = 1;\n"
+           "};\n"
+           "\n"
+           "inline Registry& registry() {\n"
+           "    // Never destroyed, so threads still running at exit do not terminate the program\n"
+           "    static Registry* r = new Registry();\n"
+           "    return *r;\n"
+           "}\n"
+           "\n"
+           "template<typename Body> int beginThread(Body&& body) {\n"
+           "    Registry& r = registry();\n"
+           "    std::lock_guard<std::mutex> lock(r.mutex);\n"
+           "    int id = r.nextId++;\n"
+           "    r.threads.emplace(id, std::thread(std::forward<Body>(body)));\n"
+           "    return id;\n"
+           "}\n"
+           "\n"
+           "inline int waitForThread(int id) {\n"
+           "    std::thread thread;\n"
+           "    {\n"
+           "        Registry& r = registry();\n"
+           "        std::lock_guard<std::mutex> lock(r.mutex);\n"
+           "        auto it = r.threads.find(id);\n"
+           "        if (it == r.threads.end()) return -1;\n"
+           "        thread = std::move(it->second);\n"
+           "        r.threads.erase(it);\n"
+           "    }\n"
+           "    if (thread.joinable()) thread.join();\n"
+           "    return 0;\n"
+           "}\n"
+           "\n"
+           "// Critical sections are re-entrant, as in Turbo/Free Pascal\n"
+           "struct CriticalSection {\n"
+           "    std::recursive_mutex mutex;\n"
+           "};\n"
+           "\n"
+           "// Interlocked operations work on plain integer and pointer variables\n"
+           "template<typename T> std::atomic<T>& atomicRef(T& value) {\n"
+           "    static_assert(sizeof(std::atomic<T>) == sizeof(T) && std::atomic<T>::is_always_lock_free,\n"
+           "                  \"interlocked operations need a lock-free type\");\n"
+           "    return *reinterpret_cast<std::atomic<T>*>(&value);\n"
+           "}\n"
+           "\n"
+           "template<typename T> T increment(T& target) { return ++atomicRef(target); }\n"
+           "template<typename T> T decrement(T& target) { return --atomicRef(target); }\n"
+           "\n"
+           "template<typename T, typename V> T exchangeAdd(T& target, V value) {\n"
+           "    return atomicRef(target).fetch_add(static_cast<T>(value));\n"
+           "}\n"
+           "\n"
+           "template<typename T, typename V> T exchange(T& target, V value) {\n"
+           "    return atomicRef(target).exchange(static_cast<T>(value));\n"
+           "}\n"
+           "\n"
+           "// Stores newValue if target equals comparand; returns target's previous value\n"
+           "template<typename T, typename V, typename C> T compareExchange(T& target, V newValue, C comparand) {\n"
+           "    T expected = static_cast<T>(comparand);\n"
+           "    atomicRef(target).compare_exchange_strong(expected, static_cast<T>(newValue));\n"
+           "    return expected;\n"
+           "}\n"
+           "\n"
+           "} // namespace pascal_threads\n\n"
            "// I/O error checking function\n"
-           "int pascal_ioresult() {\n"
+           "inline int pascal_ioresult() {\n"
            "    int result = g_last_io_error;\n"
            "    g_last_io_error = 0; // Clear error after reading (Pascal behavior)\n"
            "    return result;\n"
            "}\n\n"
            "// Clear screen function\n"
-           "int pascal_clrscr() {\n"
+           "inline int pascal_clrscr() {\n"
            "#ifdef _WIN32\n"
            "    system(\"cls\");\n"
            "#else\n"
            "    system(\"clear\");\n"
            "#endif\n"
            "    return 0;\n"
-           "}";
+           "}\n"
+           "#endif // RPASCAL_RUNTIME_INCLUDED";
+}
+
+std::string CppGenerator::generateClockRuntime() {
+    // Timestamp counter shared by --profile and --trace
+    return "#ifndef RPASCAL_CLOCK_INCLUDED\n"
+           "#define RPASCAL_CLOCK_INCLUDED\n"
+           "// Timestamp source shared by the profiler and the tracer\n"
+           "#if defined(_MSC_VER)\n"
+           "#include <intrin.h>\n"
+           "#elif defined(__x86_64__) || defined(__i386__)\n"
+           "#include <x86intrin.h>\n"
+           "#endif\n"
+           "\n"
+           "namespace pascal_clock {\n"
+           "\n"
+           "// Raw timestamp: the TSC where available, else the steady clock\n"
+           "inline uint64_t ticks() {\n"
+           "#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)\n"
+           "    return __rdtsc();\n"
+           "#else\n"
+           "    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());\n"
+           "#endif\n"
+           "}\n"
+           "\n"
+           "// First reading of both clocks; the tick rate is measured against it\n"
+           "struct Origin { uint64_t ticks; std::chrono::steady_clock::time_point time; };\n"
+           "inline const Origin& origin() {\n"
+           "    static const Origin o{ticks(), std::chrono::steady_clock::now()};\n"
+           "    return o;\n"
+           "}\n"
+           "\n"
+           "inline double ticksPerSecond() {\n"
+           "    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - origin().time).count();\n"
+           "    return seconds > 0.0 ? static_cast<double>(ticks() - origin().ticks) / seconds : 1e9;\n"
+           "}\n"
+           "\n"
+           "} // namespace pascal_clock\n"
+           "#endif // RPASCAL_CLOCK_INCLUDED";
+}
+
+std::string CppGenerator::generateProfilerRuntime() {
+    // Emitted only with --profile: a Scope in every routine records calls and
+    // time per thread; the report is written when the program exits
+    return "#ifndef RPASCAL_PROFILER_INCLUDED\n"
+           "#define RPASCAL_PROFILER_INCLUDED\n"
+           "// Instrumented profiler (--profile): every routine opens a Scope on entry\n"
+           "#include <cstdio>\n"
+           "#include <mutex>\n"
+           "#ifdef _WIN32\n"
+           "#include <process.h>\n"
+           "#else\n"
+           "#include <unistd.h>\n"
+           "#endif\n"
+           "\n"
+           "namespace pascal_profile {\n"
+           "\n"
+           "using pascal_clock::ticks;\n"
+           "\n"
+           "struct Routine { std::string name; std::string file; int line; };\n"
+           "// Call graph edges are kept on the callee; most routines have few callers\n"
+           "struct Edge { int caller; uint64_t calls; uint64_t inclusiveTicks; };\n"
+           "struct Stats {\n"
+           "    uint64_t calls = 0;\n"
+           "    uint64_t selfTicks = 0;\n"
+           "    uint64_t inclusiveTicks = 0;\n"
+           "    uint32_t active = 0;\n"
+           "    std::vector<Edge> callers;\n"
+           "    Edge& edgeFrom(int caller) {\n"
+           "        for (auto& edge : callers) if (edge.caller == caller) return edge;\n"
+           "        callers.push_back({caller, 0, 0});\n"
+           "        return callers.back();\n"
+           "    }\n"
+           "};\n"
+           "struct Frame { int id; uint64_t start; uint64_t childTicks; };\n"
+           "\n"
+           "inline void merge(std::vector<Stats>& stats, const std::vector<Stats>& from) {\n"
+           "    if (stats.size() < from.size()) stats.resize(from.size());\n"
+           "    for (size_t i = 0; i < from.size(); ++i) {\n"
+           "        stats[i].calls += from[i].calls;\n"
+           "        stats[i].selfTicks += from[i].selfTicks;\n"
+           "        stats[i].inclusiveTicks += from[i].inclusiveTicks;\n"
+           "        for (const auto& edge : from[i].callers) {\n"
+           "            Edge& to = stats[i].edgeFrom(edge.caller);\n"
+           "            to.calls += edge.calls;\n"
+           "            to.inclusiveTicks += edge.inclusiveTicks;\n"
+           "        }\n"
+           "    }\n"
+           "}\n"
+           "\n"
+           "// Shared state; never destroyed so threads that outlive main can still merge\n"
+           "struct Global {\n"
+           "    std::mutex mutex;\n"
+           "    std::vector<Routine> routines{{\"<main program>\", \"\", 0}};\n"
+           "    std::vector<Stats> stats;\n"
+           "};\n"
+           "inline Global& global() { static Global* g = new Global(); return *g; }\n"
+           "\n"
+           "// Per-thread counters, folded into the global ones when the thread ends\n"
+           "struct ThreadData {\n"
+           "    std::vector<Stats> stats;\n"
+           "    std::vector<Frame> stack;\n"
+           "    void flush() {\n"
+           "        Global& g = global();\n"
+           "        std::lock_guard<std::mutex> lock(g.mutex);\n"
+           "        merge(g.stats, stats);\n"
+           "        // Keep the active counts of frames that are still open\n"
+           "        for (auto& s : stats) s = Stats{0, 0, 0, s.active, {}};\n"
+           "    }\n"
+           "};\n"
+           "// Flushes a thread's counters when it ends. The main thread still has its\n"
+           "// program frame open at that point, so its data stays for report()\n"
+           "struct ThreadFlush {\n"
+           "    ThreadData** slot;\n"
+           "    ~ThreadFlush() {\n"
+           "        (*slot)->flush();\n"
+           "        if ((*slot)->stack.empty()) {\n"
+           "            delete *slot;\n"
+           "            *slot = nullptr;\n"
+           "        }\n"
+           "    }\n"
+           "};\n"
+           "inline ThreadData& threadData() {\n"
+           "    thread_local ThreadData* data = new ThreadData();\n"
+           "    thread_local ThreadFlush flush{&data};\n"
+           "    return *data;\n"
+           "}\n"
+           "\n"
+           "inline int registerRoutine(const char* name, const char* file, int line) {\n"
+           "    Global& g = global();\n"
+           "    std::lock_guard<std::mutex> lock(g.mutex);\n"
+           "    g.routines.push_back({name, file, line});\n"
+           "    return static_cast<int>(g.routines.size() - 1);\n"
+           "}\n"
+           "\n"
+           "inline void enter(int id) {\n"
+           "    ThreadData& t = threadData();\n"
+           "    if (static_cast<size_t>(id) >= t.stats.size()) t.stats.resize(id + 1);\n"
+           "    ++t.stats[id].active;\n"
+           "    t.stack.push_back({id, ticks(), 0});\n"
+           "}\n"
+           "\n"
+           "inline void leave() {\n"
+           "    uint64_t now = ticks();\n"
+           "    ThreadData& t = threadData();\n"
+           "    Frame frame = t.stack.back();\n"
+           "    t.stack.pop_back();\n"
+           "    uint64_t elapsed = now - frame.start;\n"
+           "    Stats& s = t.stats[frame.id];\n"
+           "    ++s.calls;\n"
+           "    s.selfTicks += elapsed > frame.childTicks ? elapsed - frame.childTicks : 0;\n"
+           "    // Recursive activations are already inside the outermost one's time\n"
+           "    bool outermost = --s.active == 0;\n"
+           "    if (outermost) s.inclusiveTicks += elapsed;\n"
+           "    if (!t.stack.empty()) {\n"
+           "        Frame& caller = t.stack.back();\n"
+           "        caller.childTicks += elapsed;\n"
+           "        Edge& edge = s.edgeFrom(caller.id);\n"
+           "        ++edge.calls;\n"
+           "        if (outermost) edge.inclusiveTicks += elapsed;\n"
+           "    }\n"
+           "}\n"
+           "\n"
+           "struct Scope {\n"
+           "    explicit Scope(int id) { enter(id); }\n"
+           "    ~Scope() { leave(); }\n"
+           "    Scope(const Scope&) = delete;\n"
+           "    Scope& operator=(const Scope&) = delete;\n"
+           "};\n"
+           "\n"
+           "inline std::string label(const Routine& r) {\n"
+           "    return r.file.empty() ? r.name : r.name + \" (\" + std::filesystem::path(r.file).filename().string() + \":\" + std::to_string(r.line) + \")\";\n"
+           "}\n"
+           "\n"
+           "inline void report() {\n"
+           "    // Close whatever halt() left open, including the main program frame\n"
+           "    ThreadData& t = threadData();\n"
+           "    while (!t.stack.empty()) leave();\n"
+           "    t.flush();\n"
+           "\n"
+           "    Global& g = global();\n"
+           "    std::lock_guard<std::mutex> lock(g.mutex);\n"
+           "    double ticksPerMs = pascal_clock::ticksPerSecond() / 1000.0;\n"
+           "    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - pascal_clock::origin().time).count();\n"
+           "    g.stats.resize(g.routines.size());\n"
+           "    auto ms = [&](uint64_t value) { return static_cast<double>(value) / ticksPerMs; };\n"
+           "\n"
+           "    std::vector<size_t> order;\n"
+           "    for (size_t i = 0; i < g.stats.size(); ++i) if (g.stats[i].calls > 0) order.push_back(i);\n"
+           "    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return g.stats[a].selfTicks > g.stats[b].selfTicks; });\n"
+           "    uint64_t totalSelf = 0;\n"
+           "    for (const auto& s : g.stats) totalSelf += s.selfTicks;\n"
+           "\n"
+           "    const char* base = std::getenv(\"RPASCAL_PROFILE_OUT\");\n"
+           "    std::string textPath = std::string(base && *base ? base : \"rpascal\") + \".profile.txt\";\n"
+           "    std::string grindPath = std::string(base && *base ? base : \"callgrind\") + \".out.\" + std::to_string(\n"
+           "#ifdef _WIN32\n"
+           "        static_cast<long>(_getpid())\n"
+           "#else\n"
+           "        static_cast<long>(getpid())\n"
+           "#endif\n"
+           "        );\n"
+           "    FILE* text = std::fopen(textPath.c_str(), \"w\");\n"
+           "    if (text) {\n"
+           "        std::fprintf(text, \"Flat profile: %s, %.3f ms total\\n\\n\", g.routines[0].name.c_str(), seconds * 1000.0);\n"
+           "        std::fprintf(text, \" %%time      self ms      incl ms        calls  self us/call  routine\\n\");\n"
+           "        for (size_t i : order) {\n"
+           "            const Stats& s = g.stats[i];\n"
+           "            std::fprintf(text, \"%6.2f %12.3f %12.3f %12llu %13.3f  %s\\n\",\n"
+           "                         totalSelf ? 100.0 * static_cast<double>(s.selfTicks) / static_cast<double>(totalSelf) : 0.0,\n"
+           "                         ms(s.selfTicks), ms(s.inclusiveTicks), static_cast<unsigned long long>(s.calls),\n"
+           "                         ms(s.selfTicks) * 1000.0 / static_cast<double>(s.calls), label(g.routines[i]).c_str());\n"
+           "        }\n"
+           "        std::fprintf(text, \"\\nCall graph (calls, inclusive ms)\\n\");\n"
+           "        for (size_t i : order) {\n"
+           "            std::fprintf(text, \"\\n%s\\n\", label(g.routines[i]).c_str());\n"
+           "            for (const auto& edge : g.stats[i].callers) {\n"
+           "                std::fprintf(text, \"    called by %-40s %10llu %12.3f\\n\", label(g.routines[edge.caller]).c_str(),\n"
+           "                             static_cast<unsigned long long>(edge.calls), ms(edge.inclusiveTicks));\n"
+           "            }\n"
+           "            for (size_t callee : order) {\n"
+           "                for (const auto& edge : g.stats[callee].callers) {\n"
+           "                    if (static_cast<size_t>(edge.caller) != i) continue;\n"
+           "                    std::fprintf(text, \"    calls     %-40s %10llu %12.3f\\n\", label(g.routines[callee]).c_str(),\n"
+           "                                 static_cast<unsigned long long>(edge.calls), ms(edge.inclusiveTicks));\n"
+           "                }\n"
+           "            }\n"
+           "        }\n"
+           "        std::fclose(text);\n"
+           "    }\n"
+           "\n"
+           "    // Callgrind format (kcachegrind, callgrind_annotate); costs in nanoseconds\n"
+           "    FILE* grind = std::fopen(grindPath.c_str(), \"w\");\n"
+           "    if (grind) {\n"
+           "        std::fprintf(grind, \"# callgrind format\\nversion: 1\\ncreator: rpascal\\ncmd: %s\\npositions: line\\nevents: ns\\nsummary: %llu\\n\",\n"
+           "                     g.routines[0].name.c_str(), static_cast<unsigned long long>(ms(totalSelf) * 1e6));\n"
+           "        for (size_t i : order) {\n"
+           "            const Routine& r = g.routines[i];\n"
+           "            std::fprintf(grind, \"\\nfl=%s\\nfn=%s\\n%d %llu\\n\", r.file.c_str(), r.name.c_str(), r.line,\n"
+           "                         static_cast<unsigned long long>(ms(g.stats[i].selfTicks) * 1e6));\n"
+           "            for (size_t callee : order) {\n"
+           "                for (const auto& edge : g.stats[callee].callers) {\n"
+           "                    if (static_cast<size_t>(edge.caller) != i) continue;\n"
+           "                    const Routine& c = g.routines[callee];\n"
+           "                    std::fprintf(grind, \"cfl=%s\\ncfn=%s\\ncalls=%llu %d\\n%d %llu\\n\", c.file.c_str(), c.name.c_str(),\n"
+           "                                 static_cast<unsigned long long>(edge.calls), c.line, r.line,\n"
+           "                                 static_cast<unsigned long long>(ms(edge.inclusiveTicks) * 1e6));\n"
+           "                }\n"
+           "            }\n"
+           "        }\n"
+           "        std::fclose(grind);\n"
+           "    }\n"
+           "    std::fprintf(stderr, \"Profile written to %s and %s\\n\", textPath.c_str(), grindPath.c_str());\n"
+           "}\n"
+           "\n"
+           "// Called first thing in main(); the main program body is routine 0\n"
+           "inline void start(const char* program, const char* file) {\n"
+           "    Global& g = global();\n"
+           "    g.routines[0] = {program, file, 1};\n"
+           "    pascal_clock::origin();\n"
+           "    enter(0);\n"
+           "    std::atexit(report);\n"
+           "}\n"
+           "\n"
+           "} // namespace pascal_profile\n"
+           "#endif // RPASCAL_PROFILER_INCLUDED";
+}
+
+std::string CppGenerator::generateTraceRuntime() {
+    // Emitted only with --trace: routine spans, file operations and large
+    // allocations go to per-thread ring buffers written out at exit
+    return "#ifndef RPASCAL_TRACE_INCLUDED\n"
+           "#define RPASCAL_TRACE_INCLUDED\n"
+           "// Event tracer (--trace): each thread appends fixed-size records to its own\n"
+           "// ring buffer without locking; the rings are written as Chrome trace JSON\n"
+           "#include <atomic>\n"
+           "#include <cstdio>\n"
+           "#include <mutex>\n"
+           "#ifdef _WIN32\n"
+           "#include <process.h>\n"
+           "#else\n"
+           "#include <unistd.h>\n"
+           "#endif\n"
+           "\n"
+           "namespace pascal_trace {\n"
+           "\n"
+           "// New/GetMem of at least this many bytes are recorded\n"
+           "constexpr size_t LARGE_ALLOCATION = 64 * 1024;\n"
+           "// Events kept per thread; once full the oldest are overwritten\n"
+           "constexpr size_t RING_SIZE = 32 * 1024;\n"
+           "\n"
+           "struct Event {\n"
+           "    uint64_t start;\n"
+           "    uint64_t duration;    // ticks; 0 marks an instant event\n"
+           "    const char* name;\n"
+           "    const char* category;\n"
+           "    uint64_t bytes;\n"
+           "    char file[24];        // file name for I/O events, truncated\n"
+           "};\n"
+           "\n"
+           "struct Ring {\n"
+           "    Event events[RING_SIZE];\n"
+           "    std::atomic<uint64_t> written{0};\n"
+           "    uint32_t tid = 0;\n"
+           "};\n"
+           "\n"
+           "struct Registry {\n"
+           "    std::mutex mutex;\n"
+           "    std::vector<Ring*> rings;\n"
+           "    std::string program;\n"
+           "    std::atomic<bool> flushed{false};\n"
+           "};\n"
+           "inline Registry& registry() { static Registry* r = new Registry(); return *r; }\n"
+           "\n"
+           "// Rings are never freed, so events of finished threads still reach the file\n"
+           "inline Ring& ring() {\n"
+           "    thread_local Ring* r = [] {\n"
+           "        Ring* created = new Ring;\n"
+           "        Registry& reg = registry();\n"
+           "        std::lock_guard<std::mutex> lock(reg.mutex);\n"
+           "        created->tid = static_cast<uint32_t>(reg.rings.size()) + 1;\n"
+           "        reg.rings.push_back(created);\n"
+           "        return created;\n"
+           "    }();\n"
+           "    return *r;\n"
+           "}\n"
+           "\n"
+           "inline void record(uint64_t start, uint64_t duration, const char* name, const char* category,\n"
+           "                   uint64_t bytes, const char* file) {\n"
+           "    Ring& r = ring();\n"
+           "    uint64_t n = r.written.load(std::memory_order_relaxed);\n"
+           "    Event& e = r.events[n % RING_SIZE];\n"
+           "    e.start = start;\n"
+           "    e.duration = duration;\n"
+           "    e.name = name;\n"
+           "    e.category = category;\n"
+           "    e.bytes = bytes;\n"
+           "    e.file[0] = '\\0';\n"
+           "    if (file) {\n"
+           "        std::strncpy(e.file, file, sizeof(e.file) - 1);\n"
+           "        e.file[sizeof(e.file) - 1] = '\\0';\n"
+           "    }\n"
+           "    r.written.store(n + 1, std::memory_order_release);\n"
+           "}\n"
+           "\n"
+           "// Procedure/function span\n"
+           "struct Scope {\n"
+           "    const char* name;\n"
+           "    uint64_t start;\n"
+           "    explicit Scope(const char* routine) : name(routine), start(pascal_clock::ticks()) {}\n"
+           "    ~Scope() { record(start, pascal_clock::ticks() - start, name, \"routine\", 0, nullptr); }\n"
+           "    Scope(const Scope&) = delete;\n"
+           "    Scope& operator=(const Scope&) = delete;\n"
+           "};\n"
+           "\n"
+           "template<typename File, typename Op>\n"
+           "void fileOp(File& f, const char* name, Op op) {\n"
+           "    uint64_t start = pascal_clock::ticks();\n"
+           "    op();\n"
+           "    std::string file = std::filesystem::path(f.getFilename()).filename().string();\n"
+           "    record(start, pascal_clock::ticks() - start, name, \"io\", 0, file.c_str());\n"
+           "}\n"
+           "template<typename File> void reset(File& f) { fileOp(f, \"Reset\", [&] { f.reset(); }); }\n"
+           "template<typename File> void rewrite(File& f) { fileOp(f, \"Rewrite\", [&] { f.rewrite(); }); }\n"
+           "template<typename File> void append(File& f) { fileOp(f, \"Append\", [&] { f.append(); }); }\n"
+           "template<typename File> void close(File& f) { fileOp(f, \"Close\", [&] { f.close(); }); }\n"
+           "\n"
+           "// New and GetMem pass their result through here; only large blocks become events\n"
+           "template<typename T> T* allocated(T* p, size_t bytes, const char* what) {\n"
+           "    if (bytes >= LARGE_ALLOCATION) {\n"
+           "        record(pascal_clock::ticks(), 0, what, \"memory\", bytes, nullptr);\n"
+           "    }\n"
+           "    return p;\n"
+           "}\n"
+           "\n"
+           "inline void writeJsonString(FILE* out, const char* text) {\n"
+           "    std::fputc('\"', out);\n"
+           "    for (const char* c = text; *c; ++c) {\n"
+           "        if (*c == '\"' || *c == '\\\\') std::fputc('\\\\', out);\n"
+           "        if (static_cast<unsigned char>(*c) >= 0x20) std::fputc(*c, out);\n"
+           "    }\n"
+           "    std::fputc('\"', out);\n"
+           "}\n"
+           "\n"
+           "// Write every ring to the trace file once, at exit. Nothing here is safe in a\n"
+           "// signal handler, so a program killed by a signal leaves no trace\n"
+           "inline void flush() {\n"
+           "    Registry& reg = registry();\n"
+           "    if (reg.flushed.exchange(true)) return;\n"
+           "    std::lock_guard<std::mutex> lock(reg.mutex);\n"
+           "    const char* path = std::getenv(\"RPASCAL_TRACE_OUT\");\n"
+           "    if (!path || !*path) path = \"rpascal.trace.json\";\n"
+           "    FILE* out = std::fopen(path, \"w\");\n"
+           "    if (!out) return;\n"
+           "#ifdef _WIN32\n"
+           "    long pid = static_cast<long>(_getpid());\n"
+           "#else\n"
+           "    long pid = static_cast<long>(getpid());\n"
+           "#endif\n"
+           "    double ticksPerUs = pascal_clock::ticksPerSecond() / 1e6;\n"
+           "    uint64_t origin = pascal_clock::origin().ticks;\n"
+           "    uint64_t dropped = 0;\n"
+           "    std::fprintf(out, \"{\\\"displayTimeUnit\\\":\\\"ms\\\",\\\"traceEvents\\\":[\\n\");\n"
+           "    std::fprintf(out, \"{\\\"name\\\":\\\"process_name\\\",\\\"ph\\\":\\\"M\\\",\\\"pid\\\":%ld,\\\"args\\\":{\\\"name\\\":\", pid);\n"
+           "    writeJsonString(out, reg.program.c_str());\n"
+           "    std::fprintf(out, \"}}\");\n"
+           "    for (Ring* r : reg.rings) {\n"
+           "        uint64_t n = r->written.load(std::memory_order_acquire);\n"
+           "        uint64_t first = n > RING_SIZE ? n - RING_SIZE : 0;\n"
+           "        dropped += first;\n"
+           "        for (uint64_t i = first; i < n; ++i) {\n"
+           "            const Event& e = r->events[i % RING_SIZE];\n"
+           "            double ts = e.start > origin ? static_cast<double>(e.start - origin) / ticksPerUs : 0.0;\n"
+           "            std::fprintf(out, \",\\n{\\\"name\\\":\\\"%s\\\",\\\"cat\\\":\\\"%s\\\",\\\"pid\\\":%ld,\\\"tid\\\":%u,\\\"ts\\\":%.3f\",\n"
+           "                         e.name, e.category, pid, r->tid, ts);\n"
+           "            if (e.duration > 0) {\n"
+           "                std::fprintf(out, \",\\\"ph\\\":\\\"X\\\",\\\"dur\\\":%.3f\", static_cast<double>(e.duration) / ticksPerUs);\n"
+           "            } else {\n"
+           "                std::fprintf(out, \",\\\"ph\\\":\\\"i\\\",\\\"s\\\":\\\"t\\\"\");\n"
+           "            }\n"
+           "            if (e.file[0]) {\n"
+           "                std::fprintf(out, \",\\\"args\\\":{\\\"file\\\":\");\n"
+           "                writeJsonString(out, e.file);\n"
+           "                std::fprintf(out, \"}\");\n"
+           "            } else if (e.bytes) {\n"
+           "                std::fprintf(out, \",\\\"args\\\":{\\\"bytes\\\":%llu}\", static_cast<unsigned long long>(e.bytes));\n"
+           "            }\n"
+           "            std::fprintf(out, \"}\");\n"
+           "        }\n"
+           "    }\n"
+           "    std::fprintf(out, \"\\n]}\\n\");\n"
+           "    std::fclose(out);\n"
+           "    std::fprintf(stderr, \"Trace written to %s\", path);\n"
+           "    if (dropped) std::fprintf(stderr, \" (%llu oldest events overwritten)\", static_cast<unsigned long long>(dropped));\n"
+           "    std::fprintf(stderr, \"\\n\");\n"
+           "}\n"
+           "\n"
+           "// Called first thing in main()\n"
+           "inline void start(const char* program) {\n"
+           "    registry().program = program;\n"
+           "    pascal_clock::origin();\n"
+           "    std::atexit(flush);\n"
+           "}\n"
+           "\n"
+           "} // namespace pascal_trace\n"
+           "#endif // RPASCAL_TRACE_INCLUDED";
+}
+
+std::string CppGenerator::generateInstrumentationRuntimes() {
+    std::string runtimes;
+    if (profiling_ || tracing_) {
+        runtimes += generateClockRuntime() + "\n";
+    }
+    if (profiling_) {
+        runtimes += generateProfilerRuntime() + "\n";
+    }
+    if (tracing_) {
+        runtimes += generateTraceRuntime() + "\n";
+    }
+    if (samplerRuntime_) {
+        runtimes += generateSamplerRuntime() + "\n";
+    }
+    if (heapStats_) {
+        runtimes += generateHeapStatsRuntime() + "\n";
+    }
+    return runtimes;
+}
+
+std::string CppGenerator::generateSamplerRuntime() {
+    // Emitted with --sample-profile (sampling on) and with -g (sampling only when
+    // RPASCAL_SAMPLE_PROFILE is set at run time)
+    return "#ifndef RPASCAL_SAMPLER_INCLUDED\n"
+           "#define RPASCAL_SAMPLER_INCLUDED\n"
+           "// Sampling profiler: SIGPROF interrupts the program at a fixed rate of CPU\n"
+           "// time and records the interrupted call stack. Off unless the program was\n"
+           "// built with --sample-profile or RPASCAL_SAMPLE_PROFILE is set when it runs\n"
+           "#ifdef __linux__\n"
+           "#include <atomic>\n"
+           "#include <csignal>\n"
+           "#include <cstdio>\n"
+           "#include <cxxabi.h>\n"
+           "#include <dlfcn.h>\n"
+           "#include <execinfo.h>\n"
+           "#include <link.h>\n"
+           "#include <map>\n"
+           "#include <sys/wait.h>\n"
+           "#include <time.h>\n"
+           "#include <ucontext.h>\n"
+           "#include <unistd.h>\n"
+           "#endif\n"
+           "\n"
+           "namespace pascal_sample {\n"
+           "\n"
+           "// C++ names of routines whose Pascal name differs (overloads are mangled);\n"
+           "// each translation unit registers its own at start-up\n"
+           "inline std::map<std::string, std::string>& routineNames() { static std::map<std::string, std::string> names; return names; }\n"
+           "inline bool nameRoutine(const char* cppName, const char* pascalName) {\n"
+           "    routineNames()[cppName] = pascalName;\n"
+           "    return true;\n"
+           "}\n"
+           "\n"
+           "#ifdef __linux__\n"
+           "constexpr int MAX_DEPTH = 48;\n"
+           "constexpr size_t MAX_SAMPLES = 64 * 1024;\n"
+           "\n"
+           "struct Sample {\n"
+           "    int depth;\n"
+           "    void* pcs[MAX_DEPTH];    // leaf first\n"
+           "};\n"
+           "\n"
+           "struct State {\n"
+           "    Sample* samples = nullptr;\n"
+           "    std::atomic<size_t> next{0};\n"
+           "    int hz = 1000;\n"
+           "    std::string program;\n"
+           "    timer_t timer{};\n"
+           "    long long periodNs = 1000000;\n"
+           "    double cpuStart = 0;\n"
+           "};\n"
+           "inline double cpuSeconds() {\n"
+           "    timespec now{};\n"
+           "    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);\n"
+           "    return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) / 1e9;\n"
+           "}\n"
+           "inline State& state() { static State s; return s; }\n"
+           "\n"
+           "// Runs in the signal handler: only the preallocated buffer is touched\n"
+           "inline void onSample(int, siginfo_t*, void* context) {\n"
+           "    State& s = state();\n"
+           "    // The timer runs on wall time; skip ticks where this thread was not\n"
+           "    // running, so the profile stays one of CPU time\n"
+           "    static thread_local long long lastCpu = -1;\n"
+           "    timespec now {};\n"
+           "    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);\n"
+           "    long long cpu = static_cast<long long>(now.tv_sec) * 1000000000LL + now.tv_nsec;\n"
+           "    bool busy = lastCpu < 0 || cpu - lastCpu >= s.periodNs / 2;\n"
+           "    lastCpu = cpu;\n"
+           "    if (!busy) return;\n"
+           "    size_t index = s.next.fetch_add(1, std::memory_order_relaxed);\n"
+           "    if (index >= MAX_SAMPLES) return;\n"
+           "    Sample& sample = s.samples[index];\n"
+           "    void* frames[MAX_DEPTH + 8];\n"
+           "    int count = backtrace(frames, MAX_DEPTH + 8);\n"
+           "    // The handler's own frames come first; the program's start at the interrupted PC\n"
+           "    void* leaf = nullptr;\n"
+           "    const ucontext_t* uc = static_cast<const ucontext_t*>(context);\n"
+           "#if defined(__x86_64__)\n"
+           "    leaf = reinterpret_cast<void*>(uc->uc_mcontext.gregs[REG_RIP]);\n"
+           "#elif defined(__i386__)\n"
+           "    leaf = reinterpret_cast<void*>(uc->uc_mcontext.gregs[REG_EIP]);\n"
+           "#elif defined(__aarch64__)\n"
+           "    leaf = reinterpret_cast<void*>(uc->uc_mcontext.pc);\n"
+           "#else\n"
+           "    (void)uc;\n"
+           "#endif\n"
+           "    int first = 0;\n"
+           "    while (first < count && frames[first] != leaf) ++first;\n"
+           "    sample.depth = 0;\n"
+           "    if (first == count) {\n"
+           "        // The unwinder did not get past the signal frame; keep just the leaf\n"
+           "        if (leaf) sample.pcs[sample.depth++] = leaf;\n"
+           "        return;\n"
+           "    }\n"
+           "    for (int i = first; i < count && sample.depth < MAX_DEPTH; ++i) {\n"
+           "        sample.pcs[sample.depth++] = frames[i];\n"
+           "    }\n"
+           "}\n"
+           "\n"
+           "// Where each address came from: Pascal (or C++) function, file and line\n"
+           "struct Location {\n"
+           "    std::string function;\n"
+           "    std::string file;\n"
+           "    int line = 0;\n"
+           "};\n"
+           "\n"
+           "struct MainImage { uintptr_t bias = 0; std::vector<std::pair<uintptr_t, uintptr_t>> ranges; };\n"
+           "inline int findMainImage(dl_phdr_info* info, size_t, void* data) {\n"
+           "    MainImage* image = static_cast<MainImage*>(data);\n"
+           "    image->bias = info->dlpi_addr;\n"
+           "    for (int i = 0; i < info->dlpi_phnum; ++i) {\n"
+           "        if (info->dlpi_phdr[i].p_type == PT_LOAD) {\n"
+           "            uintptr_t start = info->dlpi_addr + info->dlpi_phdr[i].p_vaddr;\n"
+           "            image->ranges.push_back({start, start + info->dlpi_phdr[i].p_memsz});\n"
+           "        }\n"
+           "    }\n"
+           "    return 1;  // the first object is the executable\n"
+           "}\n"
+           "\n"
+           "inline std::string cleanFunction(std::string name, const std::string& program) {\n"
+           "    size_t paren = name.find('(');\n"
+           "    if (paren != std::string::npos) name.erase(paren);\n"
+           "    if (name == \"main\") return program;\n"
+           "    auto pascal = routineNames().find(name);\n"
+           "    return pascal != routineNames().end() ? pascal->second : name;\n"
+           "}\n"
+           "\n"
+           "inline std::string demangle(const char* symbol) {\n"
+           "    int status = 0;\n"
+           "    char* text = abi::__cxa_demangle(symbol, nullptr, nullptr, &status);\n"
+           "    std::string result = status == 0 && text ? text : symbol;\n"
+           "    std::free(text);\n"
+           "    return result;\n"
+           "}\n"
+           "\n"
+           "// Map addresses to source through the executable's debug info (addr2line);\n"
+           "// #line directives make that the Pascal file. Falls back to symbol names,\n"
+           "// clearing lineInfo, when addr2line cannot be run\n"
+           "inline std::map<void*, std::vector<Location>> symbolize(const std::vector<void*>& pcs, const std::string& program, bool& lineInfo) {\n"
+           "    std::map<void*, std::vector<Location>> result;\n"
+           "    MainImage image;\n"
+           "    dl_iterate_phdr(findMainImage, &image);\n"
+           "    auto inMain = [&](uintptr_t pc) {\n"
+           "        for (const auto& range : image.ranges) if (pc >= range.first && pc < range.second) return true;\n"
+           "        return false;\n"
+           "    };\n"
+           "\n"
+           "    char listPath[] = \"/tmp/rpascal_samples_XXXXXX\";\n"
+           "    int fd = mkstemp(listPath);\n"
+           "    std::vector<void*> mainPcs;\n"
+           "    lineInfo = false;\n"
+           "    if (fd >= 0) {\n"
+           "        FILE* list = fdopen(fd, \"w\");\n"
+           "        for (void* pc : pcs) {\n"
+           "            if (inMain(reinterpret_cast<uintptr_t>(pc))) {\n"
+           "                std::fprintf(list, \"%#llx\\n\", static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(pc) - image.bias));\n"
+           "                mainPcs.push_back(pc);\n"
+           "            }\n"
+           "        }\n"
+           "        std::fclose(list);\n"
+           "        std::string command = \"addr2line -a -f -i -C -e /proc/\" + std::to_string(getpid()) + \"/exe < \" + listPath + \" 2>/dev/null\";\n"
+           "        FILE* out = mainPcs.empty() ? nullptr : popen(command.c_str(), \"r\");\n"
+           "        if (out) {\n"
+           "            char line[4096];\n"
+           "            size_t current = 0;\n"
+           "            bool started = false;\n"
+           "            std::string function;\n"
+           "            bool haveFunction = false;\n"
+           "            while (std::fgets(line, sizeof(line), out)) {\n"
+           "                std::string text(line);\n"
+           "                while (!text.empty() && (text.back() == '\\n' || text.back() == '\\r')) text.pop_back();\n"
+           "                if (text.compare(0, 2, \"0x\") == 0) {\n"
+           "                    if (started) ++current;\n"
+           "                    started = true;\n"
+           "                    haveFunction = false;\n"
+           "                } else if (current < mainPcs.size() && !haveFunction) {\n"
+           "                    function = text;\n"
+           "                    haveFunction = true;\n"
+           "                } else if (current < mainPcs.size()) {\n"
+           "                    Location location;\n"
+           "                    location.function = cleanFunction(function, program);\n"
+           "                    size_t discriminator = text.find(\" (\");\n"
+           "                    if (discriminator != std::string::npos) text.erase(discriminator);\n"
+           "                    size_t colon = text.rfind(':');\n"
+           "                    location.file = colon == std::string::npos ? text : text.substr(0, colon);\n"
+           "                    location.line = colon == std::string::npos ? 0 : std::atoi(text.c_str() + colon + 1);\n"
+           "                    // Without debug info addr2line still knows the function but not the line\n"
+           "                    if (location.function == \"??\") location.function.clear();\n"
+           "                    if (location.file == \"??\") location.file.clear();\n"
+           "                    result[mainPcs[current]].push_back(location);\n"
+           "                    haveFunction = false;\n"
+           "                }\n"
+           "            }\n"
+           "            int status = pclose(out);\n"
+           "            lineInfo = status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0 && current + 1 >= mainPcs.size();\n"
+           "        }\n"
+           "        unlink(listPath);\n"
+           "    }\n"
+           "    if (!lineInfo) {\n"
+           "        std::fprintf(stderr, \"Sampling profile: cannot run addr2line (is binutils installed?); \"\n"
+           "                     \"no source lines, and unexported functions are shown as addresses\\n\");\n"
+           "    }\n"
+           "\n"
+           "    for (void* pc : pcs) {\n"
+           "        auto& locations = result[pc];\n"
+           "        if (!locations.empty() && !locations.front().function.empty()) continue;\n"
+           "        locations.clear();\n"
+           "        Location location;\n"
+           "        Dl_info info{};\n"
+           "        if (dladdr(pc, &info) && info.dli_sname) {\n"
+           "            location.function = cleanFunction(demangle(info.dli_sname), program);\n"
+           "        } else {\n"
+           "            char address[32];\n"
+           "            std::snprintf(address, sizeof(address), \"%p\", pc);\n"
+           "            location.function = address;\n"
+           "        }\n"
+           "        if (info.dli_fname && !inMain(reinterpret_cast<uintptr_t>(pc))) {\n"
+           "            location.file = std::filesystem::path(info.dli_fname).filename().string();\n"
+           "        }\n"
+           "        locations.push_back(location);\n"
+           "    }\n"
+           "    return result;\n"
+           "}\n"
+           "\n"
+           "inline void report() {\n"
+           "    State& s = state();\n"
+           "    timer_delete(s.timer);\n"
+           "    std::signal(SIGPROF, SIG_IGN);\n"
+           "    double cpuTime = cpuSeconds() - s.cpuStart;\n"
+           "    size_t total = std::min(s.next.load(), MAX_SAMPLES);\n"
+           "    if (total == 0) {\n"
+           "        std::fprintf(stderr, \"Sampling profile: no samples\\n\");\n"
+           "        return;\n"
+           "    }\n"
+           "\n"
+           "    // Return addresses point after the call; look up the call instruction\n"
+           "    std::vector<void*> pcs;\n"
+           "    for (size_t i = 0; i < total; ++i) {\n"
+           "        for (int d = 0; d < s.samples[i].depth; ++d) {\n"
+           "            void* pc = s.samples[i].pcs[d];\n"
+           "            if (d > 0) pc = static_cast<char*>(pc) - 1;\n"
+           "            s.samples[i].pcs[d] = pc;\n"
+           "            pcs.push_back(pc);\n"
+           "        }\n"
+           "    }\n"
+           "    std::sort(pcs.begin(), pcs.end());\n"
+           "    pcs.erase(std::unique(pcs.begin(), pcs.end()), pcs.end());\n"
+           "    bool lineInfo = false;\n"
+           "    auto symbols = symbolize(pcs, s.program, lineInfo);\n"
+           "\n"
+           "    std::map<std::string, size_t> selfByFunction, totalByFunction, selfByLine;\n"
+           "    std::map<std::string, size_t> folded;\n"
+           "    for (size_t i = 0; i < total; ++i) {\n"
+           "        const Sample& sample = s.samples[i];\n"
+           "        std::vector<std::string> stack;  // leaf first, inline frames expanded\n"
+           "        bool reachedMain = false;\n"
+           "        for (int d = 0; d < sample.depth && !reachedMain; ++d) {\n"
+           "            for (const auto& location : symbols[sample.pcs[d]]) {\n"
+           "                stack.push_back(location.function);\n"
+           "                // Frames below main are C runtime start-up\n"
+           "                reachedMain = location.function == s.program;\n"
+           "                if (reachedMain) break;\n"
+           "            }\n"
+           "        }\n"
+           "        if (stack.empty()) continue;\n"
+           "        const Location& leaf = symbols[sample.pcs[0]].front();\n"
+           "        ++selfByFunction[leaf.function];\n"
+           "        std::string where = leaf.file.empty() ? \"?\" : std::filesystem::path(leaf.file).filename().string() + \":\" + std::to_string(leaf.line);\n"
+           "        ++selfByLine[where + \"  \" + leaf.function];\n"
+           "        std::vector<std::string> seen;\n"
+           "        for (const auto& function : stack) {\n"
+           "            if (std::find(seen.begin(), seen.end(), function) == seen.end()) {\n"
+           "                seen.push_back(function);\n"
+           "                ++totalByFunction[function];\n"
+           "            }\n"
+           "        }\n"
+           "        // Folded stacks are root first\n"
+           "        std::string line;\n"
+           "        for (size_t k = stack.size(); k-- > 0;) {\n"
+           "            if (!line.empty()) line += \";\";\n"
+           "            line += stack[k];\n"
+           "        }\n"
+           "        ++folded[line];\n"
+           "    }\n"
+           "\n"
+           "    auto byCount = [](const std::map<std::string, size_t>& counts) {\n"
+           "        std::vector<std::pair<std::string, size_t>> sorted(counts.begin(), counts.end());\n"
+           "        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second > b.second; });\n"
+           "        return sorted;\n"
+           "    };\n"
+           "    const char* base = std::getenv(\"RPASCAL_SAMPLE_OUT\");\n"
+           "    std::string textPath = std::string(base && *base ? base : \"rpascal\") + \".samples.txt\";\n"
+           "    std::string foldedPath = std::string(base && *base ? base : \"rpascal\") + \".folded\";\n"
+           "    double pct = 100.0 / static_cast<double>(total);\n"
+           "    if (FILE* text = std::fopen(textPath.c_str(), \"w\")) {\n"
+           "        // The achieved rate counts every signal, kept or dropped, per second of CPU time\n"
+           "        double achieved = cpuTime > 0 ? static_cast<double>(s.next.load()) / cpuTime : 0.0;\n"
+           "        std::fprintf(text, \"Sampling profile: %s, %zu samples in %.2f s CPU (%.0f Hz achieved, %d Hz requested)\",\n"
+           "                     s.program.c_str(), total, cpuTime, achieved, s.hz);\n"
+           "        if (s.next.load() > MAX_SAMPLES) std::fprintf(text, \" (%zu more dropped)\", s.next.load() - MAX_SAMPLES);\n"
+           "        if (!lineInfo) std::fprintf(text, \"\\nNo source lines: addr2line could not be run\");\n"
+           "        std::fprintf(text, \"\\n\\nFunctions\\n  self%%    self  total%%   total  function\\n\");\n"
+           "        std::vector<std::pair<std::string, size_t>> functions(totalByFunction.begin(), totalByFunction.end());\n"
+           "        std::sort(functions.begin(), functions.end(), [&](const auto& a, const auto& b) {\n"
+           "            size_t selfA = selfByFunction[a.first], selfB = selfByFunction[b.first];\n"
+           "            return selfA != selfB ? selfA > selfB : a.second > b.second;\n"
+           "        });\n"
+           "        for (const auto& [function, inclusive] : functions) {\n"
+           "            size_t count = selfByFunction[function];\n"
+           "            std::fprintf(text, \"%6.2f %7zu %7.2f %7zu  %s\\n\", count * pct, count, inclusive * pct, inclusive, function.c_str());\n"
+           "        }\n"
+           "        std::fprintf(text, \"\\nLines\\n  self%%    self  location  function\\n\");\n"
+           "        for (const auto& [where, count] : byCount(selfByLine)) {\n"
+           "            std::fprintf(text, \"%6.2f %7zu  %s\\n\", count * pct, count, where.c_str());\n"
+           "        }\n"
+           "        std::fclose(text);\n"
+           "    }\n"
+           "    if (FILE* out = std::fopen(foldedPath.c_str(), \"w\")) {\n"
+           "        for (const auto& [stack, count] : folded) std::fprintf(out, \"%s %zu\\n\", stack.c_str(), count);\n"
+           "        std::fclose(out);\n"
+           "    }\n"
+           "    std::fprintf(stderr, \"Sampling profile written to %s and %s\\n\", textPath.c_str(), foldedPath.c_str());\n"
+           "}\n"
+           "\n"
+           "// Called first thing in main(); builtIn is set for --sample-profile builds\n"
+           "inline void start(const char* program, bool builtIn) {\n"
+           "    const char* env = std::getenv(\"RPASCAL_SAMPLE_PROFILE\");\n"
+           "    bool enabled = env ? std::strcmp(env, \"0\") != 0 : builtIn;\n"
+           "    if (!enabled) return;\n"
+           "    State& s = state();\n"
+           "    s.program = program;\n"
+           "    if (const char* hz = std::getenv(\"RPASCAL_SAMPLE_HZ\")) s.hz = std::max(1, std::atoi(hz));\n"
+           "    // Untouched pages cost nothing; samples fill them as they arrive\n"
+           "    s.samples = static_cast<Sample*>(std::malloc(sizeof(Sample) * MAX_SAMPLES));\n"
+           "    if (!s.samples) return;\n"
+           "    void* warm[1];\n"
+           "    backtrace(warm, 1);  // loads the unwinder before the first signal\n"
+           "    struct sigaction action {};\n"
+           "    action.sa_sigaction = onSample;\n"
+           "    action.sa_flags = SA_SIGINFO | SA_RESTART;\n"
+           "    sigemptyset(&action.sa_mask);\n"
+           "    sigaction(SIGPROF, &action, nullptr);\n"
+           "    // CPU-time timers (ITIMER_PROF, CLOCK_PROCESS_CPUTIME_ID) only fire on\n"
+           "    // scheduler ticks, which caps them at the kernel's HZ; a monotonic\n"
+           "    // timer keeps the requested rate and the handler drops idle ticks\n"
+           "    sigevent event {};\n"
+           "    event.sigev_notify = SIGEV_SIGNAL;\n"
+           "    event.sigev_signo = SIGPROF;\n"
+           "    if (timer_create(CLOCK_MONOTONIC, &event, &s.timer) != 0) {\n"
+           "        std::perror(\"Sampling profile: timer_create\");\n"
+           "        return;\n"
+           "    }\n"
+           "    s.periodNs = std::max(1LL, 1000000000LL / s.hz);\n"
+           "    itimerspec timer {};\n"
+           "    timer.it_interval.tv_sec = static_cast<time_t>(s.periodNs / 1000000000LL);\n"
+           "    timer.it_interval.tv_nsec = static_cast<long>(s.periodNs % 1000000000LL);\n"
+           "    timer.it_value = timer.it_interval;\n"
+           "    s.cpuStart = cpuSeconds();\n"
+           "    timer_settime(s.timer, 0, &timer, nullptr);\n"
+           "    std::atexit(report);\n"
+           "}\n"
+           "#else\n"
+           "inline void start(const char*, bool builtIn) {\n"
+           "    if (builtIn || std::getenv(\"RPASCAL_SAMPLE_PROFILE\")) {\n"
+           "        std::fprintf(stderr, \"Sampling profiler is only available on Linux\\n\");\n"
+           "    }\n"
+           "}\n"
+           "#endif\n"
+           "\n"
+           "} // namespace pascal_sample\n"
+           "#endif // RPASCAL_SAMPLER_INCLUDED";
+}
+
+std::string CppGenerator::generateHeapStatsRuntime() {
+    // Emitted only with --heap-stats: allocation sites count their blocks and
+    // the live ones are tracked for the leak report
+    return "#ifndef RPASCAL_HEAP_INCLUDED\n"
+           "#define RPASCAL_HEAP_INCLUDED\n"
+           "// Heap statistics (--heap-stats): New/GetMem/Dispose/FreeMem go through\n"
+           "// here and are counted per allocation site; live blocks are tracked so the\n"
+           "// report at exit can list leaks\n"
+           "#include <cstdio>\n"
+           "#include <map>\n"
+           "#include <mutex>\n"
+           "#include <typeinfo>\n"
+           "#include <unordered_map>\n"
+           "#if defined(__GNUC__)\n"
+           "#include <cxxabi.h>\n"
+           "#endif\n"
+           "\n"
+           "namespace pascal_heap {\n"
+           "\n"
+           "// One New/GetMem call in the Pascal source\n"
+           "struct Site {\n"
+           "    std::string type;\n"
+           "    const char* file;\n"
+           "    int line;\n"
+           "    uint64_t allocations = 0;\n"
+           "    uint64_t frees = 0;\n"
+           "    uint64_t bytes = 0;\n"
+           "    uint64_t liveBytes = 0;\n"
+           "    uint64_t liveBlocks = 0;\n"
+           "    Site(std::string typeName, const char* sourceFile, int sourceLine);\n"
+           "};\n"
+           "\n"
+           "struct Block { Site* site; size_t bytes; };\n"
+           "\n"
+           "constexpr int SIZE_CLASSES = 48;\n"
+           "\n"
+           "struct Heap {\n"
+           "    std::mutex mutex;\n"
+           "    std::vector<Site*> sites;\n"
+           "    std::unordered_map<void*, Block> live;\n"
+           "    uint64_t liveBytes = 0;\n"
+           "    uint64_t peakBytes = 0;\n"
+           "    uint64_t allocations = 0;\n"
+           "    uint64_t frees = 0;\n"
+           "    uint64_t unknownFrees = 0;\n"
+           "    uint64_t sizeClasses[SIZE_CLASSES] = {};   // class n holds sizes up to 2^n\n"
+           "    std::string program;\n"
+           "};\n"
+           "inline Heap& heap() { static Heap* h = new Heap(); return *h; }\n"
+           "\n"
+           "inline Site::Site(std::string typeName, const char* sourceFile, int sourceLine)\n"
+           "    : type(std::move(typeName)), file(sourceFile), line(sourceLine) {\n"
+           "    Heap& h = heap();\n"
+           "    std::lock_guard<std::mutex> lock(h.mutex);\n"
+           "    h.sites.push_back(this);\n"
+           "}\n"
+           "\n"
+           "template<typename T> std::string typeName() {\n"
+           "    const char* name = typeid(T).name();\n"
+           "#if defined(__GNUC__)\n"
+           "    int status = 0;\n"
+           "    char* text = abi::__cxa_demangle(name, nullptr, nullptr, &status);\n"
+           "    std::string result = status == 0 && text ? text : name;\n"
+           "    std::free(text);\n"
+           "    return result;\n"
+           "#else\n"
+           "    return name;\n"
+           "#endif\n"
+           "}\n"
+           "\n"
+           "inline void allocated(void* p, size_t bytes, Site& site) {\n"
+           "    Heap& h = heap();\n"
+           "    std::lock_guard<std::mutex> lock(h.mutex);\n"
+           "    h.live[p] = {&site, bytes};\n"
+           "    ++h.allocations;\n"
+           "    h.liveBytes += bytes;\n"
+           "    if (h.liveBytes > h.peakBytes) h.peakBytes = h.liveBytes;\n"
+           "    int sizeClass = 0;\n"
+           "    while (sizeClass < SIZE_CLASSES - 1 && (static_cast<size_t>(1) << sizeClass) < bytes) ++sizeClass;\n"
+           "    ++h.sizeClasses[sizeClass];\n"
+           "    ++site.allocations;\n"
+           "    site.bytes += bytes;\n"
+           "    site.liveBytes += bytes;\n"
+           "    ++site.liveBlocks;\n"
+           "}\n"
+           "\n"
+           "inline void released(void* p) {\n"
+           "    if (!p) return;\n"
+           "    Heap& h = heap();\n"
+           "    std::lock_guard<std::mutex> lock(h.mutex);\n"
+           "    auto it = h.live.find(p);\n"
+           "    if (it == h.live.end()) {\n"
+           "        ++h.unknownFrees;\n"
+           "        return;\n"
+           "    }\n"
+           "    Site& site = *it->second.site;\n"
+           "    ++h.frees;\n"
+           "    h.liveBytes -= it->second.bytes;\n"
+           "    ++site.frees;\n"
+           "    site.liveBytes -= it->second.bytes;\n"
+           "    --site.liveBlocks;\n"
+           "    h.live.erase(it);\n"
+           "}\n"
+           "\n"
+           "template<typename T> T* create(Site& site) {\n"
+           "    T* p = std::make_unique<T>().release();\n"
+           "    allocated(p, sizeof(T), site);\n"
+           "    return p;\n"
+           "}\n"
+           "template<typename T> void dispose(T* p) {\n"
+           "    released(p);\n"
+           "    delete p;\n"
+           "}\n"
+           "inline uint8_t* getmem(size_t bytes, Site& site) {\n"
+           "    uint8_t* p = std::make_unique<uint8_t[]>(bytes).release();\n"
+           "    allocated(p, bytes, site);\n"
+           "    return p;\n"
+           "}\n"
+           "template<typename T> void freemem(T* p) {\n"
+           "    released(p);\n"
+           "    delete[] p;\n"
+           "}\n"
+           "\n"
+           "inline std::string where(const Site& site) {\n"
+           "    return std::filesystem::path(site.file).filename().string() + \":\" + std::to_string(site.line);\n"
+           "}\n"
+           "\n"
+           "inline void report() {\n"
+           "    Heap& h = heap();\n"
+           "    std::lock_guard<std::mutex> lock(h.mutex);\n"
+           "    const char* path = std::getenv(\"RPASCAL_HEAP_OUT\");\n"
+           "    if (!path || !*path) path = \"rpascal.heap.txt\";\n"
+           "    FILE* out = std::fopen(path, \"w\");\n"
+           "    if (!out) return;\n"
+           "    auto ull = [](uint64_t v) { return static_cast<unsigned long long>(v); };\n"
+           "\n"
+           "    std::fprintf(out, \"Heap statistics: %s\\n\", h.program.c_str());\n"
+           "    std::fprintf(out, \"  allocations %llu, frees %llu, peak live %llu bytes, live at exit %llu bytes in %zu blocks\\n\",\n"
+           "                 ull(h.allocations), ull(h.frees), ull(h.peakBytes), ull(h.liveBytes), h.live.size());\n"
+           "    if (h.unknownFrees) {\n"
+           "        std::fprintf(out, \"  %llu Dispose/FreeMem calls on pointers not from New/GetMem\\n\", ull(h.unknownFrees));\n"
+           "    }\n"
+           "\n"
+           "    struct Totals { uint64_t allocations = 0, frees = 0, bytes = 0, liveBytes = 0, liveBlocks = 0; };\n"
+           "    std::map<std::string, Totals> byType;\n"
+           "    for (const Site* site : h.sites) {\n"
+           "        Totals& t = byType[site->type];\n"
+           "        t.allocations += site->allocations;\n"
+           "        t.frees += site->frees;\n"
+           "        t.bytes += site->bytes;\n"
+           "        t.liveBytes += site->liveBytes;\n"
+           "        t.liveBlocks += site->liveBlocks;\n"
+           "    }\n"
+           "    std::fprintf(out, \"\\nBy type\\n      allocs       frees     total bytes      live bytes  type\\n\");\n"
+           "    for (const auto& [type, t] : byType) {\n"
+           "        std::fprintf(out, \"%12llu %11llu %15llu %15llu  %s\\n\", ull(t.allocations), ull(t.frees), ull(t.bytes), ull(t.liveBytes), type.c_str());\n"
+           "    }\n"
+           "\n"
+           "    std::vector<Site*> sites = h.sites;\n"
+           "    std::sort(sites.begin(), sites.end(), [](const Site* a, const Site* b) { return a->bytes > b->bytes; });\n"
+           "    std::fprintf(out, \"\\nBy site (most bytes first)\\n      allocs       frees     total bytes      live bytes  site  type\\n\");\n"
+           "    for (const Site* site : sites) {\n"
+           "        std::fprintf(out, \"%12llu %11llu %15llu %15llu  %s  %s\\n\", ull(site->allocations), ull(site->frees), ull(site->bytes),\n"
+           "                     ull(site->liveBytes), where(*site).c_str(), site->type.c_str());\n"
+           "    }\n"
+           "\n"
+           "    std::fprintf(out, \"\\nAllocation sizes\\n\");\n"
+           "    uint64_t most = 1;\n"
+           "    for (uint64_t count : h.sizeClasses) most = std::max(most, count);\n"
+           "    for (int c = 0; c < SIZE_CLASSES; ++c) {\n"
+           "        if (!h.sizeClasses[c]) continue;\n"
+           "        std::string bar(static_cast<size_t>(40 * h.sizeClasses[c] / most) + 1, '#');\n"
+           "        std::fprintf(out, \"  <= %12llu bytes %12llu  %s\\n\", ull(static_cast<uint64_t>(1) << c), ull(h.sizeClasses[c]), bar.c_str());\n"
+           "    }\n"
+           "\n"
+           "    std::fprintf(out, \"\\nLeaks (blocks still allocated at exit)\\n\");\n"
+           "    bool leaked = false;\n"
+           "    for (const Site* site : sites) {\n"
+           "        if (!site->liveBlocks) continue;\n"
+           "        leaked = true;\n"
+           "        std::fprintf(out, \"  %llu blocks, %llu bytes from %s (%s)\\n\", ull(site->liveBlocks), ull(site->liveBytes),\n"
+           "                     where(*site).c_str(), site->type.c_str());\n"
+           "    }\n"
+           "    if (!leaked) std::fprintf(out, \"  none\\n\");\n"
+           "    std::fclose(out);\n"
+           "    std::fprintf(stderr, \"Heap statistics written to %s\", path);\n"
+           "    if (leaked) std::fprintf(stderr, \" (%zu blocks, %llu bytes leaked)\", h.live.size(), ull(h.liveBytes));\n"
+           "    std::fprintf(stderr, \"\\n\");\n"
+           "}\n"
+           "\n"
+           "// Called first thing in main()\n"
+           "inline void start(const char* program) {\n"
+           "    heap().program = program;\n"
+           "    std::atexit(report);\n"
+           "}\n"
+           "\n"
+           "} // namespace pascal_heap\n"
+           "#endif // RPASCAL_HEAP_INCLUDED";
 }
 
 std::string CppGenerator::generateForwardDeclarations(const std::vector<std::unique_ptr<Declaration>>& declarations) {
@@ -1675,10 +4143,41 @@ std::string CppGenerator::mapPascalOperatorToCpp(TokenType operator_) {
 }
 
 std::string CppGenerator::mapPascalTypeToCpp(const std::string& pascalType) {
+    // The same few types come up for every variable, parameter and field.
+    // A mapping also depends on the enum and array tables and on symbol
+    // lookups, so the cache is cleared whenever a type is defined and when a
+    // routine's scope is entered or left
+    auto cached = typeMappingCache_.find(pascalType);
+    if (cached != typeMappingCache_.end()) {
+        return cached->second;
+    }
+    std::string cppType = mapPascalTypeToCppUncached(pascalType);
+    typeMappingCache_.emplace(pascalType, cppType);
+    return cppType;
+}
+
+std::string CppGenerator::mapPascalTypeToCppUncached(const std::string& pascalType) {
     std::string lowerType = pascalType;
     std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(), 
                    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
     
+    // Packed arrays of Boolean and small subranges are stored as bits;
+    // packing any other array changes nothing
+    if (lowerType.rfind("packed ", 0) == 0) {
+        std::string unpackedType = pascalType.substr(7);
+        size_t bracketEnd = unpackedType.find(']');
+        size_t ofPos = unpackedType.find(" of ", bracketEnd == std::string::npos ? 0 : bracketEnd);
+        if (bracketEnd != std::string::npos && ofPos != std::string::npos) {
+            std::string elementType = unpackedType.substr(ofPos + 4);
+            elementType.erase(0, elementType.find_first_not_of(" \t\n\r"));
+            std::string packedType = packedArrayType(elementType, arrayElementCount(unpackedType.substr(6, bracketEnd - 6)));
+            if (!packedType.empty()) {
+                return packedType;
+            }
+        }
+        return mapPascalTypeToCpp(unpackedType);
+    }
+    
     // Handle pointer types: ^Type -> Type*
     if (!lowerType.empty() && lowerType[0] == '^') {
         std::string pointeeType = pascalType.substr(1); // Use original case, not lowercase
@@ -1743,39 +4242,336 @@ std::string CppGenerator::mapPascalTypeToCpp(const std::string& pascalType) {
         }
     }
     
-    // Handle subrange types: 0..9 -> int, 'A'..'Z' -> char
-    if (lowerType.find("..") != std::string::npos) {
-        // Check if it's a character range 'A'..'Z'
-        if (lowerType.find("'") != std::string::npos) {
-            return "char";
-        } else {
-            // Numeric range like 0..9
-            return "int";
+    // Handle subrange types: 0..9 -> uint8_t, 'A'..'Z' -> char
+    if (lowerType.find("..") != std::string::npos) {
+        // Check if it's a character range 'A'..'Z'
+        if (lowerType.find("'") != std::string::npos) {
+            return "char";
+        } else {
+            // Numeric range like 0..9; ranges over enum values stay int
+            size_t rangePos = lowerType.find("..");
+            try {
+                return narrowestIntegerType(std::stoll(lowerType.substr(0, rangePos)),
+                                            std::stoll(lowerType.substr(rangePos + 2)));
+            } catch (const std::exception&) {
+                return "int";
+            }
+        }
+    }
+    
+    if (lowerType == "integer") return "int32_t";
+    if (lowerType == "real") return "double";
+    if (lowerType == "single") return "float";
+    if (lowerType == "double") return "double";
+    if (lowerType == "extended") return "long double";
+    if (lowerType == "comp") return "PascalComp";
+    if (lowerType == "boolean") return "bool";
+    if (lowerType == "char") return "char";
+    if (lowerType == "byte") return "uint8_t";
+    if (lowerType == "string") return "std::string";
+    if (lowerType == "text") return "PascalFile";
+    if (lowerType == "file") return "PascalFile"; // Untyped file
+    
+    // Handle bounded string types: string[30] -> std::string
+    if (lowerType.find("string[") == 0 && lowerType.find(']') != std::string::npos) {
+        return "std::string"; // For now, map bounded strings to std::string
+    }
+    
+    // Handle typed files: file of T
+    if (lowerType.find("file of") == 0) {
+        std::string elementType = lowerType.substr(8); // Skip "file of "
+        elementType.erase(0, elementType.find_first_not_of(" \t\n\r")); // Trim leading whitespace
+        return "PascalTypedFile<" + mapPascalTypeToCpp(elementType) + ">";
+    }
+    
+    return cppIdentifier(pascalType); // fallback
+}
+
+std::string CppGenerator::narrowestIntegerType(long long low, long long high) {
+    // Storage for an ordinal range; arithmetic on these promotes to int as usual
+    if (low >= 0 && high <= 0xFF) return "uint8_t";
+    if (low >= -0x80 && high <= 0x7F) return "int8_t";
+    if (low >= 0 && high <= 0xFFFF) return "uint16_t";
+    if (low >= -0x8000 && high <= 0x7FFF) return "int16_t";
+    return "int";
+}
+
+bool CppGenerator::isNarrowOrdinal(const std::string& pascalType) const {
+    // Byte, enums and subranges stored in fewer bits than int
+    std::string type = pascalType;
+    for (int depth = 0; depth < 8 && !type.empty(); ++depth) {
+        std::string lowerType = type;
+        std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (lowerType == "byte") return true;
+        if (enumTypes_->count(type) > 0) return true;
+        size_t rangePos = lowerType.find("..");
+        if (rangePos != std::string::npos) {
+            if (lowerType.find('\'') != std::string::npos) return false;
+            try {
+                return narrowestIntegerType(std::stoll(lowerType.substr(0, rangePos)),
+                                            std::stoll(lowerType.substr(rangePos + 2))) != "int";
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        if (!symbolTable_) return false;
+        auto symbol = symbolTable_->lookup(type);
+        if (!symbol || symbol->getSymbolType() != SymbolType::TYPE_DEF || symbol->getTypeDefinition() == type) {
+            return false;
+        }
+        type = symbol->getTypeDefinition();
+    }
+    return false;
+}
+
+bool CppGenerator::hasTrivialStorage(const std::string& pascalType) const {
+    std::string lowerType = pascalType;
+    std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    
+    // Pointers are plain addresses whatever they point to
+    if (!lowerType.empty() && lowerType[0] == '^') {
+        return true;
+    }
+    // Open and dynamic arrays become std::vector
+    if (lowerType.find("array of") != std::string::npos) {
+        return false;
+    }
+    
+    // Otherwise look at every identifier in the type: array element types and
+    // the fields of inline records count too
+    size_t pos = 0;
+    while (pos < lowerType.size()) {
+        if (!std::isalpha(static_cast<unsigned char>(lowerType[pos])) && lowerType[pos] != '_') {
+            ++pos;
+            continue;
+        }
+        size_t end = pos;
+        while (end < lowerType.size() && (std::isalnum(static_cast<unsigned char>(lowerType[end])) || lowerType[end] == '_')) {
+            ++end;
+        }
+        std::string word = lowerType.substr(pos, end - pos);
+        if (word == "string" || word == "set" || word == "file" || word == "text" ||
+            nonTrivialTypes_.count(word) > 0) {
+            return false;
+        }
+        pos = end;
+    }
+    return true;
+}
+
+int CppGenerator::arrayElementCount(const std::string& bounds) const {
+    // "1..10", "'a'..'z'", an enum type name, or several of them separated by commas
+    int count = 1;
+    std::stringstream ss(bounds);
+    std::string dim;
+    while (std::getline(ss, dim, ',')) {
+        dim.erase(0, dim.find_first_not_of(" \t\n\r"));
+        dim.erase(dim.find_last_not_of(" \t\n\r") + 1);
+        size_t dotdotPos = dim.find("..");
+        if (dotdotPos == std::string::npos) {
+            auto enumIt = enumTypes_->find(dim);
+            if (enumIt == enumTypes_->end()) return -1;
+            count *= enumIt->second.size();
+            continue;
+        }
+        std::string startStr = dim.substr(0, dotdotPos);
+        std::string endStr = dim.substr(dotdotPos + 2);
+        startStr.erase(startStr.find_last_not_of(" \t\n\r") + 1);
+        endStr.erase(0, endStr.find_first_not_of(" \t\n\r"));
+        if (startStr.length() == 3 && startStr[0] == '\'' && endStr.length() == 3 && endStr[0] == '\'') {
+            count *= endStr[1] - startStr[1] + 1;
+            continue;
+        }
+        try {
+            count *= std::stoi(endStr) - std::stoi(startStr) + 1;
+        } catch (const std::exception&) {
+            return -1;
+        }
+    }
+    return count;
+}
+
+unsigned CppGenerator::packedElementBits(const std::string& elementType) const {
+    // Bits per element in a packed array: 1, 2 or 4 so that no element
+    // straddles a byte, or 0 when the element type isn't bit-packed
+    std::string lowerType = elementType;
+    std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lowerType == "boolean") return 1;
+    
+    size_t dotdotPos = lowerType.find("..");
+    if (dotdotPos != std::string::npos) {
+        if (lowerType.find('\'') != std::string::npos) return 0;
+        try {
+            int low = std::stoi(lowerType.substr(0, dotdotPos));
+            int high = std::stoi(lowerType.substr(dotdotPos + 2));
+            if (low < 0) return 0;
+            if (high < 2) return 1;
+            if (high < 4) return 2;
+            if (high < 16) return 4;
+        } catch (const std::exception&) {
+        }
+        return 0;
+    }
+    
+    // Named subrange types
+    if (symbolTable_) {
+        auto symbol = symbolTable_->lookup(elementType);
+        if (symbol && symbol->getSymbolType() == SymbolType::TYPE_DEF &&
+            !symbol->getTypeDefinition().empty() && symbol->getTypeDefinition() != elementType) {
+            return packedElementBits(symbol->getTypeDefinition());
         }
     }
+    return 0;
+}
+
+std::string CppGenerator::packedArrayType(const std::string& elementType, int count) {
+    unsigned bits = packedElementBits(elementType);
+    if (bits == 0 || count <= 0) return "";
+    return "PascalPackedArray<" + mapPascalTypeToCpp(elementType) + ", " + std::to_string(count) + ", " +
+           std::to_string(bits) + ">";
+}
+
+std::optional<CppGenerator::TypeLayout> CppGenerator::typeLayout(const std::string& pascalType) const {
+    // Library types are sized as in rpascal's own standard library, which
+    // the generated program is normally compiled against as well
+    struct FileLayout { std::fstream stream; std::string filename; };
+    std::string type = pascalType;
+    type.erase(0, type.find_first_not_of(" \t\n\r"));
+    type.erase(type.find_last_not_of(" \t\n\r") + 1);
+    std::string lowerType = type;
+    std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lowerType.empty()) return std::nullopt;
     
-    if (lowerType == "integer") return "int32_t";
-    if (lowerType == "real") return "double";
-    if (lowerType == "boolean") return "bool";
-    if (lowerType == "char") return "char";
-    if (lowerType == "byte") return "uint8_t";
-    if (lowerType == "string") return "std::string";
-    if (lowerType == "text") return "PascalFile";
-    if (lowerType == "file") return "PascalFile"; // Untyped file
+    if (lowerType[0] == '^') return TypeLayout{sizeof(void*), alignof(void*)};
     
-    // Handle bounded string types: string[30] -> std::string
-    if (lowerType.find("string[") == 0 && lowerType.find(']') != std::string::npos) {
-        return "std::string"; // For now, map bounded strings to std::string
+    bool packed = lowerType.rfind("packed ", 0) == 0;
+    if (packed) {
+        type.erase(0, 7);
+        lowerType.erase(0, 7);
+    }
+    if (lowerType.find("array of") != std::string::npos) {
+        return TypeLayout{sizeof(std::vector<int>), alignof(std::vector<int>)};
+    }
+    if (lowerType.rfind("array[", 0) == 0) {
+        size_t bracketEnd = type.find(']');
+        size_t ofPos = type.find(" of ", bracketEnd);
+        if (bracketEnd == std::string::npos || ofPos == std::string::npos) return std::nullopt;
+        int count = arrayElementCount(type.substr(6, bracketEnd - 6));
+        std::string elementType = type.substr(ofPos + 4);
+        if (count <= 0) return std::nullopt;
+        unsigned bits = packed ? packedElementBits(elementType) : 0;
+        if (bits) {
+            return TypeLayout{(static_cast<size_t>(count) * bits + 7) / 8, 1};
+        }
+        auto element = typeLayout(elementType);
+        if (!element) return std::nullopt;
+        return TypeLayout{element->size * count, element->align};
+    }
+    if (lowerType.find("..") != std::string::npos) {
+        if (lowerType.find('\'') != std::string::npos) return TypeLayout{1, 1};
+        size_t rangePos = lowerType.find("..");
+        try {
+            std::string storage = narrowestIntegerType(std::stoll(lowerType.substr(0, rangePos)),
+                                                       std::stoll(lowerType.substr(rangePos + 2)));
+            if (storage == "uint8_t" || storage == "int8_t") return TypeLayout{1, 1};
+            if (storage == "uint16_t" || storage == "int16_t") return TypeLayout{2, 2};
+        } catch (const std::exception&) {
+        }
+        return TypeLayout{sizeof(int), alignof(int)};
     }
     
-    // Handle typed files: file of T
-    if (lowerType.find("file of") == 0) {
-        std::string elementType = lowerType.substr(8); // Skip "file of "
-        elementType.erase(0, elementType.find_first_not_of(" \t\n\r")); // Trim leading whitespace
-        return "PascalTypedFile<" + mapPascalTypeToCpp(elementType) + ">";
+    if (lowerType == "integer") return TypeLayout{4, 4};
+    if (lowerType == "real" || lowerType == "double") return TypeLayout{sizeof(double), alignof(double)};
+    if (lowerType == "single") return TypeLayout{sizeof(float), alignof(float)};
+    if (lowerType == "extended") return TypeLayout{sizeof(long double), alignof(long double)};
+    if (lowerType == "comp") return TypeLayout{sizeof(int64_t), alignof(int64_t)};
+    if (lowerType == "boolean" || lowerType == "char" || lowerType == "byte") return TypeLayout{1, 1};
+    if (lowerType == "string" || lowerType.rfind("string[", 0) == 0) {
+        return TypeLayout{sizeof(std::string), alignof(std::string)};
+    }
+    if (lowerType.rfind("set of", 0) == 0) return TypeLayout{sizeof(std::set<int>), alignof(std::set<int>)};
+    if (lowerType == "text" || lowerType == "file" || lowerType.rfind("file of", 0) == 0) {
+        return TypeLayout{sizeof(FileLayout), alignof(FileLayout)};
     }
     
-    return pascalType; // fallback
+    // User-defined types
+    for (const auto& record : recordLayouts_) {
+        std::string lowerName = record.name;
+        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (lowerName == lowerType) {
+            if (!record.unknownField.empty()) return std::nullopt;
+            return TypeLayout{record.size, record.align};
+        }
+    }
+    auto enumIt = enumTypes_->find(type);
+    if (enumIt != enumTypes_->end()) {
+        std::string storage = narrowestIntegerType(0, enumIt->second.size() - 1);
+        if (storage == "uint8_t") return TypeLayout{1, 1};
+        if (storage == "uint16_t") return TypeLayout{2, 2};
+        return TypeLayout{sizeof(int), alignof(int)};
+    }
+    if (symbolTable_) {
+        auto symbol = symbolTable_->lookup(type);
+        if (symbol && symbol->getSymbolType() == SymbolType::TYPE_DEF &&
+            !symbol->getTypeDefinition().empty() && symbol->getTypeDefinition() != type) {
+            return typeLayout(symbol->getTypeDefinition());
+        }
+    }
+    return std::nullopt;
+}
+
+std::string CppGenerator::getLayoutReport() const {
+    std::ostringstream report;
+    report << "Record layouts (bytes)\n";
+    if (recordLayouts_.empty()) {
+        report << "  no record types\n";
+    }
+    for (const auto& record : recordLayouts_) {
+        report << "\n" << record.name << ": ";
+        if (!record.unknownField.empty()) {
+            report << "size unknown (field " << record.unknownField << ")\n";
+            continue;
+        }
+        report << "size " << record.size << ", align " << record.align << ", padding " << record.padding;
+        if (record.packed) {
+            report << ", packed";
+        } else if (record.packRequested) {
+            report << ", packed ignored (fields with constructors)";
+        }
+        report << "\n    offset    size  field\n";
+        size_t end = 0;
+        auto line = [&](size_t offset, size_t size, const std::string& text) {
+            report << std::setw(10) << offset << std::setw(8) << size << "  " << text << "\n";
+        };
+        for (const auto& field : record.fields) {
+            if (field.offset > end) {
+                line(end, field.offset - end, "(padding)");
+            }
+            line(field.offset, field.size, field.name + ": " + field.type + (field.variant ? "  [variant]" : ""));
+            end = std::max(end, field.offset + field.size);
+        }
+        if (record.size > end) {
+            line(end, record.size - end, "(padding)");
+        }
+    }
+    return report.str();
+}
+
+std::string CppGenerator::getVectorReport() const {
+    std::ostringstream report;
+    report << "Vectorization report\n";
+    if (vectorReport_.empty()) {
+        report << "  no for loops or numeric arrays\n";
+    }
+    for (const auto& line : vectorReport_) {
+        report << "  " << line << "\n";
+    }
+    return report.str();
 }
 
 std::string CppGenerator::mapPascalFunctionToCpp(const std::string& functionName) {
@@ -1820,124 +4616,139 @@ void CppGenerator::generateFunctionCall(CallExpression& node) {
             return;
         }
         // For overloaded functions, we need to resolve which one to call
-        // Build argument types for proper overload resolution
-        std::vector<DataType> argTypes;
-        std::vector<std::string> argTypeNames; // Store actual type names for custom types
+        std::vector<Expression*> arguments;
         for (const auto& arg : node.getArguments()) {
-            DataType argType = DataType::UNKNOWN;
-            std::string argTypeName;
-            
-            // Try to determine argument type
-            if (auto literal = dynamic_cast<LiteralExpression*>(arg.get())) {
-                // Handle literals
-                if (literal->getToken().getType() == TokenType::INTEGER_LITERAL) {
-                    argType = DataType::INTEGER;
-                } else if (literal->getToken().getType() == TokenType::REAL_LITERAL) {
-                    argType = DataType::REAL;
-                } else if (literal->getToken().getType() == TokenType::STRING_LITERAL) {
-                    argType = DataType::STRING;
-                } else if (literal->getToken().getType() == TokenType::CHAR_LITERAL) {
-                    argType = DataType::CHAR;
+            arguments.push_back(arg.get());
+        }
+        emit(resolveCallName(functionName, arguments) + "(");
+        
+        // Generate arguments
+        for (size_t i = 0; i < node.getArguments().size(); ++i) {
+            if (i > 0) emit(", ");
+            node.getArguments()[i]->accept(*this);
+        }
+        emit(")");
+    }
+}
+
+std::string CppGenerator::resolveCallName(const std::string& functionName, const std::vector<Expression*>& arguments) {
+    // Name of the overload a call resolves to, from its argument types
+    // Build argument types for proper overload resolution
+    std::vector<DataType> argTypes;
+    std::vector<std::string> argTypeNames; // Store actual type names for custom types
+    for (Expression* arg : arguments) {
+        DataType argType = DataType::UNKNOWN;
+        std::string argTypeName;
+        
+        // Try to determine argument type
+        if (auto literal = dynamic_cast<LiteralExpression*>(arg)) {
+            // Handle literals
+            if (literal->getToken().getType() == TokenType::INTEGER_LITERAL) {
+                argType = DataType::INTEGER;
+            } else if (literal->getToken().getType() == TokenType::REAL_LITERAL) {
+                argType = DataType::REAL;
+            } else if (literal->getToken().getType() == TokenType::STRING_LITERAL) {
+                argType = DataType::STRING;
+            } else if (literal->getToken().getType() == TokenType::CHAR_LITERAL) {
+                argType = DataType::CHAR;
+            }
+        } else if (auto identifier = dynamic_cast<IdentifierExpression*>(arg)) {
+            // Look up variable in symbol table
+            auto symbol = symbolTable_->lookup(identifier->getName());
+            if (symbol) {
+                argType = symbol->getDataType();
+                argTypeName = symbol->getTypeName();
+                // For CUSTOM types, check if it's a known enum type
+                if (argType == DataType::CUSTOM && !symbol->getTypeName().empty()) {
+                    // Keep CUSTOM but the type name will be used in mangling
+                    argType = DataType::CUSTOM;
                 }
-            } else if (auto identifier = dynamic_cast<IdentifierExpression*>(arg.get())) {
-                // Look up variable in symbol table
-                auto symbol = symbolTable_->lookup(identifier->getName());
-                if (symbol) {
-                    argType = symbol->getDataType();
-                    argTypeName = symbol->getTypeName();
-                    // For CUSTOM types, check if it's a known enum type
-                    if (argType == DataType::CUSTOM && !symbol->getTypeName().empty()) {
-                        // Keep CUSTOM but the type name will be used in mangling
-                        argType = DataType::CUSTOM;
-                    }
-                } else {
-                    // Check if it's a known enum constant
-                    if (isBuiltinConstant(identifier->getName())) {
-                        argType = DataType::INTEGER; // Enum constants are treated as integers
-                    }
+            } else {
+                // Check if it's a known enum constant
+                if (isBuiltinConstant(identifier->getName())) {
+                    argType = DataType::INTEGER; // Enum constants are treated as integers
                 }
-            } else if (auto arrayAccess = dynamic_cast<ArrayIndexExpression*>(arg.get())) {
-                // Handle array element access - need to determine element type
-                if (auto arrayIdentifier = dynamic_cast<IdentifierExpression*>(arrayAccess->getArray())) {
-                    auto arraySymbol = symbolTable_->lookup(arrayIdentifier->getName());
-                    if (arraySymbol) {
-                        // For arrays, we need to extract the element type from the array type
-                        std::string arrayTypeName = arraySymbol->getTypeName();
-                        if (arrayTypeName.find("array[") == 0) {
-                            // Extract element type from "array[...] of ElementType"
-                            size_t ofPos = arrayTypeName.find(" of ");
-                            if (ofPos != std::string::npos) {
-                                std::string elementTypeName = arrayTypeName.substr(ofPos + 4);
-                                argType = symbolTable_->resolveDataType(elementTypeName);
-                                argTypeName = elementTypeName; // Preserve the actual type name
-                            }
+            }
+        } else if (auto arrayAccess = dynamic_cast<ArrayIndexExpression*>(arg)) {
+            // Handle array element access - need to determine element type
+            if (auto arrayIdentifier = dynamic_cast<IdentifierExpression*>(arrayAccess->getArray())) {
+                auto arraySymbol = symbolTable_->lookup(arrayIdentifier->getName());
+                if (arraySymbol) {
+                    // For arrays, we need to extract the element type from the array type
+                    std::string arrayTypeName = arraySymbol->getTypeName();
+                    if (arrayTypeName.rfind("packed ", 0) == 0) {
+                        arrayTypeName.erase(0, 7);
+                    }
+                    if (arrayTypeName.find("array[") == 0) {
+                        // Extract element type from "array[...] of ElementType"
+                        size_t ofPos = arrayTypeName.find(" of ");
+                        if (ofPos != std::string::npos) {
+                            std::string elementTypeName = arrayTypeName.substr(ofPos + 4);
+                            argType = symbolTable_->resolveDataType(elementTypeName);
+                            argTypeName = elementTypeName; // Preserve the actual type name
                         }
                     }
                 }
             }
-            // TODO: Handle other expression types (array access, field access, etc.)
-            
-            argTypes.push_back(argType);
-            argTypeNames.push_back(argTypeName);
         }
+        // TODO: Handle other expression types (array access, field access, etc.)
         
-        // Try to find the matching function overload
-        auto functionSymbol = symbolTable_->lookupFunction(functionName, argTypes);
-        if (functionSymbol) {
-            // Build proper mangled name using argument type information
-            std::vector<std::unique_ptr<VariableDeclaration>> dummyParams;
+        argTypes.push_back(argType);
+        argTypeNames.push_back(argTypeName);
+    }
+    
+    // Try to find the matching function overload
+    auto functionSymbol = symbolTable_->lookupFunction(functionName, argTypes);
+    if (functionSymbol) {
+        // Build proper mangled name using argument type information
+        std::vector<std::unique_ptr<VariableDeclaration>> dummyParams;
+        
+        // Create dummy parameters based on the argument types and symbol information
+        for (size_t i = 0; i < argTypes.size(); ++i) {
+            std::string paramType;
             
-            // Create dummy parameters based on the argument types and symbol information
-            for (size_t i = 0; i < argTypes.size(); ++i) {
-                std::string paramType;
-                
-                // Use the preserved type name if available
-                if (i < argTypeNames.size() && !argTypeNames[i].empty()) {
-                    paramType = argTypeNames[i];
-                } else {
-                    // Try to get the actual type name from the argument if possible
-                    if (i < node.getArguments().size()) {
-                        if (auto identifier = dynamic_cast<IdentifierExpression*>(node.getArguments()[i].get())) {
-                            auto symbol = symbolTable_->lookup(identifier->getName());
-                            if (symbol && !symbol->getTypeName().empty()) {
-                                paramType = symbol->getTypeName();
-                            }
+            // Use the preserved type name if available. Other arguments take the
+            // declared parameter type, which can differ in precision or be an alias
+            if (i < argTypeNames.size() && !argTypeNames[i].empty() &&
+                (argTypes[i] == DataType::CUSTOM || functionSymbol->getParameterTypeName(i).empty())) {
+                paramType = argTypeNames[i];
+            } else if (!functionSymbol->getParameterTypeName(i).empty()) {
+                paramType = functionSymbol->getParameterTypeName(i);
+            } else {
+                // Try to get the actual type name from the argument if possible
+                if (i < arguments.size()) {
+                    if (auto identifier = dynamic_cast<IdentifierExpression*>(arguments[i])) {
+                        auto symbol = symbolTable_->lookup(identifier->getName());
+                        if (symbol && !symbol->getTypeName().empty()) {
+                            paramType = symbol->getTypeName();
                         }
                     }
                 }
-                
-                // Fallback to basic type mapping if we don't have the type name
-                if (paramType.empty()) {
-                    switch (argTypes[i]) {
-                        case DataType::INTEGER: paramType = "integer"; break;
-                        case DataType::REAL: paramType = "real"; break;
-                        case DataType::BOOLEAN: paramType = "boolean"; break;
-                        case DataType::CHAR: paramType = "char"; break;
-                        case DataType::STRING: paramType = "string"; break;
-                        case DataType::CUSTOM: paramType = "custom"; break;
-                        default: paramType = "unknown"; break;
-                    }
+            }
+            
+            // Fallback to basic type mapping if we don't have the type name
+            if (paramType.empty()) {
+                switch (argTypes[i]) {
+                    case DataType::INTEGER: paramType = "integer"; break;
+                    case DataType::REAL: paramType = "real"; break;
+                    case DataType::BOOLEAN: paramType = "boolean"; break;
+                    case DataType::CHAR: paramType = "char"; break;
+                    case DataType::STRING: paramType = "string"; break;
+                    case DataType::CUSTOM: paramType = "custom"; break;
+                    default: paramType = "unknown"; break;
                 }
-                
-                auto param = std::make_unique<VariableDeclaration>("dummy" + std::to_string(i), paramType, nullptr);
-                dummyParams.push_back(std::move(param));
             }
             
-            // Generate the proper mangled name using the same algorithm as function definitions
-            std::string mangledName = generateMangledFunctionName(functionName, dummyParams);
-            emit(mangledName + "(");
-        } else {
-            // Fallback to original name if no overload found
-            emit(functionName + "(");
+            auto param = std::make_unique<VariableDeclaration>("dummy" + std::to_string(i), paramType, nullptr);
+            dummyParams.push_back(std::move(param));
         }
         
-        // Generate arguments
-        for (size_t i = 0; i < node.getArguments().size(); ++i) {
-            if (i > 0) emit(", ");
-            node.getArguments()[i]->accept(*this);
-        }
-        emit(")");
+        // Generate the proper mangled name using the same algorithm as function definitions
+        return generateMangledFunctionName(functionName, dummyParams);
     }
+    
+    // Fallback to original name if no overload found
+    return cppIdentifier(functionName);
 }
 
 void CppGenerator::generateBuiltinCall(CallExpression& node, const std::string& functionName) {
@@ -1955,6 +4766,7 @@ void CppGenerator::generateBuiltinCall(CallExpression& node, const std::string&
     if (generateDateTimeFunctionCall(node, lowerName)) return;
     if (generateSystemFunctionCall(node, lowerName)) return;
     if (generateMemoryFunctionCall(node, lowerName)) return;
+    if (generateThreadFunctionCall(node, lowerName)) return;
     if (generateFileFunctionCall(node, lowerName)) return;
     
     // Default function call for unrecognized functions
@@ -1986,17 +4798,17 @@ bool CppGenerator::generateBasicIOCall(CallExpression& node, const std::string&
                                    symbol->getTypeName().find("File") != std::string::npos))) {
                         isFileOutput = true;
                         // Check if this is a typed file (PascalTypedFile)
-                        if (symbol->getDataType() == DataType::CUSTOM && 
-                            symbol->getTypeName().find("PascalTypedFile") != std::string::npos) {
+                        if (isTypedFileVariable(firstArg->getName())) {
                             // For typed files, use direct write method
-                            emit(firstArg->getName() + ".write(");
-                            if (node.getArguments().size() > 1) {
-                                node.getArguments()[1]->accept(*this);
+                            for (size_t i = 1; i < node.getArguments().size(); ++i) {
+                                if (i > 1) emit(", ");
+                                emit(cppIdentifier(firstArg->getName()) + ".write(");
+                                node.getArguments()[i]->accept(*this);
+                                emit(")");
                             }
-                            emit(")");
                             return true;
                         } else {
-                            outputTarget = firstArg->getName() + ".getStream()";
+                            outputTarget = cppIdentifier(firstArg->getName()) + ".getStream()";
                         }
                     }
                 }
@@ -2026,8 +4838,8 @@ bool CppGenerator::generateBasicIOCall(CallExpression& node, const std::string&
                                 // Check for named types in arrayTypes_ (for custom types)
                                 if (symbol->getDataType() == DataType::CUSTOM) {
                                     std::string typeName = symbol->getTypeName();
-                                    auto arrayTypeIt = arrayTypes_.find(typeName);
-                                    if (arrayTypeIt != arrayTypes_.end()) {
+                                    auto arrayTypeIt = arrayTypes_->find(typeName);
+                                    if (arrayTypeIt != arrayTypes_->end()) {
                                         const ArrayTypeInfo& info = arrayTypeIt->second;
                                         std::string lowerElementType = info.elementType;
                                         std::transform(lowerElementType.begin(), lowerElementType.end(), lowerElementType.begin(), 
@@ -2088,17 +4900,17 @@ bool CppGenerator::generateBasicIOCall(CallExpression& node, const std::string&
                                    symbol->getTypeName().find("File") != std::string::npos))) {
                         isFileOutput = true;
                         // Check if this is a typed file (PascalTypedFile)
-                        if (symbol->getDataType() == DataType::CUSTOM && 
-                            symbol->getTypeName().find("PascalTypedFile") != std::string::npos) {
+                        if (isTypedFileVariable(firstArg->getName())) {
                             // For typed files, use direct write method
-                            emit(firstArg->getName() + ".write(");
-                            if (node.getArguments().size() > 1) {
-                                node.getArguments()[1]->accept(*this);
+                            for (size_t i = 1; i < node.getArguments().size(); ++i) {
+                                if (i > 1) emit(", ");
+                                emit(cppIdentifier(firstArg->getName()) + ".write(");
+                                node.getArguments()[i]->accept(*this);
+                                emit(")");
                             }
-                            emit(")");
                             return true;
                         } else {
-                            outputTarget = firstArg->getName() + ".getStream()";
+                            outputTarget = cppIdentifier(firstArg->getName()) + ".getStream()";
                         }
                     }
                 }
@@ -2127,8 +4939,8 @@ bool CppGenerator::generateBasicIOCall(CallExpression& node, const std::string&
                         if (symbol) {
                             if (symbol->getDataType() == DataType::CUSTOM) {
                                 std::string typeName = symbol->getTypeName();
-                                auto arrayTypeIt = arrayTypes_.find(typeName);
-                                if (arrayTypeIt != arrayTypes_.end()) {
+                                auto arrayTypeIt = arrayTypes_->find(typeName);
+                                if (arrayTypeIt != arrayTypes_->end()) {
                                     const ArrayTypeInfo& info = arrayTypeIt->second;
                                     std::string lowerElementType = info.elementType;
                                     std::transform(lowerElementType.begin(), lowerElementType.end(), lowerElementType.begin(), 
@@ -2166,7 +4978,7 @@ bool CppGenerator::generateBasicIOCall(CallExpression& node, const std::string&
                                   (symbol->getDataType() == DataType::CUSTOM && 
                                    symbol->getTypeName().find("File") != std::string::npos))) {
                         isFileInput = true;
-                        inputSource = firstArg->getName() + ".getStream()";
+                        inputSource = cppIdentifier(firstArg->getName()) + ".getStream()";
                     }
                 }
             }
@@ -2199,6 +5011,21 @@ bool CppGenerator::generateBasicIOCall(CallExpression& node, const std::string&
         }
         return true;
     } else if (lowerName == "read") {
+        // Typed files read whole records: read(f, a, b) -> f.read(a), f.read(b)
+        if (node.getArguments().size() > 1) {
+            if (auto firstArg = dynamic_cast<IdentifierExpression*>(node.getArguments()[0].get())) {
+                if (isTypedFileVariable(firstArg->getName())) {
+                    for (size_t i = 1; i < node.getArguments().size(); ++i) {
+                        if (i > 1) emit(", ");
+                        emit(cppIdentifier(firstArg->getName()) + ".read(");
+                        node.getArguments()[i]->accept(*this);
+                        emit(")");
+                    }
+                    return true;
+                }
+            }
+        }
+        
         emit("std::cin");
         for (const auto& arg : node.getArguments()) {
             emit(" >> ");
@@ -2514,7 +5341,12 @@ bool CppGenerator::generateConversionFunctionCall(CallExpression& node, const st
         emit(")");
         return true;
     } else if (lowerName == "str") {
-        if (node.getArguments().size() >= 2) {
+        if (node.getArguments().size() >= 2 &&
+            dynamic_cast<FormattedExpression*>(node.getArguments()[0].get())) {
+            node.getArguments()[1]->accept(*this);
+            emit(" = ");
+            node.getArguments()[0]->accept(*this);
+        } else if (node.getArguments().size() >= 2) {
             node.getArguments()[1]->accept(*this);
             emit(" = std::to_string(");
             node.getArguments()[0]->accept(*this);
@@ -2664,37 +5496,75 @@ bool CppGenerator::generateSystemFunctionCall(CallExpression& node, const std::s
 }
 
 bool CppGenerator::generateMemoryFunctionCall(CallExpression& node, const std::string& lowerName) {
+    const auto& args = node.getArguments();
     if (lowerName == "new") {
-        if (!node.getArguments().empty()) {
-            node.getArguments()[0]->accept(*this);
-            emit(" = std::make_unique<std::remove_pointer_t<decltype(");
-            node.getArguments()[0]->accept(*this);
-            emit(")>>().release()");
+        if (!args.empty()) {
+            args[0]->accept(*this);
+            emit(" = ");
+            if (tracing_) {
+                emit("pascal_trace::allocated(");
+            }
+            if (heapStats_) {
+                emit("pascal_heap::create<std::remove_pointer_t<decltype(");
+                args[0]->accept(*this);
+                emit(")>>(");
+                emitHeapSite(node, args[0].get());
+                emit(")");
+            } else {
+                emit("std::make_unique<std::remove_pointer_t<decltype(");
+                args[0]->accept(*this);
+                emit(")>>().release()");
+            }
+            if (tracing_) {
+                emit(", sizeof(std::remove_pointer_t<decltype(");
+                args[0]->accept(*this);
+                emit(")>), \"New\")");
+            }
         }
         return true;
     } else if (lowerName == "dispose") {
-        if (!node.getArguments().empty()) {
-            emit("delete ");
-            node.getArguments()[0]->accept(*this);
-            emit("; ");
-            node.getArguments()[0]->accept(*this);
+        if (!args.empty()) {
+            emit(heapStats_ ? "pascal_heap::dispose(" : "delete ");
+            args[0]->accept(*this);
+            emit(heapStats_ ? "); " : "; ");
+            args[0]->accept(*this);
             emit(" = nullptr");
         }
         return true;
     } else if (lowerName == "getmem") {
-        if (node.getArguments().size() >= 2) {
-            node.getArguments()[0]->accept(*this);
-            emit(" = std::make_unique<uint8_t[]>(");
-            node.getArguments()[1]->accept(*this);
-            emit(").release()");
+        if (args.size() >= 2) {
+            args[0]->accept(*this);
+            emit(" = ");
+            // Traced builds name the size once so it is evaluated only once
+            if (tracing_) {
+                emit("[&](size_t pascal_bytes) { return pascal_trace::allocated(");
+            }
+            emit(heapStats_ ? "pascal_heap::getmem(" : "std::make_unique<uint8_t[]>(");
+            if (tracing_) {
+                emit("pascal_bytes");
+            } else {
+                args[1]->accept(*this);
+            }
+            if (heapStats_) {
+                emit(", ");
+                emitHeapSite(node, nullptr);
+                emit(")");
+            } else {
+                emit(").release()");
+            }
+            if (tracing_) {
+                emit(", pascal_bytes, \"GetMem\"); }(");
+                args[1]->accept(*this);
+                emit(")");
+            }
         }
         return true;
     } else if (lowerName == "freemem") {
-        if (!node.getArguments().empty()) {
-            emit("delete[] ");
-            node.getArguments()[0]->accept(*this);
-            emit("; ");
-            node.getArguments()[0]->accept(*this);
+        if (!args.empty()) {
+            emit(heapStats_ ? "pascal_heap::freemem(" : "delete[] ");
+            args[0]->accept(*this);
+            emit(heapStats_ ? "); " : "; ");
+            args[0]->accept(*this);
             emit(" = nullptr");
         }
         return true;
@@ -2702,37 +5572,121 @@ bool CppGenerator::generateMemoryFunctionCall(CallExpression& node, const std::s
     return false;
 }
 
-bool CppGenerator::generateFileFunctionCall(CallExpression& node, const std::string& lowerName) {
-    if (lowerName == "assign") {
-        if (node.getArguments().size() >= 2) {
-            node.getArguments()[0]->accept(*this);
-            emit(".assign(");
-            node.getArguments()[1]->accept(*this);
-            emit(")");
+bool CppGenerator::generateThreadFunctionCall(CallExpression& node, const std::string& lowerName) {
+    const auto& args = node.getArguments();
+    if (lowerName == "beginthread") {
+        // BeginThread(Proc) or BeginThread(Proc, Arg): the argument is evaluated
+        // now and passed by value to the procedure on the new thread
+        auto entry = args.empty() ? nullptr : dynamic_cast<IdentifierExpression*>(args[0].get());
+        if (!entry) {
+            emit("/* BeginThread needs a procedure name */ 0");
+            return true;
+        }
+        std::vector<Expression*> entryArgs;
+        if (args.size() > 1) {
+            entryArgs.push_back(args[1].get());
+        }
+        std::string entryName = resolveCallName(entry->getName(), entryArgs);
+        if (entryArgs.empty()) {
+            emit("pascal_threads::beginThread([]() { " + entryName + "(); })");
+        } else {
+            emit("pascal_threads::beginThread([pascal_thread_arg = ");
+            args[1]->accept(*this);
+            emit("]() { " + entryName + "(pascal_thread_arg); })");
         }
         return true;
-    } else if (lowerName == "reset") {
-        if (!node.getArguments().empty()) {
-            node.getArguments()[0]->accept(*this);
-            emit(".reset()");
+    } else if (lowerName == "waitforthread") {
+        emit("pascal_threads::waitForThread(");
+        if (!args.empty()) {
+            args[0]->accept(*this);
         }
+        emit(")");
         return true;
-    } else if (lowerName == "rewrite") {
-        if (!node.getArguments().empty()) {
-            node.getArguments()[0]->accept(*this);
-            emit(".rewrite()");
+    } else if (lowerName == "initcriticalsection" || lowerName == "donecriticalsection") {
+        // The mutex lives in the TCriticalSection variable itself
+        emit("static_cast<void>(0)");
+        return true;
+    } else if (lowerName == "entercriticalsection" || lowerName == "leavecriticalsection") {
+        if (!args.empty()) {
+            args[0]->accept(*this);
+            emit(lowerName == "entercriticalsection" ? ".mutex.lock()" : ".mutex.unlock()");
         }
         return true;
-    } else if (lowerName == "append") {
-        if (!node.getArguments().empty()) {
+    } else if (lowerName == "interlockedincrement" || lowerName == "interlockeddecrement" ||
+               lowerName == "interlockedexchange" || lowerName == "interlockedexchangeadd" ||
+               lowerName == "interlockedcompareexchange") {
+        static const std::map<std::string, std::string> operations = {
+            {"interlockedincrement", "increment"},
+            {"interlockeddecrement", "decrement"},
+            {"interlockedexchange", "exchange"},
+            {"interlockedexchangeadd", "exchangeAdd"},
+            {"interlockedcompareexchange", "compareExchange"}
+        };
+        emit("pascal_threads::" + operations.at(lowerName) + "(");
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (i > 0) emit(", ");
+            args[i]->accept(*this);
+        }
+        emit(")");
+        return true;
+    }
+    return false;
+}
+
+void CppGenerator::emitHeapSite(CallExpression& call, Expression* pointer) {
+    // A function-local static per call site, registered on first use
+    int line = call.getLocation().line;
+    if (line <= 1 && call.getCallee()) {
+        line = call.getCallee()->getLocation().line;
+    }
+    
+    // New names the pointee by its Pascal type when the pointer's type is known
+    std::string typeName = pointer ? "" : "GetMem";
+    if (auto identifier = dynamic_cast<IdentifierExpression*>(pointer)) {
+        if (auto symbol = symbolTable_ ? symbolTable_->lookup(identifier->getName()) : nullptr) {
+            std::string pointerType = symbol->getTypeName();
+            if (auto typeSymbol = symbolTable_->lookup(pointerType)) {
+                if (typeSymbol->getSymbolType() == SymbolType::TYPE_DEF) {
+                    pointerType = typeSymbol->getTypeDefinition();
+                }
+            }
+            if (!pointerType.empty() && pointerType[0] == '^') {
+                typeName = pointerType.substr(1);
+            }
+        }
+    }
+    
+    emit("[]() -> pascal_heap::Site& { static pascal_heap::Site site(");
+    if (typeName.empty()) {
+        emit("pascal_heap::typeName<std::remove_pointer_t<decltype(");
+        pointer->accept(*this);
+        emit(")>>()");
+    } else {
+        emit("\"" + escapeCppString(typeName) + "\"");
+    }
+    emit(", \"" + escapeCppString(sourceFile_) + "\", " + std::to_string(line) + "); return site; }()");
+}
+
+bool CppGenerator::generateFileFunctionCall(CallExpression& node, const std::string& lowerName) {
+    if (lowerName == "assign") {
+        if (node.getArguments().size() >= 2) {
             node.getArguments()[0]->accept(*this);
-            emit(".append()");
+            emit(".assign(");
+            node.getArguments()[1]->accept(*this);
+            emit(")");
         }
         return true;
-    } else if (lowerName == "close") {
+    } else if (lowerName == "reset" || lowerName == "rewrite" || lowerName == "append" || lowerName == "close") {
         if (!node.getArguments().empty()) {
-            node.getArguments()[0]->accept(*this);
-            emit(".close()");
+            if (tracing_) {
+                // Traced builds time the operation and record the file name
+                emit("pascal_trace::" + lowerName + "(");
+                node.getArguments()[0]->accept(*this);
+                emit(")");
+            } else {
+                node.getArguments()[0]->accept(*this);
+                emit("." + lowerName + "()");
+            }
         }
         return true;
     } else if (lowerName == "eof") {
@@ -2927,17 +5881,18 @@ std::string CppGenerator::generateParameterList(const std::vector<std::unique_pt
         // Handle parameter modes
         switch (parameters[i]->getParameterMode()) {
             case ParameterMode::VAR:
-                // var parameters are passed by reference
-                params << cppType << "& " << parameters[i]->getName();
+                // var parameters are passed by reference; restrict when the
+                // semantic pass proved no other name reaches the same array
+                params << cppType << (parameters[i]->isNoAlias() ? "& RPASCAL_RESTRICT " : "& ") << cppIdentifier(parameters[i]->getName());
                 break;
             case ParameterMode::CONST:
                 // const parameters are passed by const reference for efficiency
-                params << "const " << cppType << "& " << parameters[i]->getName();
+                params << "const " << cppType << "& " << cppIdentifier(parameters[i]->getName());
                 break;
             case ParameterMode::VALUE:
             default:
                 // value parameters are passed by value
-                params << cppType << " " << parameters[i]->getName();
+                params << cppType << " " << cppIdentifier(parameters[i]->getName());
                 break;
         }
     }
@@ -2948,7 +5903,7 @@ std::string CppGenerator::generateParameterList(const std::vector<std::unique_pt
 std::string CppGenerator::generateMangledFunctionName(const std::string& functionName, const std::vector<std::unique_ptr<VariableDeclaration>>& parameters) {
     // Generate a unique C++ function name based on Pascal function name and parameter types
     std::ostringstream mangledName;
-    mangledName << functionName;
+    mangledName << cppIdentifier(functionName);
     
     // Only add mangling if there are parameters (to avoid mangling simple functions)
     if (!parameters.empty()) {
@@ -3069,7 +6024,14 @@ bool CppGenerator::isBuiltinFunction(const std::string& name) {
            lowerName == "strrpos" || lowerName == "strlower" || lowerName == "strupper" ||
            lowerName == "strmove" || lowerName == "strnew" || lowerName == "strdispose" ||
            lowerName == "strpcopy" || lowerName == "strpas" || lowerName == "strscan" ||
-           lowerName == "strrscan";
+           lowerName == "strrscan" ||
+           // Threads unit functions
+           lowerName == "beginthread" || lowerName == "waitforthread" ||
+           lowerName == "initcriticalsection" || lowerName == "donecriticalsection" ||
+           lowerName == "entercriticalsection" || lowerName == "leavecriticalsection" ||
+           lowerName == "interlockedincrement" || lowerName == "interlockeddecrement" ||
+           lowerName == "interlockedexchange" || lowerName == "interlockedexchangeadd" ||
+           lowerName == "interlockedcompareexchange";
 }
 
 bool CppGenerator::isBuiltinConstant(const std::string& name) {
@@ -3130,11 +6092,32 @@ std::string CppGenerator::escapeCppString(const std::string& str) {
     return escaped;
 }
 
+std::string CppGenerator::cppIdentifier(const std::string& name) {
+    // C++20 keywords and alternative operator spellings. Keywords are lower
+    // case, so Pascal's other spellings (Double, CLASS) are already valid
+    static const std::unordered_set<std::string> reserved = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool",
+        "break", "case", "catch", "char", "char8_t", "char16_t", "char32_t", "class",
+        "compl", "concept", "const", "consteval", "constexpr", "constinit", "const_cast",
+        "continue", "co_await", "co_return", "co_yield", "decltype", "default", "delete",
+        "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern",
+        "false", "float", "for", "friend", "goto", "if", "inline", "int", "long",
+        "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator",
+        "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+        "requires", "return", "short", "signed", "sizeof", "static", "static_assert",
+        "static_cast", "struct", "switch", "template", "this", "thread_local", "throw",
+        "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using",
+        "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"
+    };
+    return reserved.count(name) ? "pas_" + name : name;
+}
+
 void CppGenerator::generateRecordDefinition(const std::string& typeName, const std::string& definition) {
     // Parse the record definition to extract field names and types
     // Example: "record x , y : integer ; end" -> struct with x, y fields
+    std::string cppTypeName = cppIdentifier(typeName);
     
-    emitLine("struct " + typeName + " {");
+    emitLine("struct " + cppTypeName + " {");
     increaseIndent();
     
     // Simple parsing: look for field declarations between 'record' and 'end'
@@ -3178,7 +6161,7 @@ void CppGenerator::generateRecordDefinition(const std::string& typeName, const s
                     
                     if (!fieldName.empty()) {
                         emitIndent();
-                        emitLine(mapPascalTypeToCpp(fieldType) + " " + fieldName + ";");
+                        emitLine(mapPascalTypeToCpp(fieldType) + " " + cppIdentifier(fieldName) + ";");
                     }
                 }
             }
@@ -3190,8 +6173,9 @@ void CppGenerator::generateRecordDefinition(const std::string& typeName, const s
     emitLine("");
 }
 
-void CppGenerator::generateArrayDefinition(const std::string& typeName, const std::string& definition) {
+void CppGenerator::generateArrayDefinition(const std::string& typeName, const std::string& definition, bool structOfArrays) {
     // Parse array definition: "array[1..5] of integer" or "array[1..3, 1..3] of real"
+    std::string cppTypeName = cppIdentifier(typeName);
     
     // Extract range and element type
     size_t arrayPos = definition.find("array[");
@@ -3233,8 +6217,8 @@ void CppGenerator::generateArrayDefinition(const std::string& typeName, const st
                 enumTypeName.erase(0, enumTypeName.find_first_not_of(" \t\n\r"));
                 enumTypeName.erase(enumTypeName.find_last_not_of(" \t\n\r") + 1);
                 
-                auto enumIt = enumTypes_.find(enumTypeName);
-                if (enumIt != enumTypes_.end()) {
+                auto enumIt = enumTypes_->find(enumTypeName);
+                if (enumIt != enumTypes_->end()) {
                     ArrayDimension dimension;
                     dimension.startIndex = 0; // Enums start at 0
                     dimension.endIndex = enumIt->second.size() - 1;
@@ -3303,25 +6287,106 @@ void CppGenerator::generateArrayDefinition(const std::string& typeName, const st
         
         if (allParsed && !info.dimensions.empty()) {
             // Store array type information
-            arrayTypes_[typeName] = info;
+            (*arrayTypes_)[typeName] = info;
             
-            std::string cppElementType = mapPascalTypeToCpp(elementType);
-            emitLine("using " + typeName + " = std::array<" + cppElementType + ", " + std::to_string(totalSize) + ">;");
+            std::string packedType;
+            if (definition.rfind("packed ", 0) == 0) {
+                packedType = packedArrayType(elementType, totalSize);
+            }
+            if (structOfArrays && generateStructOfArrays(typeName, elementType, totalSize)) {
+                // Indexing is the same as for std::array, so arrayTypes_ still applies
+            } else if (!packedType.empty()) {
+                emitLine("using " + cppTypeName + " = " + packedType + ";");
+            } else {
+                std::string cppElementType = mapPascalTypeToCpp(elementType);
+                emitLine("using " + cppTypeName + " = std::array<" + cppElementType + ", " + std::to_string(totalSize) + ">;");
+            }
             emitLine("");
         } else {
             // Fallback for unparseable dimensions
-            emitLine("// Array definition: " + typeName + " = " + definition);
-            emitLine("using " + typeName + " = int; // TODO: implement proper array type");
+            emitLine("// Array definition: " + cppTypeName + " = " + definition);
+            emitLine("using " + cppTypeName + " = int; // TODO: implement proper array type");
         }
     } else {
         // Malformed array definition
-        emitLine("// Array definition: " + typeName + " = " + definition);
-        emitLine("using " + typeName + " = int; // TODO: implement proper array type");
+        emitLine("// Array definition: " + cppTypeName + " = " + definition);
+        emitLine("using " + cppTypeName + " = int; // TODO: implement proper array type");
+    }
+}
+
+// {$SOA}: one std::array per record field. a[i] yields a proxy of references
+// to the element's fields, so a[i].x, with a[i] do and whole-element
+// assignment keep working while a loop over one field reads contiguous memory
+bool CppGenerator::generateStructOfArrays(const std::string& typeName, const std::string& elementType, int count) {
+    std::string cppTypeName = cppIdentifier(typeName);
+    std::string lowerElement = elementType;
+    std::transform(lowerElement.begin(), lowerElement.end(), lowerElement.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    auto recordIt = plainRecordFields_.find(lowerElement);
+    if (recordIt == plainRecordFields_.end() || recordIt->second.empty()) {
+        emitLine("// {$SOA} ignored: " + elementType + " is not a record without variant part");
+        return false;
+    }
+    const std::vector<RecordField>& fields = recordIt->second;
+    std::string size = std::to_string(count);
+    
+    // Proxy for one element, holding T& or const T& members
+    auto emitElement = [&](const std::string& name, bool isConst) {
+        emitIndent();
+        emitLine("struct " + name + " {");
+        increaseIndent();
+        for (const auto& field : fields) {
+            emitIndent();
+            emitLine(std::string(isConst ? "const " : "") + mapPascalTypeToCpp(field.getType()) + "& " + cppIdentifier(field.getName()) + ";");
+        }
+        emitIndent();
+        emit("operator " + cppIdentifier(elementType) + "() const { " + cppIdentifier(elementType) + " value;");
+        for (const auto& field : fields) {
+            std::string fieldName = cppIdentifier(field.getName());
+            emit(" value." + fieldName + " = " + fieldName + ";");
+        }
+        emitLine(" return value; }");
+        if (!isConst) {
+            emitIndent();
+            emit(name + "& operator=(const " + cppIdentifier(elementType) + "& value) {");
+            for (const auto& field : fields) {
+                std::string fieldName = cppIdentifier(field.getName());
+                emit(" " + fieldName + " = value." + fieldName + ";");
+            }
+            emitLine(" return *this; }");
+            emitIndent();
+            emitLine(name + "& operator=(const " + name + "& other) { return *this = static_cast<" + cppIdentifier(elementType) + ">(other); }");
+        }
+        decreaseIndent();
+        emitIndent();
+        emitLine("};");
+    };
+    
+    emitLine("// {$SOA} " + cppTypeName + ": " + elementType + " stored as one array per field");
+    emitLine("struct " + cppTypeName + " {");
+    increaseIndent();
+    for (const auto& field : fields) {
+        emitIndent();
+        emitLine("std::array<" + mapPascalTypeToCpp(field.getType()) + ", " + size + "> " + cppIdentifier(field.getName()) + ";");
     }
+    emitElement("pascal_element", false);
+    emitElement("pascal_const_element", true);
+    for (bool isConst : {false, true}) {
+        emitIndent();
+        emit(std::string(isConst ? "pascal_const_element" : "pascal_element") + " operator[](size_t i)" + (isConst ? " const" : "") + " { return {");
+        for (size_t f = 0; f < fields.size(); ++f) {
+            emit((f ? ", " : "") + cppIdentifier(fields[f].getName()) + "[i]");
+        }
+        emitLine("}; }");
+    }
+    decreaseIndent();
+    emitLine("};");
+    return true;
 }
 
 void CppGenerator::generateRangeDefinition(const std::string& typeName, const std::string& definition) {
     // Parse range definition: "1..10" or "'A'..'Z'" 
+    std::string cppTypeName = cppIdentifier(typeName);
     
     size_t dotdotPos = definition.find("..");
     if (dotdotPos != std::string::npos) {
@@ -3340,36 +6405,37 @@ void CppGenerator::generateRangeDefinition(const std::string& typeName, const st
             char startChar = startStr[1]; // Skip the quote
             char endChar = endStr[1];     // Skip the quote
             
-            emitLine("// Character range: " + typeName + " = " + definition);
-            emitLine("using " + typeName + " = char;");
-            emitLine("const char " + typeName + "_MIN = '" + std::string(1, startChar) + "';");
-            emitLine("const char " + typeName + "_MAX = '" + std::string(1, endChar) + "';");
+            emitLine("// Character range: " + cppTypeName + " = " + definition);
+            emitLine("using " + cppTypeName + " = char;");
+            emitLine("const char " + cppTypeName + "_MIN = '" + std::string(1, startChar) + "';");
+            emitLine("const char " + cppTypeName + "_MAX = '" + std::string(1, endChar) + "';");
         } else {
             // Numeric range: 1..10
             try {
                 int start = std::stoi(startStr);
                 int end = std::stoi(endStr);
                 
-                emitLine("// Numeric range: " + typeName + " = " + definition);
-                emitLine("using " + typeName + " = int;");
-                emitLine("const int " + typeName + "_MIN = " + std::to_string(start) + ";");
-                emitLine("const int " + typeName + "_MAX = " + std::to_string(end) + ";");
+                emitLine("// Numeric range: " + cppTypeName + " = " + definition);
+                emitLine("using " + cppTypeName + " = " + narrowestIntegerType(start, end) + ";");
+                emitLine("const int " + cppTypeName + "_MIN = " + std::to_string(start) + ";");
+                emitLine("const int " + cppTypeName + "_MAX = " + std::to_string(end) + ";");
             } catch (const std::exception&) {
                 // Fallback for non-numeric ranges
-                emitLine("// Range definition: " + typeName + " = " + definition);
-                emitLine("using " + typeName + " = int; // TODO: implement proper range type");
+                emitLine("// Range definition: " + cppTypeName + " = " + definition);
+                emitLine("using " + cppTypeName + " = int; // TODO: implement proper range type");
             }
         }
     } else {
         // Malformed range definition
-        emitLine("// Range definition: " + typeName + " = " + definition);
-        emitLine("using " + typeName + " = int; // TODO: implement proper range type");
+        emitLine("// Range definition: " + cppTypeName + " = " + definition);
+        emitLine("using " + cppTypeName + " = int; // TODO: implement proper range type");
     }
     emitLine("");
 }
 
 void CppGenerator::generateBoundedStringDefinition(const std::string& typeName, const std::string& definition) {
     // Parse bounded string definition: "string[10]" -> "using TShortString = BoundedString<10>;"
+    std::string cppTypeName = cppIdentifier(typeName);
     
     size_t bracketPos = definition.find("[");
     size_t endBracketPos = definition.find("]");
@@ -3384,8 +6450,8 @@ void CppGenerator::generateBoundedStringDefinition(const std::string& typeName,
         try {
             int size = std::stoi(sizeStr);
             
-            emitLine("// Bounded string: " + typeName + " = " + definition);
-            emitLine("class " + typeName + " {");
+            emitLine("// Bounded string: " + cppTypeName + " = " + definition);
+            emitLine("class " + cppTypeName + " {");
             increaseIndent();
             emitLine("private:");
             increaseIndent();
@@ -3394,94 +6460,95 @@ void CppGenerator::generateBoundedStringDefinition(const std::string& typeName,
             decreaseIndent();
             emitLine("public:");
             increaseIndent();
-            emitLine(typeName + "() = default;");
-            emitLine(typeName + "(const std::string& s) : data_(s.length() > MAX_LENGTH ? s.substr(0, MAX_LENGTH) : s) {}");
-            emitLine(typeName + "(const char* s) : data_(std::string(s).length() > MAX_LENGTH ? std::string(s).substr(0, MAX_LENGTH) : std::string(s)) {}");
+            emitLine(cppTypeName + "() = default;");
+            emitLine(cppTypeName + "(const std::string& s) : data_(s.length() > MAX_LENGTH ? s.substr(0, MAX_LENGTH) : s) {}");
+            emitLine(cppTypeName + "(const char* s) : data_(std::string(s).length() > MAX_LENGTH ? std::string(s).substr(0, MAX_LENGTH) : std::string(s)) {}");
             emitLine("");
             emitLine("operator std::string() const { return data_; }");
             emitLine("const std::string& str() const { return data_; }");
             emitLine("size_t length() const { return data_.length(); }");
             emitLine("");
-            emitLine(typeName + "& operator=(const std::string& s) {");
+            emitLine(cppTypeName + "& operator=(const std::string& s) {");
             increaseIndent();
             emitLine("data_ = s.length() > MAX_LENGTH ? s.substr(0, MAX_LENGTH) : s;");
             emitLine("return *this;");
             decreaseIndent();
             emitLine("}");
             emitLine("");
-            emitLine(typeName + "& operator=(const char* s) {");
+            emitLine(cppTypeName + "& operator=(const char* s) {");
             increaseIndent();
             emitLine("return *this = std::string(s);");
             decreaseIndent();
             emitLine("}");
             emitLine("");
             emitLine("// Concatenation operators");
-            emitLine("friend " + typeName + " operator+(const " + typeName + "& lhs, const " + typeName + "& rhs) {");
+            emitLine("friend " + cppTypeName + " operator+(const " + cppTypeName + "& lhs, const " + cppTypeName + "& rhs) {");
             increaseIndent();
-            emitLine("return " + typeName + "(lhs.data_ + rhs.data_);");
+            emitLine("return " + cppTypeName + "(lhs.data_ + rhs.data_);");
             decreaseIndent();
             emitLine("}");
             emitLine("");
-            emitLine("friend " + typeName + " operator+(const " + typeName + "& lhs, const std::string& rhs) {");
+            emitLine("friend " + cppTypeName + " operator+(const " + cppTypeName + "& lhs, const std::string& rhs) {");
             increaseIndent();
-            emitLine("return " + typeName + "(lhs.data_ + rhs);");
+            emitLine("return " + cppTypeName + "(lhs.data_ + rhs);");
             decreaseIndent();
             emitLine("}");
             emitLine("");
-            emitLine("friend " + typeName + " operator+(const std::string& lhs, const " + typeName + "& rhs) {");
+            emitLine("friend " + cppTypeName + " operator+(const std::string& lhs, const " + cppTypeName + "& rhs) {");
             increaseIndent();
-            emitLine("return " + typeName + "(lhs + rhs.data_);");
+            emitLine("return " + cppTypeName + "(lhs + rhs.data_);");
             decreaseIndent();
             emitLine("}");
             emitLine("");
-            emitLine("friend " + typeName + " operator+(const " + typeName + "& lhs, const char* rhs) {");
+            emitLine("friend " + cppTypeName + " operator+(const " + cppTypeName + "& lhs, const char* rhs) {");
             increaseIndent();
-            emitLine("return " + typeName + "(lhs.data_ + std::string(rhs));");
+            emitLine("return " + cppTypeName + "(lhs.data_ + std::string(rhs));");
             decreaseIndent();
             emitLine("}");
             emitLine("");
-            emitLine("friend " + typeName + " operator+(const char* lhs, const " + typeName + "& rhs) {");
+            emitLine("friend " + cppTypeName + " operator+(const char* lhs, const " + cppTypeName + "& rhs) {");
             increaseIndent();
-            emitLine("return " + typeName + "(std::string(lhs) + rhs.data_);");
+            emitLine("return " + cppTypeName + "(std::string(lhs) + rhs.data_);");
             decreaseIndent();
             emitLine("}");
             emitLine("");
             emitLine("// Character concatenation operators");
-            emitLine("friend " + typeName + " operator+(const " + typeName + "& lhs, char rhs) {");
+            emitLine("friend " + cppTypeName + " operator+(const " + cppTypeName + "& lhs, char rhs) {");
             increaseIndent();
-            emitLine("return " + typeName + "(lhs.data_ + rhs);");
+            emitLine("return " + cppTypeName + "(lhs.data_ + rhs);");
             decreaseIndent();
             emitLine("}");
             emitLine("");
-            emitLine("friend " + typeName + " operator+(char lhs, const " + typeName + "& rhs) {");
+            emitLine("friend " + cppTypeName + " operator+(char lhs, const " + cppTypeName + "& rhs) {");
             increaseIndent();
-            emitLine("return " + typeName + "(lhs + rhs.data_);");
+            emitLine("return " + cppTypeName + "(lhs + rhs.data_);");
             decreaseIndent();
             emitLine("}");
             decreaseIndent();
             emitLine("};");
             emitLine("");
-            emitLine("// Stream output operator for " + typeName);
-            emitLine("inline std::ostream& operator<<(std::ostream& os, const " + typeName + "& obj) {");
+            emitLine("// Stream output operator for " + cppTypeName);
+            emitLine("inline std::ostream& operator<<(std::ostream& os, const " + cppTypeName + "& obj) {");
             increaseIndent();
             emitLine("return os << obj.str();");
             decreaseIndent();
             emitLine("}");
         } catch (const std::exception&) {
             // Fallback for non-numeric sizes
-            emitLine("// Bounded string definition: " + typeName + " = " + definition);
-            emitLine("using " + typeName + " = std::string; // TODO: implement proper bounded string");
+            emitLine("// Bounded string definition: " + cppTypeName + " = " + definition);
+            emitLine("using " + cppTypeName + " = std::string; // TODO: implement proper bounded string");
         }
     } else {
         // Malformed bounded string definition
-        emitLine("// Bounded string definition: " + typeName + " = " + definition);
-        emitLine("using " + typeName + " = std::string; // TODO: implement proper bounded string");
+        emitLine("// Bounded string definition: " + cppTypeName + " = " + definition);
+        emitLine("using " + cppTypeName + " = std::string; // TODO: implement proper bounded string");
     }
     emitLine("");
 }
 
 void CppGenerator::generatePointerDefinition(const std::string& typeName, const std::string& definition) {
     // Parse pointer definition: "^integer" -> "using PInteger = int32_t*;"
+    std::string cppTypeName = cppIdentifier(typeName);
     if (!definition.empty() && definition[0] == '^') {
         std::string pointeeType = definition.substr(1); // Remove the '^' prefix
         
@@ -3495,7 +6562,7 @@ void CppGenerator::generatePointerDefinition(const std::string& typeName, const
         // Map the pointee type to C++ type
         std::string cppPointeeType = mapPascalTypeToCpp(pointeeType);
         
-        emitLine("// Pointer type definition: " + typeName + " = " + definition);
+        emitLine("// Pointer type definition: " + cppTypeName + " = " + definition);
         
         // Check if this pointee type looks like a Pascal record type (starts with capital)
         // and hasn't been mapped to a basic C++ type
@@ -3505,19 +6572,20 @@ void CppGenerator::generatePointerDefinition(const std::string& typeName, const
         
         if (needsForwardDecl) {
             emitLine("struct " + pointeeType + "; // Forward declaration");
-            emitLine("using " + typeName + " = " + pointeeType + "*;");
+            emitLine("using " + cppTypeName + " = " + pointeeType + "*;");
         } else {
-            emitLine("using " + typeName + " = " + cppPointeeType + "*;");
+            emitLine("using " + cppTypeName + " = " + cppPointeeType + "*;");
         }
     } else {
         emitLine("// Invalid pointer definition: " + definition);
-        emitLine("using " + typeName + " = void*;");
+        emitLine("using " + cppTypeName + " = void*;");
     }
     emitLine("");
 }
 
 void CppGenerator::generateSetDefinition(const std::string& typeName, const std::string& definition) {
     // Parse set definition: "set of char" -> "using TCharSet = std::set<char>;"
+    std::string cppTypeName = cppIdentifier(typeName);
     
     size_t setOfPos = definition.find("set of");
     if (setOfPos != std::string::npos) {
@@ -3528,23 +6596,30 @@ void CppGenerator::generateSetDefinition(const std::string& typeName, const std:
         elementType.erase(elementType.find_last_not_of(" \t\n\r") + 1);
         
         // Check if the element type is an enum - if so, use int for internal representation
-        if (enumTypes_.find(elementType) != enumTypes_.end()) {
-            emitLine("using " + typeName + " = std::set<int>; // Set of enum " + elementType);
+        std::string lowerElementType = elementType;
+        std::transform(lowerElementType.begin(), lowerElementType.end(), lowerElementType.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (enumTypes_->find(elementType) != enumTypes_->end()) {
+            emitLine("using " + cppTypeName + " = std::set<int>; // Set of enum " + elementType);
+        } else if (lowerElementType != "byte" && isNarrowOrdinal(elementType)) {
+            // Subranges are stored narrow elsewhere, but set literals hold int
+            emitLine("using " + cppTypeName + " = std::set<int>; // Set of subrange " + elementType);
         } else {
             std::string cppElementType = mapPascalTypeToCpp(elementType);
-            emitLine("using " + typeName + " = std::set<" + cppElementType + ">;");
+            emitLine("using " + cppTypeName + " = std::set<" + cppElementType + ">;");
         }
         emitLine("");
     } else {
         // Malformed set definition
-        emitLine("// Set definition: " + typeName + " = " + definition);
-        emitLine("using " + typeName + " = std::set<int>; // TODO: implement proper set type");
+        emitLine("// Set definition: " + cppTypeName + " = " + definition);
+        emitLine("using " + cppTypeName + " = std::set<int>; // TODO: implement proper set type");
         emitLine("");
     }
 }
 
 void CppGenerator::generateEnumDefinition(const std::string& typeName, const std::string& definition) {
     // Parse enumeration definition: "(Red, Green, Blue)"
+    std::string cppTypeName = cppIdentifier(typeName);
     
     if (definition.length() > 2 && definition[0] == '(' && definition.back() == ')') {
         std::string enumValues = definition.substr(1, definition.length() - 2); // Remove parentheses
@@ -3552,8 +6627,12 @@ void CppGenerator::generateEnumDefinition(const std::string& typeName, const std
         // Store enum information for array indexing
         EnumTypeInfo enumInfo;
         
-        emitLine("// Enumeration: " + typeName + " = " + definition);
-        emitLine("enum class " + typeName + " {");
+        // Smallest underlying type that holds every ordinal
+        size_t valueCount = std::count(enumValues.begin(), enumValues.end(), ',') + 1;
+        std::string underlying = narrowestIntegerType(0, static_cast<long long>(valueCount) - 1);
+        
+        emitLine("// Enumeration: " + cppTypeName + " = " + definition);
+        emitLine("enum class " + cppTypeName + (underlying == "int" ? "" : " : " + underlying) + " {");
         increaseIndent();
         
         // Parse individual enum values
@@ -3583,7 +6662,7 @@ void CppGenerator::generateEnumDefinition(const std::string& typeName, const std
                     emitLine("");
                 }
                 emitIndent();
-                emit(enumValue + " = " + std::to_string(enumOrdinal));
+                emit(cppIdentifier(enumValue) + " = " + std::to_string(enumOrdinal));
                 firstValue = false;
                 enumOrdinal++;
             }
@@ -3596,7 +6675,7 @@ void CppGenerator::generateEnumDefinition(const std::string& typeName, const std
         emitLine("};");
         
         // Store enum information
-        enumTypes_[typeName] = enumInfo;
+        (*enumTypes_)[typeName] = enumInfo;
         
         // Generate constants for the enum values to use in Pascal code
         emitLine("");
@@ -3609,18 +6688,19 @@ void CppGenerator::generateEnumDefinition(const std::string& typeName, const std
                 emitLine("#undef Rectangle");
                 emitLine("#endif");
             }
-            emitLine("const " + typeName + " " + enumValue + " = " + typeName + "::" + enumValue + ";");
+            emitLine("const " + cppTypeName + " " + cppIdentifier(enumValue) + " = " + cppTypeName + "::" + cppIdentifier(enumValue) + ";");
         }
     } else {
         // Malformed enum definition
-        emitLine("// Enum definition: " + typeName + " = " + definition);
-        emitLine("using " + typeName + " = int; // TODO: implement proper enum type");
+        emitLine("// Enum definition: " + cppTypeName + " = " + definition);
+        emitLine("using " + cppTypeName + " = int; // TODO: implement proper enum type");
     }
     emitLine("");
 }
 
 void CppGenerator::generateFileDefinition(const std::string& typeName, const std::string& definition) {
     // Parse file definition: "file of integer", "file of real", etc.
+    std::string cppTypeName = cppIdentifier(typeName);
     
     if (definition.find("file of") == 0) {
         std::string elementType = definition.substr(8); // Skip "file of "
@@ -3628,12 +6708,12 @@ void CppGenerator::generateFileDefinition(const std::string& typeName, const std
         
         std::string cppElementType = mapPascalTypeToCpp(elementType);
         
-        emitLine("// File type: " + typeName + " = " + definition);
-        emitLine("using " + typeName + " = PascalTypedFile<" + cppElementType + ">;");
+        emitLine("// File type: " + cppTypeName + " = " + definition);
+        emitLine("using " + cppTypeName + " = PascalTypedFile<" + cppElementType + ">;");
     } else {
         // Fallback for malformed file definitions
-        emitLine("// File definition: " + typeName + " = " + definition);
-        emitLine("using " + typeName + " = PascalFile; // Fallback to untyped file");
+        emitLine("// File definition: " + cppTypeName + " = " + definition);
+        emitLine("using " + cppTypeName + " = PascalFile; // Fallback to untyped file");
     }
     emitLine("");
 }
@@ -3642,59 +6722,102 @@ void CppGenerator::visit(UsesClause& node) {
     // Generate include statements for units
     emitLine("// Uses clause");
     for (const std::string& unitName : node.getUnits()) {
-        if (unitName == "System") {
-            // System unit is automatically included via our built-in functions
-            emitLine("// System unit functions automatically available");
-        } else if (unitName == "Dos") {
-            emitLine("#include <filesystem>  // DOS unit support");
-            emitLine("#include <chrono>      // Date/time functions");
-        } else if (unitName == "Crt") {
-            emitLine("#ifdef _WIN32");
-            emitLine("#include <conio.h>     // CRT unit support (Windows)");
-            // Only include windows.h if we need console functions that aren't in conio.h
-            emitLine("#include <windows.h>   // Console API");
-            emitLine("#ifdef Rectangle");
-            emitLine("#undef Rectangle       // Avoid conflict with Pascal Rectangle identifier");
-            emitLine("#endif");
-            emitLine("#else");
-            emitLine("#include <unistd.h>");
-            emitLine("#include <termios.h>");
-            emitLine("#endif");
-        } else if (unitName == "strings") {
-            emitLine("// strings unit functions available via runtime functions");
-        } else {
-            // Generate C++ code for custom units
-            if (unitLoader_ && unitLoader_->isUnitLoaded(unitName)) {
-                emitLine("// Unit: " + unitName);
-                Unit* loadedUnit = unitLoader_->getLoadedUnit(unitName);
-                if (loadedUnit) {
-                    emitLine("// Interface declarations");
-                    // Generate interface declarations
-                    for (const auto& decl : loadedUnit->getInterfaceDeclarations()) {
-                        // For function/procedure declarations in interfaces, generate prototypes
-                        if (auto funcDecl = dynamic_cast<FunctionDeclaration*>(decl.get())) {
-                            std::string returnType = mapPascalTypeToCpp(funcDecl->getReturnType());
-                            emitLine(returnType + " " + funcDecl->getName() + "(" + generateParameterList(funcDecl->getParameters()) + ");");
-                        } else if (auto procDecl = dynamic_cast<ProcedureDeclaration*>(decl.get())) {
-                            emitLine("void " + procDecl->getName() + "(" + generateParameterList(procDecl->getParameters()) + ");");
-                        } else {
-                            // For other declarations (types, constants, variables), use normal generation
-                            decl->accept(*this);
-                        }
-                    }
-                    
-                    emitLine("// Implementation");
-                    // Generate implementation declarations (function/procedure bodies)
-                    for (const auto& decl : loadedUnit->getImplementationDeclarations()) {
+        emitUsedUnit(unitName);
+    }
+    emitLine("");
+}
+
+void CppGenerator::emitUsedUnit(const std::string& unitName) {
+    // Unit names are case-insensitive, as in UnitLoader
+    std::string lowerName = unitName;
+    std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    // Each unit is emitted once, after the units its interface uses
+    if (!emittedUnits_.insert(lowerName).second) {
+        return;
+    }
+    Unit* usedUnit = unitLoader_ ? unitLoader_->getLoadedUnit(unitName) : nullptr;
+    if (usedUnit && usedUnit->getUsesClause()) {
+        for (const std::string& dependency : usedUnit->getUsesClause()->getUnits()) {
+            emitUsedUnit(dependency);
+        }
+    }
+    
+    if (lowerName == "system") {
+        // System unit is automatically included via our built-in functions
+        emitLine("// System unit functions automatically available");
+    } else if (lowerName == "dos") {
+        emitLine("#include <filesystem>  // DOS unit support");
+        emitLine("#include <chrono>      // Date/time functions");
+    } else if (lowerName == "crt") {
+        emitLine("#ifdef _WIN32");
+        emitLine("#include <conio.h>     // CRT unit support (Windows)");
+        // Only include windows.h if we need console functions that aren't in conio.h
+        emitLine("#include <windows.h>   // Console API");
+        emitLine("#ifdef Rectangle");
+        emitLine("#undef Rectangle       // Avoid conflict with Pascal Rectangle identifier");
+        emitLine("#endif");
+        emitLine("#else");
+        emitLine("#include <unistd.h>");
+        emitLine("#include <termios.h>");
+        emitLine("#endif");
+    } else if (lowerName == "threads") {
+        emitLine("// Threads unit support (pascal_threads runtime)");
+        emitLine("using TCriticalSection = pascal_threads::CriticalSection;");
+    } else if (lowerName == "strings") {
+        emitLine("// strings unit functions available via runtime functions");
+    } else if (separateUnits_) {
+        // Separately compiled unit: include its generated header
+        emitLine("#include \"" + unitHeaderName(unitName) + "\"");
+        
+        // Visit the interface into a scratch buffer so type information
+        // (arrays, enums, records) is known when generating this file
+        if (usedUnit) {
+            size_t mark = output_.size();
+            size_t reportMark = vectorReport_.size();
+            for (const auto& decl : usedUnit->getInterfaceDeclarations()) {
+                if (!dynamic_cast<FunctionDeclaration*>(decl.get()) &&
+                    !dynamic_cast<ProcedureDeclaration*>(decl.get())) {
+                    decl->accept(*this);
+                }
+            }
+            output_.truncate(mark);
+            vectorReport_.resize(reportMark);
+        }
+    } else {
+        // Generate C++ code for custom units
+        if (unitLoader_ && unitLoader_->isUnitLoaded(unitName)) {
+            emitLine("// Unit: " + unitName);
+            Unit* loadedUnit = unitLoader_->getLoadedUnit(unitName);
+            if (loadedUnit) {
+                emitLine("// Interface declarations");
+                // Generate interface declarations
+                for (const auto& decl : loadedUnit->getInterfaceDeclarations()) {
+                    // For function/procedure declarations in interfaces, generate prototypes
+                    if (auto funcDecl = dynamic_cast<FunctionDeclaration*>(decl.get())) {
+                        std::string returnType = mapPascalTypeToCpp(funcDecl->getReturnType());
+                        emitLine(returnType + " " + cppIdentifier(funcDecl->getName()) + "(" + generateParameterList(funcDecl->getParameters()) + ");");
+                    } else if (auto procDecl = dynamic_cast<ProcedureDeclaration*>(decl.get())) {
+                        emitLine("void " + cppIdentifier(procDecl->getName()) + "(" + generateParameterList(procDecl->getParameters()) + ");");
+                    } else {
+                        // For other declarations (types, constants, variables), use normal generation
                         decl->accept(*this);
                     }
                 }
-            } else {
-                emitLine("// TODO: Include unit " + unitName);
+                
+                emitLine("// Implementation");
+                // Generate implementation declarations (function/procedure bodies)
+                std::string programFile = sourceFile_;
+                sourceFile_ = unitLoader_->getUnitFile(unitName);
+                for (const auto& decl : loadedUnit->getImplementationDeclarations()) {
+                    decl->accept(*this);
+                }
+                sourceFile_ = programFile;
             }
+        } else {
+            emitLine("// TODO: Include unit " + unitName);
         }
     }
-    emitLine("");
 }
 
 void CppGenerator::visit(Unit& node) {
@@ -3711,11 +6834,22 @@ void CppGenerator::visit(Unit& node) {
     emitLine("");
     emitLine("// Implementation declarations");
     
+    // Statements below come from the unit's own source file
+    std::string programFile = sourceFile_;
+    if (unitLoader_) {
+        sourceFile_ = unitLoader_->getUnitFile(node.getName());
+    }
+    
     // Generate implementation section
     for (const auto& decl : node.getImplementationDeclarations()) {
         decl->accept(*this);
     }
     
+    emitUnitInitialization(node);
+    sourceFile_ = programFile;
+}
+
+void CppGenerator::emitUnitInitialization(Unit& node) {
     // Generate initialization code if present
     if (node.getInitializationBlock()) {
         emitLine("");
@@ -0,0 +1,64 @@
+#include "../include/output_buffer.h"
+#include <algorithm>
+
+namespace rpascal {
+
+std::string& OutputBuffer::writableChunk() {
+    if (chunks_.empty() || chunks_.back().size() == CHUNK_SIZE) {
+        chunks_.emplace_back();
+        chunks_.back().reserve(CHUNK_SIZE);
+    }
+    return chunks_.back();
+}
+
+void OutputBuffer::append(std::string_view text) {
+    size_ += text.size();
+    lines_ += static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+    while (!text.empty()) {
+        std::string& chunk = writableChunk();
+        size_t count = std::min(text.size(), CHUNK_SIZE - chunk.size());
+        chunk.append(text.data(), count);
+        text.remove_prefix(count);
+    }
+}
+
+void OutputBuffer::append(char c) {
+    writableChunk().push_back(c);
+    ++size_;
+    if (c == '\n') {
+        ++lines_;
+    }
+}
+
+void OutputBuffer::truncate(size_t newSize) {
+    while (size_ > newSize) {
+        std::string& chunk = chunks_.back();
+        size_t excess = size_ - newSize;
+        if (excess >= chunk.size()) {
+            lines_ -= static_cast<size_t>(std::count(chunk.begin(), chunk.end(), '\n'));
+            size_ -= chunk.size();
+            chunks_.pop_back();
+        } else {
+            lines_ -= static_cast<size_t>(std::count(chunk.end() - static_cast<std::ptrdiff_t>(excess), chunk.end(), '\n'));
+            chunk.resize(chunk.size() - excess);
+            size_ = newSize;
+        }
+    }
+}
+
+void OutputBuffer::clear() {
+    chunks_.clear();
+    size_ = 0;
+    lines_ = 0;
+}
+
+std::string OutputBuffer::str() const {
+    std::string result;
+    result.reserve(size_);
+    for (const auto& chunk : chunks_) {
+        result += chunk;
+    }
+    return result;
+}
+
+} // namespace rpascal
@@ -5,9 +5,31 @@
 namespace rpascal {
 
 Lexer::Lexer(const std::string& source) 
-    : source_(source), current_(0), line_(1), column_(1), lineStart_(0) {}
+    : source_(source), current_(0), line_(1), column_(1), lineStart_(0),
+      replaying_(false), replayIndex_(0) {}
+
+Lexer::Lexer(std::vector<Token> tokens)
+    : current_(0), line_(1), column_(1), lineStart_(0),
+      replaying_(true), replayTokens_(std::move(tokens)), replayIndex_(0) {}
+
+std::vector<Token> Lexer::tokenizeAll() {
+    std::vector<Token> tokens;
+    Token token;
+    do {
+        token = nextToken();
+        tokens.push_back(token);
+    } while (token.getType() != TokenType::EOF_TOKEN);
+    return tokens;
+}
 
 Token Lexer::nextToken() {
+    if (replaying_) {
+        if (replayIndex_ < replayTokens_.size()) {
+            return replayTokens_[replayIndex_++];
+        }
+        return Token(TokenType::EOF_TOKEN, "", SourceLocation());
+    }
+    
     skipWhitespace();
     
     if (isAtEnd()) {
@@ -103,6 +125,13 @@ Token Lexer::nextToken() {
 }
 
 Token Lexer::peekToken() {
+    if (replaying_) {
+        if (replayIndex_ < replayTokens_.size()) {
+            return replayTokens_[replayIndex_];
+        }
+        return Token(TokenType::EOF_TOKEN, "", SourceLocation());
+    }
+    
     size_t savedCurrent = current_;
     size_t savedLine = line_;
     size_t savedColumn = column_;
@@ -119,6 +148,9 @@ Token Lexer::peekToken() {
 }
 
 bool Lexer::isAtEnd() const {
+    if (replaying_) {
+        return replayIndex_ >= replayTokens_.size();
+    }
     return current_ >= source_.length();
 }
 
@@ -292,6 +324,21 @@ Token Lexer::parseCharLiteral() {
 }
 
 Token Lexer::parseComment() {
+    // {$NAME ...} is a compiler directive rather than a comment
+    if (peek() == '$') {
+        SourceLocation startLocation = makeLocation();
+        advance(); // consume '$'
+        std::string text;
+        while (!isAtEnd() && peek() != '}') {
+            text += advance();
+        }
+        if (isAtEnd()) {
+            addError("Unterminated directive");
+        } else {
+            advance(); // consume '}'
+        }
+        return Token(TokenType::DIRECTIVE, text, startLocation);
+    }
     skipBlockComment();
     return nextToken(); // Get the next real token
 }
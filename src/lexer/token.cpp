@@ -12,6 +12,7 @@ const std::unordered_map<std::string, TokenType> Keywords::keywords_ = {
     {"const", TokenType::CONST},
     {"type", TokenType::TYPE},
     {"var", TokenType::VAR},
+    {"threadvar", TokenType::THREADVAR},
     {"procedure", TokenType::PROCEDURE},
     {"function", TokenType::FUNCTION},
     {"begin", TokenType::BEGIN},
@@ -104,6 +105,7 @@ std::string Token::tokenTypeToString(TokenType type) {
         case TokenType::CONST: return "CONST";
         case TokenType::TYPE: return "TYPE";
         case TokenType::VAR: return "VAR";
+        case TokenType::THREADVAR: return "THREADVAR";
         case TokenType::PROCEDURE: return "PROCEDURE";
         case TokenType::FUNCTION: return "FUNCTION";
         case TokenType::BEGIN: return "BEGIN";
@@ -179,6 +181,7 @@ std::string Token::tokenTypeToString(TokenType type) {
         case TokenType::NEWLINE: return "NEWLINE";
         case TokenType::WHITESPACE: return "WHITESPACE";
         case TokenType::COMMENT: return "COMMENT";
+        case TokenType::DIRECTIVE: return "DIRECTIVE";
         case TokenType::INVALID: return "INVALID";
         default: return "UNKNOWN";
     }
@@ -4,6 +4,8 @@
 #include "../include/symbol_table.h"
 #include "../include/type_checker.h"
 #include "../include/cpp_generator.h"
+#include "../include/unit_cache.h"
+#include "../include/parallel.h"
 #include <algorithm>
 #include <iostream>
 #include <fstream>
@@ -15,6 +17,11 @@
 #include <cstdlib>
 #include <thread>
 #include <chrono>
+#include <map>
+#include <mutex>
+#include <functional>
+#include <set>
+#include <atomic>
 #ifdef _WIN32
 #include <windows.h>
 #include <shellapi.h>
@@ -32,6 +39,23 @@ struct CompilerOptions {
     bool showAST = false;
     bool helpRequested = false;
     bool keepCpp = false;        // Keep C++ file after compilation
+    bool useUnitCache = true;    // Read/write precompiled .rpu unit files
+    std::string buildDir;        // Project directory for --build mode
+    std::vector<std::string> unitPaths;  // Explicit unit search paths (-I)
+    bool writeDepfile = false;   // Emit a Make-style dependency file (-MD)
+    std::string depFile;         // Dependency file path (-MF, default <output>.d)
+    std::string compilerExecutable;  // argv[0], used to locate the built-in runtime
+    bool debugInfo = false;      // Build with debug info (-g)
+    bool lineDirectives = true;  // Map generated C++ back to Pascal lines when debugInfo is set
+    bool profile = false;        // Instrument routines and write a profile at exit
+    bool trace = false;          // Record a Chrome trace of routines, file I/O and large allocations
+    bool sampleProfile = false;  // Sample the running program with SIGPROF (implies debugInfo)
+    bool heapStats = false;      // Account New/GetMem per type and site, report leaks at exit
+    bool layoutReport = false;   // Print size, alignment and padding of every record type
+    bool vecReport = false;      // Print which for loops were annotated for vectorisation
+    bool autoParallel = false;   // Run outer for loops with independent iterations on the thread pool
+    bool parReport = false;      // Print which for loops --auto-parallel considered and the outcome
+    size_t localHeapThreshold = CppGenerator::DEFAULT_LOCAL_HEAP_THRESHOLD;  // Larger locals go to the frame arena
 };
 
 // Function to display help information
@@ -48,6 +72,23 @@ void showHelp(const std::string& programName) {
     std::cout << "  -v            Verbose output\n";
     std::cout << "  --tokens      Show tokenization output\n";
     std::cout << "  --ast         Show Abstract Syntax Tree\n";
+    std::cout << "  --no-unit-cache  Do not read or write precompiled .rpu unit files\n";
+    std::cout << "  -I <dir>, --unit-path <dir>  Search <dir> for units (repeatable; replaces the default search paths)\n";
+    std::cout << "  -MD           Write a Make-style dependency file (<output>.d)\n";
+    std::cout << "  -MF <file>    Write the dependency file to <file> (implies -MD)\n";
+    std::cout << "  --build <dir> Compile every unit and program in <dir>, rebuilding only stale files\n";
+    std::cout << "  -g            Build with debug info; debuggers and C++ diagnostics show Pascal source lines\n";
+    std::cout << "  --no-line-directives  With -g, debug the generated C++ instead of the Pascal source\n";
+    std::cout << "  --profile     Instrument procedures/functions; the program writes a profile report on exit\n";
+    std::cout << "  --trace       Record routine calls, file I/O and large allocations; the program writes a Chrome trace on exit\n";
+    std::cout << "  --sample-profile  Build with -g and a SIGPROF sampling profiler that reports Pascal lines on exit\n";
+    std::cout << "  --heap-stats  Count New/GetMem per type and source line; the program reports peak use and leaks on exit\n";
+    std::cout << "  --layout-report  Print size, alignment, field offsets and padding of every record type\n";
+    std::cout << "  --vec-report  Print which for loops were annotated with #pragma omp simd (and why not), aligned arrays and __restrict parameters\n";
+    std::cout << "  --auto-parallel  Run outer for loops whose iterations are provably independent as parallel loops\n";
+    std::cout << "  --par-report  Print which outer for loops --auto-parallel parallelised, and why the others were not\n";
+    std::cout << "  --local-heap-threshold <bytes>  Place local variables larger than <bytes> in a per-thread arena instead of on the stack (default "
+              << CppGenerator::DEFAULT_LOCAL_HEAP_THRESHOLD << ", 0 keeps all locals on the stack)\n";
     std::cout << "  -h, --help    Show this help message\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << programName << " hello.pas                    # Generates hello"
@@ -75,6 +116,7 @@ void showHelp(const std::string& programName) {
 // Parse command line arguments
 CompilerOptions parseArguments(int argc, char* argv[]) {
     CompilerOptions options;
+    options.compilerExecutable = argv[0];
     
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -90,6 +132,49 @@ CompilerOptions parseArguments(int argc, char* argv[]) {
             options.showTokens = true;
         } else if (arg == "--ast") {
             options.showAST = true;
+        } else if (arg == "--no-unit-cache") {
+            options.useUnitCache = false;
+        } else if ((arg == "-I" || arg == "--unit-path") && i + 1 < argc) {
+            options.unitPaths.push_back(argv[++i]);
+        } else if (arg.size() > 2 && arg.compare(0, 2, "-I") == 0) {
+            options.unitPaths.push_back(arg.substr(2));
+        } else if (arg == "-MD") {
+            options.writeDepfile = true;
+        } else if (arg == "-MF" && i + 1 < argc) {
+            options.writeDepfile = true;
+            options.depFile = argv[++i];
+        } else if (arg == "-g") {
+            options.debugInfo = true;
+        } else if (arg == "--no-line-directives") {
+            options.lineDirectives = false;
+        } else if (arg == "--profile") {
+            options.profile = true;
+        } else if (arg == "--trace") {
+            options.trace = true;
+        } else if (arg == "--heap-stats") {
+            options.heapStats = true;
+        } else if (arg == "--layout-report") {
+            options.layoutReport = true;
+        } else if (arg == "--vec-report") {
+            options.vecReport = true;
+        } else if (arg == "--auto-parallel") {
+            options.autoParallel = true;
+        } else if (arg == "--par-report") {
+            options.parReport = true;
+        } else if (arg == "--local-heap-threshold" && i + 1 < argc) {
+            try {
+                options.localHeapThreshold = std::stoull(argv[++i]);
+            } catch (const std::exception&) {
+                std::cerr << "Error: --local-heap-threshold expects a number of bytes\n";
+                options.helpRequested = true;
+                return options;
+            }
+        } else if (arg == "--sample-profile") {
+            // Samples are mapped to Pascal lines through the debug info
+            options.sampleProfile = true;
+            options.debugInfo = true;
+        } else if (arg == "--build" && i + 1 < argc) {
+            options.buildDir = argv[++i];
         } else if (arg == "-o" && i + 1 < argc) {
             options.outputFile = argv[++i];
         } else if (arg[0] != '-') {
@@ -107,7 +192,7 @@ CompilerOptions parseArguments(int argc, char* argv[]) {
         }
     }
     
-    if (options.inputFile.empty() && !options.helpRequested) {
+    if (options.inputFile.empty() && options.buildDir.empty() && !options.helpRequested) {
         std::cerr << "Error: No input file specified\n";
         options.helpRequested = true;
     }
@@ -125,6 +210,17 @@ CompilerOptions parseArguments(int argc, char* argv[]) {
 #endif
     }
     
+    // Dependency file defaults to the executable name with a .d suffix
+    if (options.writeDepfile && options.depFile.empty() && !options.outputFile.empty()) {
+        std::filesystem::path depPath(options.outputFile);
+#ifdef _WIN32
+        if (depPath.extension() == ".exe") {
+            depPath.replace_extension();
+        }
+#endif
+        options.depFile = depPath.string() + ".d";
+    }
+    
     // Set C++ intermediate file name
     if (!options.inputFile.empty()) {
         size_t lastDot = options.inputFile.find_last_of('.');
@@ -198,14 +294,90 @@ std::unique_ptr<Program> parseSource(std::unique_ptr<Lexer> lexer, bool showAST,
     return program;
 }
 
+// Directory containing a source file ("." for a bare file name)
+std::string sourceDirectory(const std::string& sourceFile) {
+    std::filesystem::path parent = std::filesystem::path(sourceFile).parent_path();
+    return parent.empty() ? "." : parent.string();
+}
+
+// Explicit unit search order for -I: the source's own directory, then each
+// -I path in order. Empty when no -I was given (keep the loader defaults).
+std::vector<std::string> unitSearchPaths(const CompilerOptions& options, const std::string& sourceDir) {
+    std::vector<std::string> paths;
+    if (!options.unitPaths.empty()) {
+        paths.push_back(sourceDir);
+        paths.insert(paths.end(), options.unitPaths.begin(), options.unitPaths.end());
+    }
+    return paths;
+}
+
+// Escape a path for use in a Make-style depfile
+std::string escapeDepfilePath(const std::string& path) {
+    std::string escaped;
+    for (char c : path) {
+        if (c == ' ' || c == '#') {
+            escaped += '\\';
+        } else if (c == '$') {
+            escaped += '$';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// The running rpascal executable, or an empty path if it cannot be found
+std::filesystem::path compilerExecutablePath(const CompilerOptions& options) {
+    std::error_code ec;
+    std::filesystem::path executable = std::filesystem::canonical("/proc/self/exe", ec);
+    if (ec) {
+        executable = std::filesystem::absolute(options.compilerExecutable, ec);
+    }
+    if (ec || !std::filesystem::exists(executable)) {
+        return {};
+    }
+    return executable;
+}
+
+// Write "<output>: <source> <units...> <runtime>" in the format of gcc -MD -MF.
+// The runtime is emitted by the compiler itself, so the rpascal executable
+// stands in for the runtime header.
+bool writeDependencyFile(const CompilerOptions& options, const std::vector<std::string>& unitFiles) {
+    std::vector<std::string> deps;
+    deps.push_back(options.inputFile);
+    deps.insert(deps.end(), unitFiles.begin(), unitFiles.end());
+    
+    std::filesystem::path runtime = compilerExecutablePath(options);
+    if (!runtime.empty()) {
+        deps.push_back(runtime.string());
+    }
+    
+    std::ofstream depFile(options.depFile);
+    if (!depFile.is_open()) {
+        std::cerr << "Error: Could not write dependency file: " << options.depFile << "\n";
+        return false;
+    }
+    
+    depFile << escapeDepfilePath(options.outputFile) << ":";
+    for (const auto& dep : deps) {
+        depFile << " \\\n " << escapeDepfilePath(dep);
+    }
+    depFile << "\n";
+    return true;
+}
+
 // Perform semantic analysis
-bool performSemanticAnalysis(std::unique_ptr<Program>& program, bool verbose, std::shared_ptr<SymbolTable>& symbolTable, std::unique_ptr<SemanticAnalyzer>& analyzer) {
+bool performSemanticAnalysis(std::unique_ptr<Program>& program, bool verbose, bool useUnitCache, bool autoParallel, const std::vector<std::string>& unitSearchPaths, std::shared_ptr<SymbolTable>& symbolTable, std::unique_ptr<SemanticAnalyzer>& analyzer) {
     if (verbose) {
         std::cout << "Performing semantic analysis...\n";
     }
     
     symbolTable = std::make_shared<SymbolTable>();
     analyzer = std::make_unique<SemanticAnalyzer>(symbolTable);
+    analyzer->getUnitLoader()->setCacheEnabled(useUnitCache);
+    analyzer->setAutoParallel(autoParallel);
+    if (!unitSearchPaths.empty()) {
+        analyzer->getUnitLoader()->setSearchPaths(unitSearchPaths);
+    }
     
     bool success = analyzer->analyze(*program);
     
@@ -224,14 +396,44 @@ bool performSemanticAnalysis(std::unique_ptr<Program>& program, bool verbose, st
     return success;
 }
 
+// Apply the code generation options; shared by single-file and --build compiles
+void configureGenerator(CppGenerator& generator, const CompilerOptions& options,
+                        const std::string& sourceFile, const std::string& cppFile) {
+    // Absolute paths so debuggers and profile viewers find the sources from any directory
+    generator.setSourceFiles(std::filesystem::absolute(sourceFile).string(),
+                             std::filesystem::absolute(cppFile).string());
+    generator.setLineDirectives(options.debugInfo && options.lineDirectives);
+    generator.setProfiling(options.profile);
+    generator.setTracing(options.trace);
+    generator.setHeapStats(options.heapStats);
+    generator.setLocalHeapThreshold(options.localHeapThreshold);
+    // Debug builds carry the sampler too, dormant unless RPASCAL_SAMPLE_PROFILE is set
+    generator.setSampleProfiling(options.sampleProfile || options.debugInfo, options.sampleProfile);
+}
+
+void printCodegenReports(const CppGenerator& generator, const SemanticAnalyzer& analyzer, const CompilerOptions& options) {
+    if (options.layoutReport) {
+        std::cout << generator.getLayoutReport();
+    }
+    if (options.parReport) {
+        std::cout << analyzer.getAutoParallelReport();
+    }
+    if (options.vecReport) {
+        std::cout << generator.getVectorReport();
+    }
+}
+
 // Generate C++ code
-std::string generateCppCode(std::unique_ptr<Program>& program, std::shared_ptr<SymbolTable> symbolTable, SemanticAnalyzer* analyzer, bool verbose) {
+std::string generateCppCode(std::unique_ptr<Program>& program, std::shared_ptr<SymbolTable> symbolTable, SemanticAnalyzer* analyzer, const CompilerOptions& options) {
+    bool verbose = options.verbose;
     if (verbose) {
         std::cout << "Generating C++ code...\n";
     }
     
     auto generator = std::make_unique<CppGenerator>(symbolTable, analyzer->getUnitLoader());
+    configureGenerator(*generator, options, options.inputFile, options.cppFile);
     std::string cppCode = generator->generate(*program);
+    printCodegenReports(*generator, *analyzer, options);
     
     if (verbose) {
         std::cout << "C++ code generation completed.\n";
@@ -476,15 +678,10 @@ private:
     }
 };
 
-bool compileToExecutable(const std::string& cppFile, const std::string& exeFile, bool verbose) {
-    if (!std::filesystem::exists(cppFile)) {
-        std::cerr << "Error: C++ file does not exist: " << cppFile << std::endl;
-        return false;
-    }
-
-    CommandBuilder builder;
-
-    bool useMSVC = false;
+// Locate a C++ compiler; useMSVC is set when cl.exe is chosen.
+// Returns an empty string if none is available.
+std::string findCppCompiler(bool verbose, bool& useMSVC) {
+    useMSVC = false;
     std::string compilerPath;
 
 #ifdef _WIN32
@@ -512,7 +709,7 @@ bool compileToExecutable(const std::string& cppFile, const std::string& exeFile,
                 compilerPath = "g++";
             } else {
                 std::cerr << "Error: Neither MSVC nor g++ found. Please install Visual Studio, MinGW64, or GCC." << std::endl;
-                return false;
+                return "";
             }
         }
         if (verbose) {
@@ -536,11 +733,28 @@ bool compileToExecutable(const std::string& cppFile, const std::string& exeFile,
             }
         } else {
             std::cerr << "Error: Neither g++ nor clang++ found. Please install GCC or Clang." << std::endl;
-            return false;
+            return "";
         }
     }
 #endif
 
+    return compilerPath;
+}
+
+bool compileToExecutable(const std::string& cppFile, const std::string& exeFile, bool debugInfo, bool verbose) {
+    if (!std::filesystem::exists(cppFile)) {
+        std::cerr << "Error: C++ file does not exist: " << cppFile << std::endl;
+        return false;
+    }
+
+    CommandBuilder builder;
+
+    bool useMSVC = false;
+    std::string compilerPath = findCppCompiler(verbose, useMSVC);
+    if (compilerPath.empty()) {
+        return false;
+    }
+
     // Configure compiler based on type
     if (useMSVC) {
         // MSVC configuration
@@ -552,17 +766,20 @@ bool compileToExecutable(const std::string& cppFile, const std::string& exeFile,
 #ifdef _WIN32
         // Windows g++/MinGW configuration with static linking
         builder.compiler(compilerPath)
-               .compileFlags({"-std=c++17", "-O2", "-static-libgcc", "-static-libstdc++", "-static"})
+               .compileFlags({"-std=c++17", "-O2", "-fopenmp-simd", "-static-libgcc", "-static-libstdc++", "-static"})
                .input(cppFile)
                .output(exeFile);
 #else
         // Linux/Unix g++/clang++ configuration
         builder.compiler(compilerPath)
-               .compileFlags({"-std=c++17", "-O2"})
+               .compileFlags({"-std=c++17", "-O2", "-fopenmp-simd"})
                .input(cppFile)
                .output(exeFile);
 #endif
     }
+    if (debugInfo) {
+        builder.compileFlag(useMSVC ? "/Zi" : "-g");
+    }
 
     if (verbose) {
         std::cout << "Compilation command: " << builder.build() << std::endl;
@@ -615,12 +832,12 @@ int compile(const CompilerOptions& options) {
         // Perform semantic analysis
         std::shared_ptr<SymbolTable> symbolTable;
         std::unique_ptr<SemanticAnalyzer> analyzer;
-        if (!performSemanticAnalysis(program, options.verbose, symbolTable, analyzer)) {
+        if (!performSemanticAnalysis(program, options.verbose, options.useUnitCache, options.autoParallel, unitSearchPaths(options, sourceDirectory(options.inputFile)), symbolTable, analyzer)) {
             return 1;
         }
         
         // Generate C++ Code
-        std::string cppCode = generateCppCode(program, symbolTable, analyzer.get(), options.verbose);
+        std::string cppCode = generateCppCode(program, symbolTable, analyzer.get(), options);
         
         if (options.verbose) {
             std::cout << "Compilation successful!\n";
@@ -645,13 +862,18 @@ int compile(const CompilerOptions& options) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         
         // Compile the C++ code to executable
-        if (!compileToExecutable(options.cppFile, options.outputFile, options.verbose)) {
+        if (!compileToExecutable(options.cppFile, options.outputFile, options.debugInfo, options.verbose)) {
             return 1;
         }
         if (options.verbose) {
             std::cout << "Executable created: " << options.outputFile << "\n";
         }
         
+        if (options.writeDepfile &&
+            !writeDependencyFile(options, analyzer->getUnitLoader()->getLoadedUnitFiles())) {
+            return 1;
+        }
+        
         // Remove intermediate files unless user wants to keep them
         if (!options.keepCpp) {
             // Remove C++ file
@@ -711,6 +933,447 @@ int compile(const CompilerOptions& options) {
     }
 }
 
+// A unit or program source file in a --build project
+struct BuildTarget {
+    std::string key;                     // Lower-case unit/program name
+    std::string name;
+    std::filesystem::path sourceFile;
+    bool isUnit = false;
+    std::unique_ptr<Unit> unit;
+    std::unique_ptr<Program> program;
+    std::vector<std::string> uses;       // Keys of project units used
+    uint64_t sourceHash = 0;
+    uint64_t stamp = 0;                  // Hash of source, unit dependencies and build settings
+    bool stale = false;
+};
+
+std::string toLowerName(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), 
+                  [](char c) { return static_cast<char>(std::tolower(c)); });
+    return lower;
+}
+
+std::string readStamp(const std::filesystem::path& stampFile) {
+    std::ifstream file(stampFile);
+    std::string stamp;
+    if (file.is_open()) {
+        file >> stamp;
+    }
+    return stamp;
+}
+
+// Returns false if the file could not be written; safe to call from build workers
+bool writeTextFile(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << content;
+    file.close();
+    return !file.fail();
+}
+
+// First line of the C++ compiler's --version banner, so an upgraded
+// compiler invalidates the build stamps
+std::string compilerVersion(const std::string& compilerPath) {
+    std::string command = compilerPath + " --version";
+#ifdef _WIN32
+    FILE* pipe = _popen(command.c_str(), "r");
+#else
+    FILE* pipe = popen(command.c_str(), "r");
+#endif
+    if (!pipe) {
+        return "";
+    }
+    char line[512] = {};
+    std::string version = std::fgets(line, sizeof(line), pipe) ? line : "";
+#ifdef _WIN32
+    _pclose(pipe);
+#else
+    pclose(pipe);
+#endif
+    return version;
+}
+
+// Everything besides the sources that decides what a build produces: the
+// rpascal and C++ compilers and the options that change generated code or flags
+uint64_t buildSettingsHash(const CompilerOptions& options, const std::string& compilerPath) {
+    std::ostringstream settings;
+    settings << "rpascal:";
+    std::filesystem::path executable = compilerExecutablePath(options);
+    std::error_code ec;
+    if (!executable.empty()) {
+        settings << executable.string() << ":" << std::filesystem::file_size(executable, ec);
+        settings << ":" << std::filesystem::last_write_time(executable, ec).time_since_epoch().count();
+    }
+    settings << ";cxx:" << compilerPath << ":" << compilerVersion(compilerPath);
+    settings << ";g:" << options.debugInfo << ";line:" << options.lineDirectives
+             << ";profile:" << options.profile << ";trace:" << options.trace
+             << ";sample:" << options.sampleProfile << ";heap:" << options.heapStats
+             << ";autopar:" << options.autoParallel << ";localheap:" << options.localHeapThreshold
+             << ";cache:" << options.useUnitCache << ";I:";
+    for (const auto& path : options.unitPaths) {
+        settings << path << ",";
+    }
+    return UnitCache::hashContent(settings.str());
+}
+
+// Parse one source file of a project; returns false on parse errors
+bool parseBuildTarget(const std::filesystem::path& sourceFile, BuildTarget& target) {
+    std::string source = readFile(sourceFile.string());
+    target.sourceFile = sourceFile;
+    target.sourceHash = UnitCache::hashContent(source);
+    
+    Lexer probe(source);
+    TokenType first = probe.nextToken().getType();
+    while (first == TokenType::DIRECTIVE) {
+        first = probe.nextToken().getType();
+    }
+    if (first != TokenType::UNIT && first != TokenType::PROGRAM) {
+        return true;  // Not a unit or program, ignored by the caller
+    }
+    
+    Parser parser(std::make_unique<Lexer>(source));
+    const UsesClause* usesClause = nullptr;
+    if (first == TokenType::UNIT) {
+        target.isUnit = true;
+        target.unit = parser.parseUnit();
+        if (target.unit) {
+            target.name = target.unit->getName();
+            usesClause = target.unit->getUsesClause();
+        }
+    } else {
+        target.program = parser.parseProgram();
+        if (target.program) {
+            target.name = target.program->getName();
+            usesClause = target.program->getUsesClause();
+        }
+    }
+    
+    if (parser.hasErrors() || target.name.empty()) {
+        std::cerr << "Parse errors in " << sourceFile.string() << ":\n";
+        for (const auto& error : parser.getErrors()) {
+            std::cerr << "  " << error << "\n";
+        }
+        return false;
+    }
+    
+    target.key = toLowerName(target.name);
+    if (usesClause) {
+        for (const auto& unitName : usesClause->getUnits()) {
+            if (!UnitLoader::isBuiltinUnit(unitName)) {
+                target.uses.push_back(toLowerName(unitName));
+            }
+        }
+    }
+    return true;
+}
+
+// Build every unit and program in a directory. Units are compiled to their
+// own header and object file; only targets whose source or unit dependencies
+// changed are regenerated, and the C++ compiles run in parallel.
+int buildProject(const CompilerOptions& options) {
+    namespace fs = std::filesystem;
+    
+    try {
+        fs::path projectDir(options.buildDir);
+        if (!fs::is_directory(projectDir)) {
+            std::cerr << "Error: Not a directory: " << options.buildDir << "\n";
+            return 1;
+        }
+        fs::path buildDir = projectDir / "rpascal_build";
+        fs::create_directories(buildDir);
+        
+        // Collect sources in a stable order
+        std::vector<fs::path> sources;
+        for (const auto& entry : fs::directory_iterator(projectDir)) {
+            std::string ext = toLowerName(entry.path().extension().string());
+            if (entry.is_regular_file() && (ext == ".pas" || ext == ".pp" || ext == ".p")) {
+                sources.push_back(entry.path());
+            }
+        }
+        std::sort(sources.begin(), sources.end());
+        
+        std::map<std::string, BuildTarget> units;
+        std::vector<BuildTarget> programs;
+        for (const auto& sourceFile : sources) {
+            BuildTarget target;
+            if (!parseBuildTarget(sourceFile, target)) {
+                return 1;
+            }
+            if (target.name.empty()) {
+                continue;
+            }
+            if (target.isUnit) {
+                std::string key = target.key;
+                units[key] = std::move(target);
+            } else {
+                programs.push_back(std::move(target));
+            }
+        }
+        
+        auto checkUses = [&](const BuildTarget& target) {
+            for (const auto& dep : target.uses) {
+                if (units.find(dep) == units.end()) {
+                    std::cerr << "Error: Unit '" << dep << "' used by " << target.name
+                              << " was not found in " << options.buildDir << "\n";
+                    return false;
+                }
+            }
+            return true;
+        };
+        
+        bool useMSVC = false;
+        std::string compilerPath = findCppCompiler(options.verbose, useMSVC);
+        if (compilerPath.empty()) {
+            return 1;
+        }
+        if (useMSVC) {
+            std::cerr << "Error: --build requires g++ or clang++\n";
+            return 1;
+        }
+        std::string settingsHash = std::to_string(buildSettingsHash(options, compilerPath));
+        
+        // Order units dependencies-first and compute their stamps
+        std::vector<BuildTarget*> unitOrder;
+        std::map<std::string, int> visitState;  // 1 = in progress, 2 = done
+        std::function<bool(BuildTarget&)> visitUnit = [&](BuildTarget& target) {
+            int& state = visitState[target.key];
+            if (state == 2) return true;
+            if (state == 1) {
+                std::cerr << "Error: Circular unit reference involving " << target.name << "\n";
+                return false;
+            }
+            state = 1;
+            if (!checkUses(target)) return false;
+            
+            std::string stampInput = settingsHash + ":" + std::to_string(target.sourceHash);
+            for (const auto& dep : target.uses) {
+                BuildTarget& depTarget = units[dep];
+                if (!visitUnit(depTarget)) return false;
+                stampInput += ":" + std::to_string(depTarget.stamp);
+            }
+            target.stamp = UnitCache::hashContent(stampInput);
+            
+            visitState[target.key] = 2;
+            unitOrder.push_back(&target);
+            return true;
+        };
+        for (auto& [key, target] : units) {
+            if (!visitUnit(target)) return 1;
+        }
+        
+        for (auto& program : programs) {
+            if (!checkUses(program)) return 1;
+            std::string stampInput = settingsHash + ":" + std::to_string(program.sourceHash);
+            for (const auto& dep : program.uses) {
+                stampInput += ":" + std::to_string(units[dep].stamp);
+            }
+            program.stamp = UnitCache::hashContent(stampInput);
+        }
+        
+        auto stampFile = [&](const BuildTarget& target) {
+            return buildDir / ((target.isUnit ? "unit_" : "program_") + target.key + ".stamp");
+        };
+        auto objectFile = [&](const BuildTarget& target) {
+            return buildDir / (target.key + ".o");
+        };
+        auto executableFile = [&](const BuildTarget& target) {
+            fs::path exe = projectDir / target.sourceFile.stem();
+#ifdef _WIN32
+            exe += ".exe";
+#endif
+            return exe;
+        };
+        
+        for (auto* target : unitOrder) {
+            target->stale = !fs::exists(objectFile(*target)) ||
+                            readStamp(stampFile(*target)) != std::to_string(target->stamp);
+        }
+        for (auto& program : programs) {
+            program.stale = !fs::exists(executableFile(program)) ||
+                            readStamp(stampFile(program)) != std::to_string(program.stamp);
+        }
+        
+        // Generate C++ for stale targets (code generation is single-threaded)
+        auto analyzerFor = [&](std::shared_ptr<SymbolTable>& symbolTable) {
+            symbolTable = std::make_shared<SymbolTable>();
+            auto analyzer = std::make_unique<SemanticAnalyzer>(symbolTable);
+            analyzer->getUnitLoader()->setCacheEnabled(options.useUnitCache);
+            analyzer->setAutoParallel(options.autoParallel);
+            if (options.unitPaths.empty()) {
+                analyzer->getUnitLoader()->addSearchPath(projectDir.string());
+            } else {
+                analyzer->getUnitLoader()->setSearchPaths(unitSearchPaths(options, projectDir.string()));
+            }
+            return analyzer;
+        };
+        auto reportErrors = [](const std::string& name, const SemanticAnalyzer& analyzer) {
+            std::cerr << "Semantic errors in " << name << ":\n";
+            for (const auto& error : analyzer.getErrors()) {
+                std::cerr << "  " << error << "\n";
+            }
+        };
+        
+        for (auto* target : unitOrder) {
+            if (!target->stale) continue;
+            if (options.verbose) {
+                std::cout << "Generating unit " << target->name << "\n";
+            }
+            std::shared_ptr<SymbolTable> symbolTable;
+            auto analyzer = analyzerFor(symbolTable);
+            if (!analyzer->analyzeUnit(*target->unit)) {
+                reportErrors(target->name, *analyzer);
+                return 1;
+            }
+            fs::path headerFile = buildDir / CppGenerator::unitHeaderName(target->name);
+            fs::path cppFile = buildDir / (target->key + ".cpp");
+            CppGenerator generator(symbolTable, analyzer->getUnitLoader());
+            configureGenerator(generator, options, target->sourceFile.string(), cppFile.string());
+            generator.setSeparateUnits(true);
+            if (!writeTextFile(headerFile, generator.generateUnitHeader(*target->unit)) ||
+                !writeTextFile(cppFile, generator.generateUnitSource(*target->unit))) {
+                std::cerr << "Error: Could not write the C++ files of unit " << target->name << "\n";
+                return 1;
+            }
+            printCodegenReports(generator, *analyzer, options);
+        }
+        
+        for (auto& program : programs) {
+            if (!program.stale) continue;
+            if (options.verbose) {
+                std::cout << "Generating program " << program.name << "\n";
+            }
+            std::shared_ptr<SymbolTable> symbolTable;
+            auto analyzer = analyzerFor(symbolTable);
+            if (!analyzer->analyze(*program.program)) {
+                reportErrors(program.name, *analyzer);
+                return 1;
+            }
+            fs::path cppFile = buildDir / ("program_" + program.key + ".cpp");
+            CppGenerator generator(symbolTable, analyzer->getUnitLoader());
+            configureGenerator(generator, options, program.sourceFile.string(), cppFile.string());
+            generator.setSeparateUnits(true);
+            if (!writeTextFile(cppFile, generator.generate(*program.program))) {
+                std::cerr << "Error: Could not write file: " << cppFile.string() << "\n";
+                return 1;
+            }
+            printCodegenReports(generator, *analyzer, options);
+        }
+        
+        // Workers must not throw (an exception escaping a thread terminates
+        // the compiler); they record their errors here instead
+        std::mutex outputMutex;
+        std::vector<std::string> errors;
+        auto fail = [&](const std::string& error) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            errors.push_back(error);
+        };
+        auto reportFailures = [&]() {
+            for (const auto& error : errors) {
+                std::cerr << "Error: " << error << "\n";
+            }
+            return !errors.empty();
+        };
+        auto runCommand = [&](const std::string& description, const CommandBuilder& builder) {
+            try {
+                std::string command = builder.build();
+                {
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    std::cout << description << "\n";
+                    if (options.verbose) {
+                        std::cout << "Executing: " << command << std::endl;
+                    }
+                }
+                if (std::system(command.c_str()) != 0) {
+                    fail(description + " failed");
+                    return false;
+                }
+            } catch (const std::exception& e) {
+                fail(description + ": " + e.what());
+                return false;
+            }
+            return true;
+        };
+        auto writeStamp = [&](const BuildTarget& target) {
+            if (!writeTextFile(stampFile(target), std::to_string(target.stamp))) {
+                fail("Could not write file: " + stampFile(target).string());
+            }
+        };
+        std::vector<std::string> compileFlags = {"-std=c++17", "-O2", "-fopenmp-simd", "-I" + buildDir.string()};
+        if (options.debugInfo) {
+            compileFlags.push_back("-g");
+        }
+        
+        // Compile stale units; every header already exists, so they are independent
+        std::vector<BuildTarget*> staleUnits;
+        for (auto* target : unitOrder) {
+            if (target->stale) staleUnits.push_back(target);
+        }
+        runParallel(staleUnits.size(), [&](size_t i) {
+            BuildTarget& target = *staleUnits[i];
+            CommandBuilder builder;
+            builder.compiler(compilerPath)
+                   .compileFlags(compileFlags)
+                   .compileFlag("-c")
+                   .input((buildDir / (target.key + ".cpp")).string())
+                   .output(objectFile(target).string());
+            if (runCommand("Compiling unit " + target.name, builder)) {
+                writeStamp(target);
+            }
+        });
+        if (reportFailures()) {
+            return 1;
+        }
+        
+        // Compile and link stale programs against the objects of every unit they reach
+        std::vector<BuildTarget*> stalePrograms;
+        for (auto& program : programs) {
+            if (program.stale) stalePrograms.push_back(&program);
+        }
+        runParallel(stalePrograms.size(), [&](size_t i) {
+            BuildTarget& program = *stalePrograms[i];
+            
+            std::vector<std::string> objects;
+            std::set<std::string> seen;
+            std::function<void(const std::string&)> collect = [&](const std::string& key) {
+                if (!seen.insert(key).second) return;
+                for (const auto& dep : units[key].uses) collect(dep);
+                objects.push_back(objectFile(units[key]).string());
+            };
+            for (const auto& dep : program.uses) collect(dep);
+            
+            CommandBuilder builder;
+            builder.compiler(compilerPath)
+                   .compileFlags(compileFlags)
+                   .input((buildDir / ("program_" + program.key + ".cpp")).string())
+                   .output(executableFile(program).string());
+#ifdef _WIN32
+            builder.linkFlags({"-static-libgcc", "-static-libstdc++", "-static"});
+#endif
+            for (const auto& object : objects) {
+                builder.library(object);
+            }
+            if (runCommand("Linking program " + program.name, builder)) {
+                writeStamp(program);
+            }
+        });
+        if (reportFailures()) {
+            return 1;
+        }
+        
+        std::cout << "Build complete: " << staleUnits.size() << " of " << unitOrder.size()
+                  << " units and " << stalePrograms.size() << " of " << programs.size()
+                  << " programs rebuilt\n";
+        return 0;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
 int main(int argc, char* argv[]) {
     CompilerOptions options = parseArguments(argc, argv);
     
@@ -719,5 +1382,9 @@ int main(int argc, char* argv[]) {
         return options.inputFile.empty() ? 1 : 0;
     }
     
+    if (!options.buildDir.empty()) {
+        return buildProject(options);
+    }
+    
     return compile(options);
 }
\ No newline at end of file
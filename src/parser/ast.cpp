@@ -204,7 +204,7 @@ void ForStatement::accept(ASTVisitor& visitor) {
 }
 
 std::string ForStatement::toString() const {
-    return "ForStatement(" + variable_ + " := " + start_->toString() + 
+    return std::string(parallel_ ? "Parallel" : "") + "ForStatement(" + variable_ + " := " + start_->toString() + 
            (isDownto_ ? " downto " : " to ") + end_->toString() + 
            " do " + body_->toString() + ")";
 }
@@ -332,7 +332,7 @@ void RecordTypeDefinition::accept(ASTVisitor& visitor) {
 }
 
 std::string RecordTypeDefinition::toString() const {
-    std::string result = "RecordTypeDefinition(" + name_ + " = record ";
+    std::string result = "RecordTypeDefinition(" + name_ + " = " + (packed_ ? "packed " : "") + "record ";
     for (size_t i = 0; i < fields_.size(); ++i) {
         if (i > 0) result += "; ";
         result += fields_[i].toString();
@@ -363,7 +363,7 @@ std::string VariantCase::toString() const {
 
 // VariantPart
 std::string VariantPart::toString() const {
-    std::string result = "case " + selectorName_ + ": " + selectorType_ + " of ";
+    std::string result = "case " + (selectorName_.empty() ? "" : selectorName_ + ": ") + selectorType_ + " of ";
     for (size_t i = 0; i < cases_.size(); ++i) {
         if (i > 0) result += "; ";
         result += cases_[i]->toString();
@@ -1,5 +1,7 @@
 #include "../include/parser.h"
 #include <sstream>
+#include <cctype>
+#include <algorithm>
 
 namespace rpascal {
 
@@ -47,10 +49,14 @@ std::unique_ptr<Program> Parser::parseProgram() {
             } else if (match(TokenType::TYPE)) {
                 // Handle multiple type definitions after 'type'
                 do {
+                    // {$SOA} may precede the type name or the type itself
+                    bool structOfArrays = takeDirective("SOA");
                     Token typeNameToken = consume(TokenType::IDENTIFIER, "Expected type name");
                     consume(TokenType::EQUAL, "Expected '=' after type name");
+                    structOfArrays = takeDirective("SOA") || structOfArrays;
                     
                     // Check if this is a record type definition
+                    bool packed = match(TokenType::PACKED);
                     if (check(TokenType::RECORD)) {
                         advance(); // consume 'record'
                         auto [fields, variantPart] = parseRecordFields();
@@ -58,19 +64,26 @@ std::unique_ptr<Program> Parser::parseProgram() {
                         consume(TokenType::SEMICOLON, "Expected ';' after record definition");
                         
                         auto recordDecl = std::make_unique<RecordTypeDefinition>(typeNameToken.getValue(), std::move(fields), std::move(variantPart));
+                        recordDecl->setPacked(packed);
                         declarations.push_back(std::move(recordDecl));
                     } else {
                         // Handle other type definitions (arrays, sets, etc.)
                         std::string typeDefinition = parseTypeDefinition();
+                        if (packed && typeDefinition.rfind("array[", 0) == 0) {
+                            typeDefinition = "packed " + typeDefinition;
+                        }
                         consume(TokenType::SEMICOLON, "Expected ';' after type definition");
                         
                         auto typeDecl = std::make_unique<TypeDefinition>(typeNameToken.getValue(), typeDefinition);
+                        typeDecl->setStructOfArrays(structOfArrays);
                         declarations.push_back(std::move(typeDecl));
                     }
                     
                 } while (check(TokenType::IDENTIFIER) && !isAtEnd());
-            } else if (match(TokenType::VAR)) {
-                // Handle multiple variable declarations after 'var'
+            } else if (check(TokenType::VAR) || check(TokenType::THREADVAR)) {
+                // Handle multiple variable declarations after 'var' or 'threadvar'
+                bool threadLocal = check(TokenType::THREADVAR);
+                advance();
                 do {
                     // Parse variable name(s) - Pascal allows multiple variables of same type
                     std::vector<std::string> varNames;
@@ -91,6 +104,7 @@ std::unique_ptr<Program> Parser::parseProgram() {
                     // Create a separate declaration for each variable
                     for (const auto& varName : varNames) {
                         auto varDecl = std::make_unique<VariableDeclaration>(varName, typeName);
+                        varDecl->setThreadLocal(threadLocal);
                         declarations.push_back(std::move(varDecl));
                     }
                     
@@ -238,7 +252,29 @@ std::unique_ptr<Unit> Parser::parseUnit() {
 }
 
 void Parser::advance() {
+    // Directives apply to the token that follows them; unknown ones are ignored
+    pendingDirectives_.clear();
     currentToken_ = lexer_->nextToken();
+    while (currentToken_.getType() == TokenType::DIRECTIVE) {
+        pendingDirectives_.push_back(currentToken_.getValue());
+        currentToken_ = lexer_->nextToken();
+    }
+}
+
+bool Parser::takeDirective(const std::string& name, std::string* arguments) {
+    for (auto it = pendingDirectives_.begin(); it != pendingDirectives_.end(); ++it) {
+        size_t nameEnd = std::min(it->find_first_of(" \t\r\n"), it->size());
+        std::string directive = it->substr(0, nameEnd);
+        std::transform(directive.begin(), directive.end(), directive.begin(), ::toupper);
+        if (directive == name) {
+            if (arguments) {
+                *arguments = it->substr(nameEnd);
+            }
+            pendingDirectives_.erase(it);
+            return true;
+        }
+    }
+    return false;
 }
 
 bool Parser::match(TokenType type) {
@@ -287,6 +323,7 @@ void Parser::synchronize() {
         
         switch (currentToken_.getType()) {
             case TokenType::VAR:
+            case TokenType::THREADVAR:
             case TokenType::PROCEDURE:
             case TokenType::FUNCTION:
             case TokenType::BEGIN:
@@ -308,6 +345,10 @@ std::unique_ptr<Declaration> Parser::parseDeclaration(bool isInterface) {
             return parseConstantDeclaration();
         } else if (match(TokenType::VAR)) {
             return parseVariableDeclaration();
+        } else if (match(TokenType::THREADVAR)) {
+            auto varDecl = parseVariableDeclaration();
+            varDecl->setThreadLocal(true);
+            return varDecl;
         } else if (match(TokenType::TYPE)) {
             return parseTypeDeclaration();
         } else if (match(TokenType::LABEL)) {
@@ -348,10 +389,13 @@ std::unique_ptr<VariableDeclaration> Parser::parseVariableDeclaration() {
 }
 
 std::unique_ptr<Declaration> Parser::parseTypeDeclaration() {
+    bool structOfArrays = takeDirective("SOA");
     Token nameToken = consume(TokenType::IDENTIFIER, "Expected type name");
     consume(TokenType::EQUAL, "Expected '=' after type name");
+    structOfArrays = takeDirective("SOA") || structOfArrays;
     
     // For now, we'll handle record types
+    bool packed = match(TokenType::PACKED);
     if (check(TokenType::RECORD)) {
         advance(); // consume RECORD
         
@@ -379,13 +423,20 @@ std::unique_ptr<Declaration> Parser::parseTypeDeclaration() {
         consume(TokenType::END, "Expected 'end' after record fields");
         consume(TokenType::SEMICOLON, "Expected ';' after type declaration");
         
-        return std::make_unique<RecordTypeDefinition>(nameToken.getValue(), std::move(fields));
+        auto recordDecl = std::make_unique<RecordTypeDefinition>(nameToken.getValue(), std::move(fields));
+        recordDecl->setPacked(packed);
+        return recordDecl;
     } else {
         // Handle simple type aliases
         std::string aliasType = parseTypeName();
+        if (packed && aliasType.rfind("array[", 0) == 0) {
+            aliasType = "packed " + aliasType;
+        }
         consume(TokenType::SEMICOLON, "Expected ';' after type declaration");
         
-        return std::make_unique<TypeDefinition>(nameToken.getValue(), aliasType);
+        auto typeDecl = std::make_unique<TypeDefinition>(nameToken.getValue(), aliasType);
+        typeDecl->setStructOfArrays(structOfArrays);
+        return typeDecl;
     }
 }
 
@@ -497,7 +548,9 @@ std::unique_ptr<ProcedureDeclaration> Parser::parseProcedureDeclaration(bool isI
     auto body = parseCompoundStatement();
     consume(TokenType::SEMICOLON, "Expected ';' after procedure body");
     
-    return std::make_unique<ProcedureDeclaration>(nameToken.getValue(), std::move(parameters), std::move(localVariables), std::move(nestedDeclarations), std::move(body), false, isOverloaded);
+    auto procDecl = std::make_unique<ProcedureDeclaration>(nameToken.getValue(), std::move(parameters), std::move(localVariables), std::move(nestedDeclarations), std::move(body), false, isOverloaded);
+    procDecl->setLocation(nameToken.getLocation());
+    return procDecl;
 }
 
 std::unique_ptr<FunctionDeclaration> Parser::parseFunctionDeclaration(bool isInterface) {
@@ -547,7 +600,9 @@ std::unique_ptr<FunctionDeclaration> Parser::parseFunctionDeclaration(bool isInt
     auto body = parseCompoundStatement();
     consume(TokenType::SEMICOLON, "Expected ';' after function body");
     
-    return std::make_unique<FunctionDeclaration>(nameToken.getValue(), std::move(parameters), returnType, std::move(localVariables), std::move(nestedDeclarations), std::move(body), false, isOverloaded);
+    auto funcDecl = std::make_unique<FunctionDeclaration>(nameToken.getValue(), std::move(parameters), returnType, std::move(localVariables), std::move(nestedDeclarations), std::move(body), false, isOverloaded);
+    funcDecl->setLocation(nameToken.getLocation());
+    return funcDecl;
 }
 
 std::unique_ptr<Statement> Parser::parseStatement() {
@@ -564,9 +619,15 @@ std::unique_ptr<Statement> Parser::parseStatement() {
             auto stmt = parseWhileStatement();
             stmt->setLocation(startLocation);
             return stmt;
-        } else if (match(TokenType::FOR)) {
+        } else if (check(TokenType::FOR)) {
+            std::string clauses;
+            bool parallel = takeDirective("PARALLEL", &clauses);
+            advance(); // consume FOR
             auto stmt = parseForStatement();
             stmt->setLocation(startLocation);
+            if (parallel) {
+                parseParallelClauses(*stmt, clauses);
+            }
             return stmt;
         } else if (match(TokenType::REPEAT)) {
             auto stmt = parseRepeatStatement();
@@ -627,7 +688,18 @@ std::unique_ptr<Statement> Parser::parseStatement() {
         } else if (check(TokenType::IDENTIFIER)) {
             // Check if this is a label (identifier followed by colon)
             Token labelToken = currentToken_;
+            std::string clauses;
+            bool parallelDirective = takeDirective("PARALLEL", &clauses);
             advance();
+            std::string lowerName = labelToken.getValue();
+            std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+            if (lowerName == "parallel" && match(TokenType::FOR)) {
+                // parallel for: 'parallel' is only special right before 'for'
+                auto stmt = parseForStatement();
+                stmt->setLocation(startLocation);
+                parseParallelClauses(*stmt, parallelDirective ? clauses : "");
+                return stmt;
+            }
             if (match(TokenType::COLON)) {
                 // This is a label - create a compound statement with the label and the following statement
                 std::vector<std::unique_ptr<Statement>> statements;
@@ -651,7 +723,9 @@ std::unique_ptr<Statement> Parser::parseStatement() {
                     auto callee = std::make_unique<IdentifierExpression>(labelToken.getValue());
                     callee->setLocation(labelToken.getLocation());
                     auto callExpr = std::make_unique<CallExpression>(std::move(callee), std::move(arguments));
-                    return std::make_unique<ExpressionStatement>(std::move(callExpr));
+                    auto stmt = std::make_unique<ExpressionStatement>(std::move(callExpr));
+                    stmt->setLocation(startLocation);
+                    return stmt;
                 } else {
                     // Not a procedure call, create identifier expression and handle postfix operations
                     std::unique_ptr<Expression> expr = std::make_unique<IdentifierExpression>(labelToken.getValue());
@@ -797,6 +871,65 @@ std::unique_ptr<ForStatement> Parser::parseForStatement() {
                                         isDownto, std::move(body));
 }
 
+// Clauses of {$PARALLEL ...}: REDUCTION(op: a, b) with op one of + * min max,
+// and PRIVATE(a, b)
+void Parser::parseParallelClauses(ForStatement& loop, const std::string& clauses) {
+    loop.setParallel(true);
+    size_t pos = 0;
+    auto skipSpace = [&]() {
+        while (pos < clauses.size() && std::isspace(static_cast<unsigned char>(clauses[pos]))) ++pos;
+    };
+    while (true) {
+        skipSpace();
+        if (pos >= clauses.size()) break;
+        size_t open = clauses.find('(', pos);
+        size_t close = open == std::string::npos ? std::string::npos : clauses.find(')', open);
+        if (close == std::string::npos) {
+            addError("Malformed {$PARALLEL} clause: " + clauses.substr(pos));
+            return;
+        }
+        std::string clause = clauses.substr(pos, open - pos);
+        clause.erase(clause.find_last_not_of(" \t") + 1);
+        std::transform(clause.begin(), clause.end(), clause.begin(), ::toupper);
+        std::string body = clauses.substr(open + 1, close - open - 1);
+        pos = close + 1;
+        
+        std::string op;
+        if (clause == "REDUCTION") {
+            size_t colon = body.find(':');
+            if (colon == std::string::npos) {
+                addError("REDUCTION clause needs an operator: REDUCTION(+: variable)");
+                return;
+            }
+            op = body.substr(0, colon);
+            op.erase(0, op.find_first_not_of(" \t"));
+            op.erase(op.find_last_not_of(" \t") + 1);
+            std::transform(op.begin(), op.end(), op.begin(), ::tolower);
+            if (op != "+" && op != "*" && op != "min" && op != "max") {
+                addError("Unsupported reduction operator '" + op + "'; use +, *, min or max");
+                return;
+            }
+            body = body.substr(colon + 1);
+        } else if (clause != "PRIVATE") {
+            addError("Unknown {$PARALLEL} clause: " + clause);
+            return;
+        }
+        
+        std::stringstream names(body);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            if (name.empty()) continue;
+            if (op.empty()) {
+                loop.addPrivate(name);
+            } else {
+                loop.addReduction(op, name);
+            }
+        }
+    }
+}
+
 std::unique_ptr<RepeatStatement> Parser::parseRepeatStatement() {
     // Parse: repeat statements until condition
     // In Pascal, repeat-until can contain multiple statements without BEGIN/END
@@ -917,84 +1050,24 @@ std::unique_ptr<ExpressionStatement> Parser::parseExpressionStatement() {
 }
 
 std::unique_ptr<Expression> Parser::parseExpression() {
-    return parseOrExpression();
-}
-
-std::unique_ptr<Expression> Parser::parseOrExpression() {
-    auto expr = parseAndExpression();
-    
-    while (check(TokenType::OR) || check(TokenType::XOR)) {
-        Token op = currentToken_;
-        advance();
-        auto right = parseAndExpression();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
-    }
-    
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseAndExpression() {
-    auto expr = parseEqualityExpression();
-    
-    while (check(TokenType::AND)) {
-        Token op = currentToken_;
-        advance();
-        auto right = parseEqualityExpression();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
-    }
-    
-    return expr;
+    return parseBinaryExpression(1);
 }
 
-std::unique_ptr<Expression> Parser::parseEqualityExpression() {
-    auto expr = parseRelationalExpression();
-    
-    while (check(TokenType::EQUAL) || check(TokenType::NOT_EQUAL)) {
-        Token op = currentToken_;
-        advance();
-        auto right = parseRelationalExpression();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
-    }
-    
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseRelationalExpression() {
-    auto expr = parseAdditiveExpression();
-    
-    while (check(TokenType::LESS_THAN) || check(TokenType::LESS_EQUAL) ||
-           check(TokenType::GREATER_THAN) || check(TokenType::GREATER_EQUAL) ||
-           check(TokenType::IN)) {
-        Token op = currentToken_;
-        advance();
-        auto right = parseAdditiveExpression();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
-    }
-    
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseAdditiveExpression() {
-    auto expr = parseMultiplicativeExpression();
-    
-    while (check(TokenType::PLUS) || check(TokenType::MINUS)) {
-        Token op = currentToken_;
-        advance();
-        auto right = parseMultiplicativeExpression();
-        expr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
-    }
-    
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseMultiplicativeExpression() {
+// Precedence climbing driven by getOperatorPrecedence. A chain of operators
+// at the same level is folded in the loop; only a tighter operator recurses.
+std::unique_ptr<Expression> Parser::parseBinaryExpression(int minPrecedence) {
     auto expr = parseUnaryExpression();
     
-    while (check(TokenType::MULTIPLY) || check(TokenType::DIVIDE) || 
-           check(TokenType::DIV) || check(TokenType::MOD)) {
+    while (true) {
+        int precedence = getOperatorPrecedence(currentToken_.getType());
+        if (precedence == 0 || precedence < minPrecedence) {
+            break;
+        }
+        
         Token op = currentToken_;
         advance();
-        auto right = parseUnaryExpression();
+        int rightMinPrecedence = isRightAssociative(op.getType()) ? precedence : precedence + 1;
+        auto right = parseBinaryExpression(rightMinPrecedence);
         auto binaryExpr = std::make_unique<BinaryExpression>(std::move(expr), op, std::move(right));
         binaryExpr->setLocation(op.getLocation());
         expr = std::move(binaryExpr);
@@ -1136,6 +1209,13 @@ std::unique_ptr<Expression> Parser::parseCallExpression(std::unique_ptr<Expressi
 }
 
 std::string Parser::parseTypeName() {
+    // Only fixed-size arrays change with 'packed'; records are packed in
+    // their type declaration, anything else is already as small as it gets
+    if (match(TokenType::PACKED)) {
+        std::string packedType = parseTypeName();
+        return packedType.rfind("array[", 0) == 0 ? "packed " + packedType : packedType;
+    }
+    
     // Handle pointer types: ^Type
     if (check(TokenType::CARET)) {
         advance(); // consume '^'
@@ -1240,13 +1320,18 @@ std::string Parser::parseTypeDefinition() {
     // For now, implement a simple type definition parser
     // This will handle basic cases and can be expanded later
     
-    if (check(TokenType::INTEGER_LITERAL) || check(TokenType::CHAR_LITERAL)) {
-        // Range type: 1..10 or 'A'..'Z'
-        Token startToken = currentToken_;
-        advance();
+    if (check(TokenType::INTEGER_LITERAL) || check(TokenType::CHAR_LITERAL) || check(TokenType::MINUS)) {
+        // Range type: 1..10, -5..5 or 'A'..'Z'
+        std::string startSign = match(TokenType::MINUS) ? "-" : "";
+        Token startToken = startSign.empty() ? currentToken_ :
+            consume(TokenType::INTEGER_LITERAL, "Expected integer after '-' in range type");
+        if (startSign.empty()) {
+            advance();
+        }
         consume(TokenType::RANGE, "Expected '..' in range type");
         
         TokenType expectedEndType = startToken.getType();
+        std::string endSign = expectedEndType == TokenType::INTEGER_LITERAL && match(TokenType::MINUS) ? "-" : "";
         Token endToken = consume(expectedEndType, 
             expectedEndType == TokenType::INTEGER_LITERAL ? 
             "Expected integer end value in range type" : 
@@ -1256,7 +1341,7 @@ std::string Parser::parseTypeDefinition() {
         if (startToken.getType() == TokenType::CHAR_LITERAL) {
             return "'" + startToken.getValue() + "'.." + "'" + endToken.getValue() + "'";
         } else {
-            return startToken.getValue() + ".." + endToken.getValue();
+            return startSign + startToken.getValue() + ".." + endSign + endToken.getValue();
         }
     } else if (check(TokenType::LEFT_PAREN)) {
         // Enumeration type: (Red, Green, Blue)
@@ -1435,6 +1520,7 @@ bool Parser::isBinaryOperator() const {
         case TokenType::LESS_EQUAL:
         case TokenType::GREATER_THAN:
         case TokenType::GREATER_EQUAL:
+        case TokenType::IN:
         case TokenType::AND:
         case TokenType::OR:
         case TokenType::XOR:
@@ -1445,26 +1531,30 @@ bool Parser::isBinaryOperator() const {
 }
 
 int Parser::getOperatorPrecedence(TokenType type) const {
+    // 0 means "not a binary operator"; higher binds tighter
     switch (type) {
         case TokenType::OR:
+        case TokenType::XOR:
             return 1;
         case TokenType::AND:
             return 2;
         case TokenType::EQUAL:
         case TokenType::NOT_EQUAL:
+            return 3;
         case TokenType::LESS_THAN:
         case TokenType::LESS_EQUAL:
         case TokenType::GREATER_THAN:
         case TokenType::GREATER_EQUAL:
-            return 3;
+        case TokenType::IN:
+            return 4;
         case TokenType::PLUS:
         case TokenType::MINUS:
-            return 4;
+            return 5;
         case TokenType::MULTIPLY:
         case TokenType::DIVIDE:
         case TokenType::DIV:
         case TokenType::MOD:
-            return 5;
+            return 6;
         default:
             return 0;
     }
@@ -1565,14 +1655,23 @@ std::unique_ptr<GotoStatement> Parser::parseGotoStatement() {
 }
 
 std::unique_ptr<VariantPart> Parser::parseVariantPart() {
-    // Parse: case selector: type of cases
+    // Parse: case selector: type of cases, or the tagless case type of cases
     consume(TokenType::CASE, "Expected 'case'");
     
-    Token selectorToken = consume(TokenType::IDENTIFIER, "Expected selector name");
-    std::string selectorName = selectorToken.getValue();
-    
-    consume(TokenType::COLON, "Expected ':' after selector name");
-    std::string selectorType = parseTypeName();
+    std::string selectorName;
+    std::string selectorType;
+    if (check(TokenType::IDENTIFIER)) {
+        Token selectorToken = currentToken_;
+        advance();
+        if (match(TokenType::COLON)) {
+            selectorName = selectorToken.getValue();
+            selectorType = parseTypeName();
+        } else {
+            selectorType = selectorToken.getValue();
+        }
+    } else {
+        selectorType = parseTypeName();
+    }
     
     consume(TokenType::OF, "Expected 'of' after selector type");
     
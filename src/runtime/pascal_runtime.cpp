@@ -9,8 +9,8 @@
 
 namespace rpascal {
 
-// Global I/O error tracking
-static int g_last_io_error = 0;
+// I/O error tracking, one per thread
+static thread_local int g_last_io_error = 0;
 
 // PascalFile implementation
 void PascalFile::assign(const std::string& filename) {
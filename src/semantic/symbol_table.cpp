@@ -87,6 +87,9 @@ std::shared_ptr<Symbol> Scope::lookupLocal(const std::string& name) {
     if (it != symbols_.end()) {
         return it->second;
     }
+    if (extendsParent_ && parent_) {
+        return parent_->lookupLocal(name);
+    }
     return nullptr;
 }
 
@@ -151,6 +154,12 @@ SymbolTable::SymbolTable() {
     initializeBuiltinSymbols();
 }
 
+SymbolTable::SymbolTable(Scope* baseScope) {
+    // Overlay scope at the same level as the base; built-ins come from the base
+    scopes_.push_back(std::make_unique<Scope>(baseScope->getLevel(), baseScope, true));
+    currentScope_ = scopes_[0].get();
+}
+
 void SymbolTable::enterScope() {
     int newLevel = currentScope_->getLevel() + 1;
     scopes_.push_back(std::make_unique<Scope>(newLevel, currentScope_));
@@ -158,7 +167,8 @@ void SymbolTable::enterScope() {
 }
 
 void SymbolTable::exitScope() {
-    if (currentScope_->getParent()) {
+    // Never leave this table's own root scope
+    if (scopes_.size() > 1) {
         currentScope_ = currentScope_->getParent();
         // Remove the last scope
         scopes_.pop_back();
@@ -176,7 +186,8 @@ void SymbolTable::define(const std::string& name, SymbolType symbolType, DataTyp
 
 void SymbolTable::define(const std::string& name, std::shared_ptr<Symbol> symbol) {
     // Check if symbol already exists in current scope
-    if (currentScope_->lookupLocal(name)) {
+    auto existing = currentScope_->lookupLocal(name);
+    if (existing && !existing->isPredeclared()) {
         addError("Symbol '" + name + "' already defined in current scope");
         return;
     }
@@ -221,6 +232,10 @@ DataType SymbolTable::stringToDataType(const std::string& typeStr) {
     
     if (lowerType == "integer") return DataType::INTEGER;
     if (lowerType == "real") return DataType::REAL;
+    // The predeclared real types share real's checks; only their storage differs
+    if (lowerType == "single" || lowerType == "double" || lowerType == "extended" || lowerType == "comp") {
+        return DataType::REAL;
+    }
     if (lowerType == "boolean") return DataType::BOOLEAN;
     if (lowerType == "char") return DataType::CHAR;
     if (lowerType == "byte") return DataType::BYTE;
@@ -244,8 +259,8 @@ DataType SymbolTable::resolveDataType(const std::string& typeStr) {
         return builtinType;
     }
     
-    // Check for array types: array[...] of Type
-    if (typeStr.find("array") == 0 && typeStr.find(" of ") != std::string::npos) {
+    // Check for array types: array[...] of Type, optionally packed
+    if ((typeStr.find("array") == 0 || typeStr.find("packed array") == 0) && typeStr.find(" of ") != std::string::npos) {
         return DataType::CUSTOM; // Arrays are treated as custom types
     }
     
@@ -318,6 +333,15 @@ void SymbolTable::printAllScopes() const {
 }
 
 void SymbolTable::initializeBuiltinSymbols() {
+    // Predeclared real types besides the real keyword. Like in Turbo Pascal
+    // they are identifiers, so programs may reuse the names
+    for (const char* realType : {"single", "double", "extended", "comp"}) {
+        auto typeSymbol = std::make_shared<Symbol>(realType, SymbolType::TYPE_DEF, DataType::REAL, 0);
+        typeSymbol->setTypeDefinition(realType);
+        typeSymbol->setPredeclared(true);
+        define(realType, typeSymbol);
+    }
+    
     // Built-in procedures
     auto writeln = std::make_shared<Symbol>("writeln", SymbolType::PROCEDURE, DataType::VOID, 0);
     // writeln can take variable arguments, we'll handle this specially in semantic analysis
@@ -1,6 +1,8 @@
 #include "../include/type_checker.h"
 #include <algorithm>
+#include <functional>
 #include <iostream>
+#include <set>
 
 namespace rpascal {
 
@@ -11,6 +13,22 @@ SemanticAnalyzer::SemanticAnalyzer(std::shared_ptr<SymbolTable> symbolTable)
 bool SemanticAnalyzer::analyze(Program& program) {
     errors_.clear();
     program.accept(*this);
+    markNoAliasParameters();
+    applyAutoParallel();
+    
+    // Combine errors from symbol table
+    if (symbolTable_->hasErrors()) {
+        for (const auto& error : symbolTable_->getErrors()) {
+            errors_.push_back(error);
+        }
+    }
+    
+    return !hasErrors();
+}
+
+bool SemanticAnalyzer::analyzeUnit(Unit& unit) {
+    errors_.clear();
+    unit.accept(*this);
     
     // Combine errors from symbol table
     if (symbolTable_->hasErrors()) {
@@ -125,6 +143,7 @@ void SemanticAnalyzer::visit(IdentifierExpression& node) {
                     }
                 }
                 
+                trackAliasCall(overloadSymbol.get(), {});
                 if (overloadSymbol->getSymbolType() == SymbolType::PROCEDURE) {
                     if (overloadSymbol->getParameters().empty()) {
                         // This is a parameterless procedure call
@@ -178,6 +197,7 @@ void SemanticAnalyzer::visit(IdentifierExpression& node) {
         currentExpressionType_ = symbol->getReturnType();
         currentExpressionTypeName_ = "";
     } else {
+        trackAliasGlobal(&node);
         currentExpressionType_ = symbol->getDataType();
         // For custom types and pointer types, also store the type name
         if (symbol->getDataType() == DataType::CUSTOM || symbol->getDataType() == DataType::POINTER) {
@@ -312,6 +332,9 @@ void SemanticAnalyzer::visit(UnaryExpression& node) {
 }
 
 void SemanticAnalyzer::visit(AddressOfExpression& node) {
+    if (aliasTracking_) {
+        escapedObjects_.push_back({aliasRoutine_, aliasObject(node.getOperand())});
+    }
     node.getOperand()->accept(*this);
     DataType operandType = currentExpressionType_;
     
@@ -434,7 +457,7 @@ void SemanticAnalyzer::visit(FieldAccessExpression& node) {
             // For array indexing, we need to find the element type of the array
             if (auto arrayIdent = dynamic_cast<IdentifierExpression*>(arrayIndexExpr->getArray())) {
                 auto arraySymbol = symbolTable_->lookup(arrayIdent->getName());
-                if (arraySymbol && arraySymbol->getSymbolType() == SymbolType::VARIABLE) {
+                if (arraySymbol && (arraySymbol->getSymbolType() == SymbolType::VARIABLE || arraySymbol->getSymbolType() == SymbolType::PARAMETER)) {
                     // For arrays of records, the element type is the record type
                     // The currentExpressionType_ should already be set to the element type
                     // and currentExpressionTypeName_ should contain the type name
@@ -486,6 +509,10 @@ void SemanticAnalyzer::visit(ArrayIndexExpression& node) {
     node.getArray()->accept(*this);
     DataType arrayType = currentExpressionType_;
     std::string arrayTypeName = currentExpressionTypeName_;
+    // Packing changes storage only, not element types
+    if (arrayTypeName.rfind("packed ", 0) == 0) {
+        arrayTypeName.erase(0, 7);
+    }
     
     node.getIndex()->accept(*this);
     DataType indexType = currentExpressionType_;
@@ -531,6 +558,9 @@ void SemanticAnalyzer::visit(ArrayIndexExpression& node) {
                 auto arrayTypeSymbol = symbolTable_->lookup(arrayTypeName);
                 if (arrayTypeSymbol && arrayTypeSymbol->getSymbolType() == SymbolType::TYPE_DEF) {
                     std::string arrayDef = arrayTypeSymbol->getTypeDefinition();
+                    if (arrayDef.rfind("packed ", 0) == 0) {
+                        arrayDef.erase(0, 7);
+                    }
                     // Parse array definition like "array[0..9] of char" or "array of char"
                     if (arrayDef.find("array") == 0 && arrayDef.find(" of ") != std::string::npos) {
                         size_t ofPos = arrayDef.find(" of ");
@@ -681,6 +711,18 @@ void SemanticAnalyzer::visit(FormattedExpression& node) {
 
 void SemanticAnalyzer::visit(ExpressionStatement& node) {
     node.getExpression()->accept(*this);
+    
+    auto call = dynamic_cast<CallExpression*>(node.getExpression());
+    auto callee = call ? dynamic_cast<IdentifierExpression*>(call->getCallee()) : nullptr;
+    if (parallelLoop_ && callee) {
+        std::string name = callee->getName();
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (name == "exit") {
+            addError("Exit cannot leave a parallel for loop", node.getLocation());
+        } else if ((name == "inc" || name == "dec") && !call->getArguments().empty()) {
+            checkParallelWrite(call->getArguments()[0].get(), node.getLocation());
+        }
+    }
 }
 
 void SemanticAnalyzer::visit(CompoundStatement& node) {
@@ -694,6 +736,9 @@ void SemanticAnalyzer::visit(AssignmentStatement& node) {
     node.getTarget()->accept(*this);
     
     checkAssignment(node.getTarget(), node.getValue(), node.getLocation());
+    if (parallelLoop_) {
+        checkParallelWrite(node.getTarget(), node.getLocation());
+    }
 }
 
 void SemanticAnalyzer::visit(IfStatement& node) {
@@ -720,7 +765,9 @@ void SemanticAnalyzer::visit(WhileStatement& node) {
     }
     
     // Check body
+    ++parallelNesting_;
     node.getBody()->accept(*this);
+    --parallelNesting_;
 }
 
 void SemanticAnalyzer::visit(ForStatement& node) {
@@ -787,13 +834,635 @@ void SemanticAnalyzer::visit(ForStatement& node) {
         addError("For loop end expression type doesn't match variable type");
     }
     
+    // A loop inside a parallel loop's body runs within one iteration, so its
+    // control variable becomes private to the chunk
+    if (parallelLoop_ && parallelLoop_ != &node) {
+        const auto& privates = parallelLoop_->getPrivates();
+        if (std::find(privates.begin(), privates.end(), node.getVariable()) == privates.end()) {
+            parallelLoop_->addPrivate(node.getVariable());
+        }
+    }
+    
     // Check body
-    node.getBody()->accept(*this);
+    if (node.isParallel()) {
+        checkParallelLoop(node);
+        ForStatement* outerLoop = parallelLoop_;
+        int outerNesting = parallelNesting_;
+        parallelLoop_ = &node;
+        parallelNesting_ = 0;
+        node.getBody()->accept(*this);
+        parallelLoop_ = outerLoop;
+        parallelNesting_ = outerNesting;
+    } else {
+        // --auto-parallel looks at outer loops of the program's own code
+        AutoParallelLoop* outerCandidate = autoParallelLoop_;
+        if (autoParallel_ && aliasTracking_ && !parallelLoop_ && parallelNesting_ == 0 && !autoParallelLoop_) {
+            auto candidate = std::make_unique<AutoParallelLoop>();
+            candidate->loop = &node;
+            candidate->routine = aliasRoutine_;
+            candidate->blocker = autoParallelBlocker(node, *candidate);
+            autoParallelLoop_ = candidate.get();
+            autoParallelLoops_.push_back(std::move(candidate));
+        }
+        ++parallelNesting_;
+        node.getBody()->accept(*this);
+        --parallelNesting_;
+        autoParallelLoop_ = outerCandidate;
+    }
+}
+
+// Reductions must name numeric variables, and nothing may be both reduced
+// and private
+void SemanticAnalyzer::checkParallelLoop(ForStatement& node) {
+    std::set<std::string> seen;
+    auto lower = [](std::string name) {
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        return name;
+    };
+    for (const auto& reduction : node.getReductions()) {
+        auto symbol = symbolTable_->lookup(reduction.variable);
+        if (!symbol || (symbol->getSymbolType() != SymbolType::VARIABLE && symbol->getSymbolType() != SymbolType::PARAMETER)) {
+            addError("Reduction variable '" + reduction.variable + "' is not a variable", node.getLocation());
+        } else if (symbol->getDataType() != DataType::INTEGER && symbol->getDataType() != DataType::REAL) {
+            addError("Reduction variable '" + reduction.variable + "' must be an integer or real", node.getLocation());
+        }
+        if (!seen.insert(lower(reduction.variable)).second) {
+            addError("'" + reduction.variable + "' appears in more than one parallel clause", node.getLocation());
+        }
+    }
+    for (const auto& name : node.getPrivates()) {
+        if (!symbolTable_->lookup(name)) {
+            addError("Undefined private variable: " + name, node.getLocation());
+        }
+        if (!seen.insert(lower(name)).second) {
+            addError("'" + name + "' appears in more than one parallel clause", node.getLocation());
+        }
+    }
+}
+
+// Iterations of a parallel loop run concurrently: assigning a plain variable
+// that every iteration shares is a race unless it is a reduction, private,
+// or the loop's own control variable
+void SemanticAnalyzer::checkParallelWrite(Expression* target, const SourceLocation& location) {
+    auto identifier = dynamic_cast<IdentifierExpression*>(target);
+    if (!identifier || identifier->isWithFieldAccess()) {
+        return;
+    }
+    auto sameName = [](std::string a, std::string b) {
+        std::transform(a.begin(), a.end(), a.begin(), ::tolower);
+        std::transform(b.begin(), b.end(), b.begin(), ::tolower);
+        return a == b;
+    };
+    const std::string& name = identifier->getName();
+    if (sameName(name, parallelLoop_->getVariable())) {
+        addError("Parallel for loop assigns its control variable '" + name + "'", location);
+        return;
+    }
+    for (const auto& reduction : parallelLoop_->getReductions()) {
+        if (sameName(name, reduction.variable)) return;
+    }
+    for (const auto& privateName : parallelLoop_->getPrivates()) {
+        if (sameName(name, privateName)) return;
+    }
+    addError("Parallel for loop writes shared variable '" + name + "' in every iteration; declare it in "
+             "{$PARALLEL REDUCTION(op: " + name + ")} or {$PARALLEL PRIVATE(" + name + ")}", location);
+}
+
+void SemanticAnalyzer::trackAliasRoutine(const Symbol* routine, const std::vector<std::unique_ptr<VariableDeclaration>>& parameters) {
+    if (aliasTracking_ && routine) {
+        aliasRoutines_[routine].declarations.push_back(&parameters);
+    }
+}
+
+void SemanticAnalyzer::trackAliasCall(const Symbol* callee, const std::vector<std::unique_ptr<Expression>>& arguments) {
+    if (!aliasTracking_) {
+        return;
+    }
+    if (aliasRoutine_) {
+        aliasRoutines_[aliasRoutine_].callees.insert(callee);
+    }
+    if (autoParallelLoop_) {
+        autoParallelLoop_->callees.insert(callee);
+    }
+    auto it = aliasRoutines_.find(callee);
+    if (it == aliasRoutines_.end() || it->second.declarations.empty()) {
+        return;
+    }
+    const auto& parameters = *it->second.declarations.back();
+    AliasCall call{aliasRoutine_, callee, {}};
+    for (size_t i = 0; i < arguments.size() && i < parameters.size(); ++i) {
+        bool byReference = parameters[i]->getParameterMode() != ParameterMode::VALUE;
+        call.objects.push_back(byReference ? aliasObject(arguments[i].get()) : "");
+    }
+    aliasCalls_.push_back(std::move(call));
+}
+
+void SemanticAnalyzer::trackAliasGlobal(Expression* expr) {
+    if (!aliasTracking_ || !aliasRoutine_) {
+        return;
+    }
+    std::string object = aliasObject(expr);
+    if (object.rfind("global:", 0) == 0) {
+        aliasRoutines_[aliasRoutine_].globals.insert(object);
+    }
+}
+
+std::string SemanticAnalyzer::aliasObject(Expression* expr) {
+    // The variable an element or field belongs to
+    while (true) {
+        if (auto index = dynamic_cast<ArrayIndexExpression*>(expr)) {
+            expr = index->getArray();
+        } else if (auto field = dynamic_cast<FieldAccessExpression*>(expr)) {
+            expr = field->getObject();
+        } else {
+            break;
+        }
+    }
+    auto identifier = dynamic_cast<IdentifierExpression*>(expr);
+    if (!identifier) {
+        return "*";
+    }
+    std::string name = identifier->isWithFieldAccess() ? identifier->getWithVariable() : identifier->getName();
+    auto symbol = symbolTable_->lookup(name);
+    if (!symbol || (symbol->getSymbolType() != SymbolType::VARIABLE &&
+                    symbol->getSymbolType() != SymbolType::PARAMETER)) {
+        return "*";
+    }
+    if (!aliasRoutine_ || !symbolTable_->lookupLocal(name)) {
+        return "global:" + symbol->getName();
+    }
+    if (symbol->getSymbolType() == SymbolType::PARAMETER) {
+        const auto& parameters = *aliasRoutines_[aliasRoutine_].declarations.back();
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            if (parameters[i]->getName() == symbol->getName() &&
+                parameters[i]->getParameterMode() != ParameterMode::VALUE) {
+                return "%" + std::to_string(i);
+            }
+        }
+    }
+    return "local:" + aliasRoutine_->getName() + "." + symbol->getName();
+}
+
+void SemanticAnalyzer::markNoAliasParameters() {
+    for (auto& entry : aliasRoutines_) {
+        entry.second.objects.assign(entry.second.declarations.back()->size(), {});
+    }
+    
+    // What an argument refers to, with the caller's reference parameters
+    // replaced by everything they may refer to
+    auto expand = [&](const Symbol* caller, const std::string& object, std::set<std::string>& into) {
+        if (object.empty() || object[0] != '%') {
+            into.insert(object);
+            return;
+        }
+        auto it = aliasRoutines_.find(caller);
+        size_t index = std::stoul(object.substr(1));
+        if (it == aliasRoutines_.end() || index >= it->second.objects.size()) {
+            into.insert("*");
+            return;
+        }
+        into.insert(it->second.objects[index].begin(), it->second.objects[index].end());
+    };
+    
+    // Push what each call passes down the call graph until nothing changes
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto& call : aliasCalls_) {
+            auto& callee = aliasRoutines_[call.callee];
+            for (size_t i = 0; i < call.objects.size() && i < callee.objects.size(); ++i) {
+                if (call.objects[i].empty()) continue;
+                std::set<std::string> passed;
+                expand(call.caller, call.objects[i], passed);
+                for (const auto& object : passed) {
+                    changed = callee.objects[i].insert(object).second || changed;
+                }
+            }
+        }
+    }
+    
+    std::set<std::string> escaped;
+    for (const auto& [routine, object] : escapedObjects_) {
+        expand(routine, object, escaped);
+    }
+    
+    // Parameters that share an object with another reference argument of some call
+    std::set<std::pair<const Symbol*, size_t>> conflicts;
+    for (const auto& call : aliasCalls_) {
+        for (size_t i = 0; i < call.objects.size(); ++i) {
+            if (call.objects[i].empty()) continue;
+            std::set<std::string> mine;
+            expand(call.caller, call.objects[i], mine);
+            for (size_t k = 0; k < call.objects.size(); ++k) {
+                if (k == i || call.objects[k].empty()) continue;
+                std::set<std::string> theirs;
+                expand(call.caller, call.objects[k], theirs);
+                for (const auto& object : mine) {
+                    if (object == "*" || theirs.count(object) || theirs.count("*")) {
+                        conflicts.insert({call.callee, i});
+                    }
+                }
+            }
+        }
+    }
+    
+    // Globals named by a routine or anything it calls; "*" when it calls into units
+    std::function<void(const Symbol*, std::set<const Symbol*>&, std::set<std::string>&)> reach =
+        [&](const Symbol* routine, std::set<const Symbol*>& seen, std::set<std::string>& globals) {
+            if (!seen.insert(routine).second) return;
+            auto it = aliasRoutines_.find(routine);
+            if (it == aliasRoutines_.end()) {
+                globals.insert("*");
+                return;
+            }
+            globals.insert(it->second.globals.begin(), it->second.globals.end());
+            for (const Symbol* callee : it->second.callees) {
+                reach(callee, seen, globals);
+            }
+        };
+    
+    for (auto& [symbol, routine] : aliasRoutines_) {
+        std::set<const Symbol*> seen;
+        std::set<std::string> globals;
+        reach(symbol, seen, globals);
+        const auto& parameters = *routine.declarations.back();
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            if (parameters[i]->getParameterMode() != ParameterMode::VAR ||
+                !isFixedArrayType(parameters[i]->getType()) || conflicts.count({symbol, i})) {
+                continue;
+            }
+            bool noAlias = true;
+            for (const auto& object : routine.objects[i]) {
+                if (object == "*" || escaped.count(object) || globals.count(object) ||
+                    (globals.count("*") && object.rfind("global:", 0) == 0)) {
+                    noAlias = false;
+                }
+            }
+            if (noAlias) {
+                for (const auto* declaration : routine.declarations) {
+                    if (i < declaration->size()) {
+                        (*declaration)[i]->setNoAlias(true);
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool SemanticAnalyzer::isFixedArrayType(std::string type) {
+    for (int depth = 0; depth < 8; ++depth) {
+        std::string lowerType = type;
+        std::transform(lowerType.begin(), lowerType.end(), lowerType.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (lowerType.rfind("array[", 0) == 0 || lowerType.rfind("packed array[", 0) == 0) return true;
+        auto symbol = symbolTable_->lookup(type);
+        if (!symbol || symbol->getSymbolType() != SymbolType::TYPE_DEF ||
+            symbol->getTypeDefinition().empty() || symbol->getTypeDefinition() == type) {
+            return false;
+        }
+        type = symbol->getTypeDefinition();
+    }
+    return false;
+}
+
+// Builtins a parallel iteration may call; routines may also update their own
+// locals through the ones in localBuiltins
+namespace {
+const std::set<std::string> pureBuiltins = {
+    "abs", "sqr", "sqrt", "sin", "cos", "tan", "arctan", "ln", "exp", "power", "round", "trunc",
+    "length", "chr", "ord", "succ", "pred", "pos", "copy", "concat", "upcase", "lowercase", "uppercase",
+    "trim", "trimleft", "trimright", "stringofchar", "leftstr", "rightstr", "padleft", "padright",
+    "inttostr", "floattostr"
+};
+const std::set<std::string> localBuiltins = {"inc", "dec", "str", "val", "insert", "delete", "exit"};
+}
+
+void SemanticAnalyzer::trackAliasBuiltin(const std::string& functionName) {
+    std::string name = functionName;
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (pureBuiltins.count(name)) {
+        return;
+    }
+    if (autoParallelLoop_ && autoParallelLoop_->blocker.empty()) {
+        autoParallelLoop_->blocker = "calls " + functionName;
+    }
+    if (aliasTracking_ && aliasRoutine_ && !localBuiltins.count(name)) {
+        auto& routine = aliasRoutines_[aliasRoutine_];
+        if (routine.impurity.empty()) {
+            routine.impurity = "calls " + functionName;
+        }
+    }
+}
+
+// Why the iterations of an outer for loop might interfere, as far as its own
+// statements show; "" if they don't. An iteration may assign only elements
+// whose first index is the control variable (or inner loop control
+// variables, which become private), and an array it writes may only be
+// touched at that element. Arrays used at other elements make every
+// reference parameter involved need to be unaliased
+std::string SemanticAnalyzer::autoParallelBlocker(ForStatement& node, AutoParallelLoop& loop) {
+    auto lower = [](std::string name) {
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        return name;
+    };
+    const std::string control = lower(node.getVariable());
+    std::set<std::string> inner;       // inner loop control variables
+    std::set<std::string> written;     // arrays assigned at the control variable's element
+    std::set<std::string> elsewhere;   // variables used other than at that element
+    std::map<std::string, std::shared_ptr<Symbol>> variables;
+    std::string blocker;
+    bool work = false;                 // inner loops or routine calls, not just straight-line code
+    int depth = 0;                     // inner loops around the current statement
+    
+    auto block = [&](const std::string& reason) {
+        if (blocker.empty()) blocker = reason;
+    };
+    auto use = [&](const std::string& name, bool atElement) {
+        std::string key = lower(name);
+        if (key == control || inner.count(key)) return;
+        auto symbol = symbolTable_->lookup(name);
+        if (!symbol || (symbol->getSymbolType() != SymbolType::VARIABLE &&
+                        symbol->getSymbolType() != SymbolType::PARAMETER)) {
+            return;
+        }
+        variables[key] = symbol;
+        if (!atElement) elsewhere.insert(key);
+    };
+    
+    std::function<void(const Expression*)> read;
+    // The variable at the root of a chain of indexes and fields, and whether
+    // the index nearest that root is the control variable
+    auto access = [&](const Expression* expr, bool& atElement) -> const IdentifierExpression* {
+        atElement = false;
+        while (true) {
+            if (auto index = dynamic_cast<const ArrayIndexExpression*>(expr)) {
+                for (const auto& value : index->getIndices()) {
+                    read(value.get());
+                }
+                auto identifier = dynamic_cast<const IdentifierExpression*>(index->getIndex());
+                atElement = identifier && lower(identifier->getName()) == control;
+                expr = index->getArray();
+            } else if (auto field = dynamic_cast<const FieldAccessExpression*>(expr)) {
+                expr = field->getObject();
+            } else if (auto identifier = dynamic_cast<const IdentifierExpression*>(expr)) {
+                return identifier;
+            } else {
+                read(expr);
+                return nullptr;
+            }
+        }
+    };
+    read = [&](const Expression* expr) {
+        if (!expr || dynamic_cast<const LiteralExpression*>(expr)) {
+            return;
+        }
+        if (dynamic_cast<const ArrayIndexExpression*>(expr) || dynamic_cast<const FieldAccessExpression*>(expr) ||
+            dynamic_cast<const IdentifierExpression*>(expr)) {
+            bool atElement = false;
+            if (auto root = access(expr, atElement)) {
+                use(root->isWithFieldAccess() ? root->getWithVariable() : root->getName(), atElement);
+            }
+        } else if (auto binary = dynamic_cast<const BinaryExpression*>(expr)) {
+            read(binary->getLeft());
+            read(binary->getRight());
+        } else if (auto unary = dynamic_cast<const UnaryExpression*>(expr)) {
+            read(unary->getOperand());
+        } else if (auto call = dynamic_cast<const CallExpression*>(expr)) {
+            auto callee = dynamic_cast<const IdentifierExpression*>(call->getCallee());
+            if (callee && !isBuiltinFunction(callee->getName())) work = true;
+            for (const auto& argument : call->getArguments()) {
+                read(argument.get());
+            }
+        } else if (auto set = dynamic_cast<const SetLiteralExpression*>(expr)) {
+            for (const auto& element : set->getElements()) {
+                read(element.get());
+            }
+        } else if (auto range = dynamic_cast<const RangeExpression*>(expr)) {
+            read(range->getStart());
+            read(range->getEnd());
+        } else if (auto formatted = dynamic_cast<const FormattedExpression*>(expr)) {
+            read(formatted->getExpression());
+            read(formatted->getWidth());
+            read(formatted->getPrecision());
+        } else if (auto dereference = dynamic_cast<const DereferenceExpression*>(expr)) {
+            read(dereference->getOperand());
+        } else if (dynamic_cast<const AddressOfExpression*>(expr)) {
+            block("takes the address of a variable");
+        }
+    };
+    
+    std::function<void(const Statement*)> check = [&](const Statement* statement) {
+        if (!statement) {
+            return;
+        }
+        if (auto compound = dynamic_cast<const CompoundStatement*>(statement)) {
+            for (const auto& inside : compound->getStatements()) {
+                check(inside.get());
+            }
+        } else if (auto assignment = dynamic_cast<const AssignmentStatement*>(statement)) {
+            bool atElement = false;
+            auto root = access(assignment->getTarget(), atElement);
+            if (!root) {
+                block("writes through a pointer");
+            } else if (root->isWithFieldAccess()) {
+                block("assigns a with field");
+            } else if (!dynamic_cast<const ArrayIndexExpression*>(assignment->getTarget()) &&
+                       !dynamic_cast<const FieldAccessExpression*>(assignment->getTarget())) {
+                block("assigns shared variable " + root->getName());
+            } else if (!atElement) {
+                block("writes " + root->getName() + " other than at element [" + node.getVariable() + "]");
+            } else {
+                written.insert(lower(root->getName()));
+                use(root->getName(), true);
+            }
+            read(assignment->getValue());
+        } else if (auto ifStatement = dynamic_cast<const IfStatement*>(statement)) {
+            read(ifStatement->getCondition());
+            check(ifStatement->getThenStatement());
+            check(ifStatement->getElseStatement());
+        } else if (auto forStatement = dynamic_cast<const ForStatement*>(statement)) {
+            work = true;
+            if (inner.insert(lower(forStatement->getVariable())).second) {
+                loop.privates.push_back(forStatement->getVariable());
+            }
+            read(forStatement->getStart());
+            read(forStatement->getEnd());
+            ++depth;
+            check(forStatement->getBody());
+            --depth;
+        } else if (auto whileStatement = dynamic_cast<const WhileStatement*>(statement)) {
+            work = true;
+            read(whileStatement->getCondition());
+            ++depth;
+            check(whileStatement->getBody());
+            --depth;
+        } else if (auto repeatStatement = dynamic_cast<const RepeatStatement*>(statement)) {
+            work = true;
+            ++depth;
+            check(repeatStatement->getBody());
+            --depth;
+            read(repeatStatement->getCondition());
+        } else if (auto caseStatement = dynamic_cast<const CaseStatement*>(statement)) {
+            read(caseStatement->getExpression());
+            for (const auto& branch : caseStatement->getBranches()) {
+                check(branch->getStatement());
+            }
+            check(caseStatement->getElseClause());
+        } else if (auto expression = dynamic_cast<const ExpressionStatement*>(statement)) {
+            read(expression->getExpression());
+        } else if (dynamic_cast<const BreakStatement*>(statement) || dynamic_cast<const ContinueStatement*>(statement)) {
+            if (depth == 0) block("leaves an iteration with break or continue");
+        } else if (dynamic_cast<const WithStatement*>(statement)) {
+            block("uses with");
+        } else {
+            block("uses goto or a label");
+        }
+    };
+    
+    read(node.getStart());
+    read(node.getEnd());
+    check(node.getBody());
+    if (!blocker.empty()) {
+        return blocker;
+    }
+    
+    for (const auto& name : written) {
+        if (elsewhere.count(name)) {
+            return "uses " + variables[name]->getName() + " at other elements than the one it writes";
+        }
+    }
+    
+    // A written array could be a var parameter sharing storage with a global
+    // array or another parameter used at other elements, or a reference
+    // parameter could share storage with a written element
+    auto parameter = [&](const std::shared_ptr<Symbol>& symbol) -> const VariableDeclaration* {
+        if (symbol->getSymbolType() != SymbolType::PARAMETER || !aliasRoutine_) return nullptr;
+        for (const auto& declaration : *aliasRoutines_[aliasRoutine_].declarations.back()) {
+            if (declaration->getName() == symbol->getName()) return declaration.get();
+        }
+        return nullptr;
+    };
+    auto byReference = [&](const std::shared_ptr<Symbol>& symbol) {
+        auto declaration = parameter(symbol);
+        return declaration && declaration->getParameterMode() != ParameterMode::VALUE;
+    };
+    bool shared = false;
+    for (const auto& name : elsewhere) {
+        const auto& symbol = variables[name];
+        if (byReference(symbol)) {
+            loop.mustNotAlias.push_back(parameter(symbol));
+            shared = true;
+        } else if (!symbolTable_->lookupLocal(symbol->getName()) && isFixedArrayType(symbol->getTypeName())) {
+            shared = true;
+        }
+    }
+    if (shared) {
+        for (const auto& name : written) {
+            if (byReference(variables[name])) {
+                loop.mustNotAlias.push_back(parameter(variables[name]));
+            }
+        }
+    }
+    
+    // Thread start-up costs more than a few thousand simple iterations
+    auto start = dynamic_cast<LiteralExpression*>(node.getStart());
+    auto end = dynamic_cast<LiteralExpression*>(node.getEnd());
+    if (!work && start && end && start->getToken().getType() == TokenType::INTEGER_LITERAL &&
+        end->getToken().getType() == TokenType::INTEGER_LITERAL) {
+        long long count = std::stoll(end->getToken().getValue()) - std::stoll(start->getToken().getValue()) + 1;
+        if (node.isDownto()) count = 2 - count;
+        if (count < AUTO_PARALLEL_MIN_ITERATIONS) {
+            return "only " + std::to_string(std::max(0LL, count)) + " iterations of straight-line code";
+        }
+    }
+    return "";
+}
+
+// Decide the loops: routines are pure unless something they do, or anything
+// they call, could interfere with another iteration
+void SemanticAnalyzer::applyAutoParallel() {
+    std::map<const Symbol*, std::string> impure;
+    for (const auto& [symbol, routine] : aliasRoutines_) {
+        for (const auto& parameter : *routine.declarations.back()) {
+            if (parameter->getParameterMode() == ParameterMode::VAR && impure[symbol].empty()) {
+                impure[symbol] = "takes var parameter " + parameter->getName();
+            }
+        }
+        if (impure[symbol].empty() && !routine.globals.empty()) {
+            impure[symbol] = "uses global " + routine.globals.begin()->substr(7);
+        }
+        if (impure[symbol].empty()) {
+            impure[symbol] = routine.impurity;
+        }
+    }
+    auto reason = [&](const Symbol* callee) -> std::string {
+        auto it = impure.find(callee);
+        return it == impure.end() ? "is not one of the program's routines" : it->second;
+    };
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto& [symbol, routine] : aliasRoutines_) {
+            if (!impure[symbol].empty()) continue;
+            for (const Symbol* callee : routine.callees) {
+                if (!reason(callee).empty()) {
+                    impure[symbol] = "calls " + callee->getName();
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+    
+    for (auto& candidate : autoParallelLoops_) {
+        std::string blocker = candidate->blocker;
+        for (const Symbol* callee : candidate->callees) {
+            if (blocker.empty() && !reason(callee).empty()) {
+                blocker = "calls " + callee->getName() + ", which " + reason(callee);
+            }
+        }
+        for (const auto* parameter : candidate->mustNotAlias) {
+            if (blocker.empty() && !parameter->isNoAlias()) {
+                blocker = parameter->getName() + " may share storage with another array";
+            }
+        }
+        
+        ForStatement& loop = *candidate->loop;
+        std::string where = "line " + std::to_string(loop.getLocation().line) + ", " +
+                            (candidate->routine ? candidate->routine->getName() : std::string("program")) +
+                            ": for " + loop.getVariable();
+        if (!blocker.empty()) {
+            autoParallelReport_.push_back(where + " not parallelised: " + blocker);
+            continue;
+        }
+        loop.setParallel(true);
+        for (const auto& name : candidate->privates) {
+            loop.addPrivate(name);
+        }
+        std::string privates;
+        for (const auto& name : candidate->privates) {
+            privates += (privates.empty() ? " (private " : ", ") + name;
+        }
+        autoParallelReport_.push_back(where + " parallelised" + (privates.empty() ? "" : privates + ")"));
+    }
+}
+
+std::string SemanticAnalyzer::getAutoParallelReport() const {
+    std::string report = "Auto-parallelisation report\n";
+    if (autoParallelReport_.empty()) {
+        report += "  no outer for loops\n";
+    }
+    for (const auto& line : autoParallelReport_) {
+        report += "  " + line + "\n";
+    }
+    return report;
 }
 
 void SemanticAnalyzer::visit(RepeatStatement& node) {
     // Check body
+    ++parallelNesting_;
     node.getBody()->accept(*this);
+    --parallelNesting_;
     
     // Check condition - must be boolean
     node.getCondition()->accept(*this);
@@ -833,7 +1502,8 @@ void SemanticAnalyzer::visit(CaseStatement& node) {
 
 void SemanticAnalyzer::visit(WithStatement& node) {
     // Check all with expressions and set up with contexts
-    for (const auto& withExpr : node.getWithExpressions()) {
+    for (size_t i = 0; i < node.getWithExpressions().size(); ++i) {
+        const auto& withExpr = node.getWithExpressions()[i];
         withExpr->accept(*this);
         
         // Try to extract the with variable and its type
@@ -855,8 +1525,19 @@ void SemanticAnalyzer::visit(WithStatement& node) {
             } else {
                 addError("Undefined with variable: " + varName);
             }
+        } else if (currentExpressionType_ == DataType::CUSTOM && !currentExpressionTypeName_.empty()) {
+            // with a[i] do / with p.address do: the record is evaluated once
+            // into an alias and fields in the body refer to that
+            WithContext context;
+            context.withVariable = "pascal_with_" + std::to_string(withAliasCount_++);
+            context.recordType = DataType::CUSTOM;
+            context.recordTypeName = currentExpressionTypeName_;
+            node.setAlias(i, context.withVariable);
+            withContextStack_.push_back(context);
+        } else {
+            // Keep the stack in step with the expressions popped below
+            withContextStack_.push_back(WithContext{"", "", DataType::UNKNOWN});
         }
-        // TODO: Handle more complex with expressions like field access
     }
     
     // Check the body statement with the with context active
@@ -879,6 +1560,10 @@ void SemanticAnalyzer::visit(LabelStatement& node) {
 }
 
 void SemanticAnalyzer::visit(GotoStatement& node) {
+    if (parallelLoop_) {
+        addError("Goto cannot be used inside a parallel for loop", node.getLocation());
+    }
+    
     // Track referenced labels for validation
     const std::string& target = node.getTarget();
     referencedLabels_.push_back(target);
@@ -890,9 +1575,11 @@ void SemanticAnalyzer::visit(GotoStatement& node) {
 }
 
 void SemanticAnalyzer::visit(BreakStatement& node) {
-    (void)node; // Suppress unused parameter warning
     // Break is only valid inside loops
     // For now, we'll allow it - validation could be added later
+    if (parallelLoop_ && parallelNesting_ == 0) {
+        addError("Break cannot leave a parallel for loop", node.getLocation());
+    }
 }
 
 void SemanticAnalyzer::visit(ContinueStatement& node) {
@@ -996,8 +1683,10 @@ void SemanticAnalyzer::visit(RecordTypeDefinition& node) {
     if (node.hasVariantPart()) {
         const VariantPart* variantPart = node.getVariantPart();
         
-        // Add the selector field
-        recordDef += variantPart->getSelectorName() + ":" + variantPart->getSelectorType() + "; ";
+        // Add the selector field (tagless variant parts have none)
+        if (!variantPart->getSelectorName().empty()) {
+            recordDef += variantPart->getSelectorName() + ":" + variantPart->getSelectorType() + "; ";
+        }
         
         // Add all variant case fields (all fields from all cases are accessible)
         for (const auto& variantCase : variantPart->getCases()) {
@@ -1118,11 +1807,12 @@ void SemanticAnalyzer::visit(ProcedureDeclaration& node) {
         // Add parameters to procedure symbol
         for (const auto& param : node.getParameters()) {
             DataType paramType = symbolTable_->resolveDataType(param->getType());
-            procedureSymbol->addParameter(param->getName(), paramType);
+            procedureSymbol->addParameter(param->getName(), paramType, param->getType());
         }
         
         // Define procedure using overloaded symbol table
         symbolTable_->defineOverloaded(node.getName(), procedureSymbol);
+        trackAliasRoutine(procedureSymbol.get(), node.getParameters());
         return;
     }
     
@@ -1137,12 +1827,14 @@ void SemanticAnalyzer::visit(ProcedureDeclaration& node) {
         // Add parameters to procedure symbol
         for (const auto& param : node.getParameters()) {
             DataType paramType = symbolTable_->resolveDataType(param->getType());
-            procedureSymbol->addParameter(param->getName(), paramType);
+            procedureSymbol->addParameter(param->getName(), paramType, param->getType());
         }
         
         // Define procedure in symbol table using overloaded table for consistency with forward declarations
         symbolTable_->defineOverloaded(node.getName(), procedureSymbol);
     }
+    auto routineSymbol = symbolTable_->lookupFunction(node.getName(), paramTypes);
+    trackAliasRoutine(routineSymbol.get(), node.getParameters());
     
     // Enter new scope for procedure body
     symbolTable_->enterScope();
@@ -1169,7 +1861,10 @@ void SemanticAnalyzer::visit(ProcedureDeclaration& node) {
     }
     
     // Analyze procedure body
+    const Symbol* outerRoutine = aliasRoutine_;
+    aliasRoutine_ = routineSymbol.get();
     node.getBody()->accept(*this);
+    aliasRoutine_ = outerRoutine;
     
     // Exit procedure scope
     symbolTable_->exitScope();
@@ -1207,11 +1902,12 @@ void SemanticAnalyzer::visit(FunctionDeclaration& node) {
         // Add parameters to function symbol
         for (const auto& param : node.getParameters()) {
             DataType paramType = symbolTable_->resolveDataType(param->getType());
-            functionSymbol->addParameter(param->getName(), paramType);
+            functionSymbol->addParameter(param->getName(), paramType, param->getType());
         }
         
         // Define function using overloaded symbol table
         symbolTable_->defineOverloaded(node.getName(), functionSymbol);
+        trackAliasRoutine(functionSymbol.get(), node.getParameters());
         return;
     }
     
@@ -1232,12 +1928,14 @@ void SemanticAnalyzer::visit(FunctionDeclaration& node) {
         // Add parameters to function symbol
         for (const auto& param : node.getParameters()) {
             DataType paramType = symbolTable_->resolveDataType(param->getType());
-            functionSymbol->addParameter(param->getName(), paramType);
+            functionSymbol->addParameter(param->getName(), paramType, param->getType());
         }
         
         // Define function in symbol table using overloaded table for proper overload support
         symbolTable_->defineOverloaded(node.getName(), functionSymbol);
     }
+    auto routineSymbol = symbolTable_->lookupFunction(node.getName(), paramTypes);
+    trackAliasRoutine(routineSymbol.get(), node.getParameters());
     
     // Enter new scope for function body
     symbolTable_->enterScope();
@@ -1268,7 +1966,10 @@ void SemanticAnalyzer::visit(FunctionDeclaration& node) {
     currentFunctionName_ = node.getName();
     
     // Analyze function body
+    const Symbol* outerRoutine = aliasRoutine_;
+    aliasRoutine_ = routineSymbol.get();
     node.getBody()->accept(*this);
+    aliasRoutine_ = outerRoutine;
     
     currentFunctionName_ = "";
     
@@ -1282,13 +1983,15 @@ void SemanticAnalyzer::visit(Program& node) {
         node.getUsesClause()->accept(*this);
     }
     
-    // Analyze declarations
+    // Analyze declarations; aliasing is tracked for the program's own routines
+    aliasTracking_ = true;
     for (const auto& decl : node.getDeclarations()) {
         decl->accept(*this);
     }
     
     // Analyze main block
     node.getMainBlock()->accept(*this);
+    aliasTracking_ = false;
 }
 
 void SemanticAnalyzer::addError(const std::string& message) {
@@ -1554,8 +2257,8 @@ DataType SemanticAnalyzer::getResultType(DataType left, DataType right, TokenTyp
         if (left == DataType::CUSTOM && right == DataType::CUSTOM) {
             return DataType::CUSTOM;
         }
-        // If either operand is real, result is real
-        if (left == DataType::REAL || right == DataType::REAL) {
+        // If either operand is real, result is real; '/' always gives a real
+        if (left == DataType::REAL || right == DataType::REAL || operator_ == TokenType::DIVIDE) {
             return DataType::REAL;
         }
         return DataType::INTEGER;
@@ -1692,6 +2395,7 @@ void SemanticAnalyzer::checkFunctionCall(CallExpression& node) {
     
     // Check for built-in functions first
     if (isBuiltinFunction(functionName)) {
+        trackAliasBuiltin(functionName);
         handleBuiltinFunction(functionName, node);
         return;
     }
@@ -1742,6 +2446,7 @@ void SemanticAnalyzer::checkFunctionCall(CallExpression& node) {
         currentExpressionType_ = DataType::UNKNOWN;
         return;
     }
+    trackAliasCall(symbol.get(), node.getArguments());
     
     // Special handling for built-in functions like writeln (variable arguments)
     if (functionName == "writeln" || functionName == "write" || functionName == "readln") {
@@ -1789,6 +2494,14 @@ void SemanticAnalyzer::checkFunctionCall(CallExpression& node) {
 }
 
 void SemanticAnalyzer::checkAssignment(Expression* target, Expression* value, const SourceLocation& location) {
+    trackAliasGlobal(target);
+    if (aliasTracking_ && aliasRoutine_ && !dynamic_cast<IdentifierExpression*>(target) && aliasObject(target) == "*") {
+        auto& routine = aliasRoutines_[aliasRoutine_];
+        if (routine.impurity.empty()) {
+            routine.impurity = "writes through a pointer";
+        }
+    }
+    
     // Check if target is assignable
     auto targetId = dynamic_cast<IdentifierExpression*>(target);
     auto targetField = dynamic_cast<FieldAccessExpression*>(target);
@@ -2086,10 +2799,45 @@ std::string SemanticAnalyzer::getFieldTypeFromRecord(const std::string& fieldNam
 }
 
 void SemanticAnalyzer::visit(UsesClause& node) {
-    // Load and process units
+    // Load the whole uses graph up front so independent units are parsed in parallel
+    if (!unitLoader_->loadUnitGraph(node.getUnits())) {
+        for (const auto& error : unitLoader_->getErrors()) {
+            addError(error);
+        }
+        return;
+    }
+    
+    // Unit names are case-insensitive, as in UnitLoader
+    auto lowerName = [](std::string name) {
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return name;
+    };
+    
+    // The Threads unit's critical section type is provided by the runtime
     for (const std::string& unitName : node.getUnits()) {
-        // Check if unit is a standard unit (System, Dos, Crt)
-        if (unitName == "System" || unitName == "Dos" || unitName == "Crt") {
+        if (lowerName(unitName) == "threads") {
+            auto criticalSection = std::make_shared<Symbol>("TCriticalSection", SymbolType::TYPE_DEF, DataType::CUSTOM);
+            criticalSection->setTypeDefinition("TCriticalSection");
+            symbolTable_->define("TCriticalSection", criticalSection);
+        }
+    }
+    
+    // Import units with dependencies first so a unit's interface can refer to
+    // types from the units it uses
+    std::vector<std::string> orderedUnits;
+    for (const std::string& loadedName : unitLoader_->getLoadOrder()) {
+        for (const std::string& unitName : node.getUnits()) {
+            if (lowerName(unitName) == lowerName(loadedName)) {
+                orderedUnits.push_back(unitName);
+            }
+        }
+    }
+    
+    // Load and process units
+    for (const std::string& unitName : orderedUnits) {
+        // Check if unit is a standard unit (System, Dos, Crt, Strings, Threads)
+        if (UnitLoader::isBuiltinUnit(unitName)) {
             // Built-in units are handled automatically
             continue;
         }
@@ -2118,16 +2866,16 @@ void SemanticAnalyzer::visit(UsesClause& node) {
 }
 
 void SemanticAnalyzer::visit(Unit& node) {
-    // Process interface declarations first
-    for (const auto& decl : node.getInterfaceDeclarations()) {
-        decl->accept(*this);
-    }
-    
-    // Process uses clause if present - need to cast away const
+    // Process uses clause first so the interface can refer to used units - need to cast away const
     if (node.getUsesClause()) {
         const_cast<UsesClause*>(node.getUsesClause())->accept(*this);
     }
     
+    // Process interface declarations
+    for (const auto& decl : node.getInterfaceDeclarations()) {
+        decl->accept(*this);
+    }
+    
     // Process implementation declarations
     for (const auto& decl : node.getImplementationDeclarations()) {
         decl->accept(*this);
@@ -2198,7 +2946,14 @@ bool SemanticAnalyzer::isBuiltinFunction(const std::string& functionName) {
            lowerName == "strrpos" || lowerName == "strlower" || lowerName == "strupper" ||
            lowerName == "strmove" || lowerName == "strnew" || lowerName == "strdispose" ||
            lowerName == "strpcopy" || lowerName == "strpas" || lowerName == "strscan" ||
-           lowerName == "strrscan";
+           lowerName == "strrscan" ||
+           // Threads unit functions
+           lowerName == "beginthread" || lowerName == "waitforthread" ||
+           lowerName == "initcriticalsection" || lowerName == "donecriticalsection" ||
+           lowerName == "entercriticalsection" || lowerName == "leavecriticalsection" ||
+           lowerName == "interlockedincrement" || lowerName == "interlockeddecrement" ||
+           lowerName == "interlockedexchange" || lowerName == "interlockedexchangeadd" ||
+           lowerName == "interlockedcompareexchange";
 }
 
 bool SemanticAnalyzer::isBuiltinConstant(const std::string& constantName) {
@@ -2217,16 +2972,36 @@ bool SemanticAnalyzer::isBuiltinConstant(const std::string& constantName) {
 }
 
 void SemanticAnalyzer::handleBuiltinFunction(const std::string& functionName, CallExpression& node) {
-    // Process arguments for type checking
-    for (const auto& arg : node.getArguments()) {
-        arg->accept(*this);
-    }
-    
     // Convert to lowercase for comparison
     std::string lowerName = functionName;
     std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), 
                    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
     
+    // Process arguments for type checking
+    for (size_t i = 0; i < node.getArguments().size(); ++i) {
+        Expression* arg = node.getArguments()[i].get();
+        if (i == 0 && lowerName == "beginthread") {
+            // BeginThread names the procedure to run rather than calling it; the
+            // procedure takes the thread's optional argument as its one parameter
+            bool found = false;
+            if (auto entry = dynamic_cast<IdentifierExpression*>(arg)) {
+                for (const auto& overload : symbolTable_->lookupAllOverloads(entry->getName())) {
+                    if (overload->getSymbolType() == SymbolType::PROCEDURE &&
+                        overload->getParameters().size() + 1 == node.getArguments().size()) {
+                        found = true;
+                    }
+                }
+            }
+            if (!found) {
+                addError("BeginThread expects a procedure taking " +
+                         std::string(node.getArguments().size() > 1 ? "one parameter" : "no parameters"),
+                         arg->getLocation());
+            }
+            continue;
+        }
+        arg->accept(*this);
+    }
+    
     // Set return type based on function
     if (lowerName == "writeln" || lowerName == "write" || lowerName == "readln" || lowerName == "read" ||
         lowerName == "insert" || lowerName == "delete" || lowerName == "assign" ||
@@ -2245,7 +3020,10 @@ void SemanticAnalyzer::handleBuiltinFunction(const std::string& functionName, Ca
         lowerName == "getdatetime" ||
         // Strings unit procedures (void return)
         lowerName == "strcat" || lowerName == "strcopy" || lowerName == "strmove" ||
-        lowerName == "strdispose" || lowerName == "strpcopy") {
+        lowerName == "strdispose" || lowerName == "strpcopy" ||
+        // Threads unit procedures (void return)
+        lowerName == "initcriticalsection" || lowerName == "donecriticalsection" ||
+        lowerName == "entercriticalsection" || lowerName == "leavecriticalsection") {
         currentExpressionType_ = DataType::VOID;
     } else if (lowerName == "length" || lowerName == "ord" || lowerName == "pos" ||
                lowerName == "paramcount" || lowerName == "abs" ||
@@ -2259,7 +3037,9 @@ void SemanticAnalyzer::handleBuiltinFunction(const std::string& functionName, Ca
                lowerName == "filesize" || lowerName == "getdate" || lowerName == "gettime" ||
                lowerName == "exec" ||
                // Strings unit functions returning integer
-               lowerName == "strlen" || lowerName == "strcomp" || lowerName == "stricomp") {
+               lowerName == "strlen" || lowerName == "strcomp" || lowerName == "stricomp" ||
+               // Threads unit functions returning a thread handle or status
+               lowerName == "beginthread" || lowerName == "waitforthread") {
         currentExpressionType_ = DataType::INTEGER;
     } else if (lowerName == "chr" ||
                // CRT functions returning char
@@ -2304,6 +3084,12 @@ void SemanticAnalyzer::handleBuiltinFunction(const std::string& functionName, Ca
     } else if (lowerName == "blockread" || lowerName == "blockwrite" || lowerName == "seek") {
         // File operations are procedures (void)
         currentExpressionType_ = DataType::VOID;
+    } else if (lowerName == "interlockedincrement" || lowerName == "interlockeddecrement" ||
+               lowerName == "interlockedexchange" || lowerName == "interlockedexchangeadd" ||
+               lowerName == "interlockedcompareexchange") {
+        // Interlocked operations return the target's type (integer or pointer)
+        currentExpressionType_ = node.getArguments().empty() ? DataType::UNKNOWN
+                                                             : getExpressionType(node.getArguments()[0].get());
     } else if (lowerName == "succ" || lowerName == "pred") {
         // Successor and predecessor functions return the same type as their argument
         if (!node.getArguments().empty()) {
@@ -0,0 +1,206 @@
+#include "../include/unit_cache.h"
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace rpascal {
+
+namespace {
+
+const char RPU_MAGIC[4] = {'R', 'P', 'U', '\0'};
+const uint32_t RPU_VERSION = 7;
+
+// Bounds-checked reader over the raw cache bytes
+class CacheReader {
+public:
+    CacheReader(const char* data, size_t size) : data_(data), size_(size), pos_(0) {}
+    
+    template <typename T>
+    bool readValue(T& value) {
+        if (size_ - pos_ < sizeof(T)) return false;
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+    
+    bool readString(std::string& value) {
+        uint32_t length = 0;
+        if (!readValue(length) || size_ - pos_ < length) return false;
+        value.assign(data_ + pos_, length);
+        pos_ += length;
+        return true;
+    }
+    
+    bool readBytes(char* out, size_t count) {
+        if (size_ - pos_ < count) return false;
+        std::memcpy(out, data_ + pos_, count);
+        pos_ += count;
+        return true;
+    }
+    
+    bool atEnd() const { return pos_ == size_; }
+    
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+long currentProcessId() {
+#ifndef _WIN32
+    return static_cast<long>(::getpid());
+#else
+    return static_cast<long>(::_getpid());
+#endif
+}
+
+template <typename T>
+void writeValue(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeString(std::string& out, const std::string& value) {
+    writeValue(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+bool parseEntry(const char* data, size_t size, UnitCacheEntry& entry) {
+    CacheReader reader(data, size);
+    
+    char magic[4];
+    uint32_t version = 0;
+    if (!reader.readBytes(magic, sizeof(magic)) || std::memcmp(magic, RPU_MAGIC, sizeof(magic)) != 0) {
+        return false;
+    }
+    if (!reader.readValue(version) || version != RPU_VERSION) {
+        return false;
+    }
+    if (!reader.readValue(entry.sourceHash)) {
+        return false;
+    }
+    
+    uint32_t count = 0;
+    if (!reader.readValue(count)) return false;
+    entry.tokens.clear();
+    entry.tokens.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint16_t type = 0;
+        uint32_t line = 0, column = 0, position = 0;
+        std::string value;
+        if (!reader.readValue(type) || !reader.readValue(line) ||
+            !reader.readValue(column) || !reader.readValue(position) ||
+            !reader.readString(value)) {
+            return false;
+        }
+        if (type > static_cast<uint16_t>(TokenType::INVALID)) return false;
+        entry.tokens.emplace_back(static_cast<TokenType>(type), value,
+                                  SourceLocation(line, column, position));
+    }
+    
+    return reader.atEnd();
+}
+
+} // namespace
+
+uint64_t UnitCache::hashContent(const std::string& content) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : content) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string UnitCache::cachePathFor(const std::string& sourcePath) {
+    std::filesystem::path path(sourcePath);
+    path.replace_extension(".rpu");
+    return path.string();
+}
+
+bool UnitCache::read(const std::string& cachePath, UnitCacheEntry& entry) {
+#ifndef _WIN32
+    int fd = ::open(cachePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    
+    bool ok = parseEntry(static_cast<const char*>(mapped), size, entry);
+    ::munmap(mapped, size);
+    return ok;
+#else
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parseEntry(data.data(), data.size(), entry);
+#endif
+}
+
+bool UnitCache::write(const std::string& cachePath, const UnitCacheEntry& entry) {
+    std::string out;
+    out.append(RPU_MAGIC, sizeof(RPU_MAGIC));
+    writeValue(out, RPU_VERSION);
+    writeValue(out, entry.sourceHash);
+    
+    writeValue(out, static_cast<uint32_t>(entry.tokens.size()));
+    for (const auto& token : entry.tokens) {
+        const SourceLocation& loc = token.getLocation();
+        writeValue(out, static_cast<uint16_t>(token.getType()));
+        writeValue(out, static_cast<uint32_t>(loc.line));
+        writeValue(out, static_cast<uint32_t>(loc.column));
+        writeValue(out, static_cast<uint32_t>(loc.position));
+        writeString(out, token.getValue());
+    }
+    
+    // Write to a temporary file and rename so readers never see a partial
+    // cache. The name is unique per process and call, so compilers running
+    // at once (make -j, --build workers) never share one
+    static std::atomic<unsigned> tempCounter{0};
+    std::string tempPath = cachePath + "." + std::to_string(currentProcessId()) + "." +
+                           std::to_string(tempCounter++) + ".tmp";
+    bool written;
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        file.close();
+        written = !file.fail();
+    }
+    
+    // A failed write or rename must not leave the temporary file behind
+    std::error_code ec;
+    if (written) {
+        std::filesystem::rename(tempPath, cachePath, ec);
+    }
+    if (!written || ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace rpascal
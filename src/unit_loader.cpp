@@ -1,4 +1,5 @@
 #include "../include/unit_loader.h"
+#include "../include/parallel.h"
 #include <fstream>
 #include <iostream>
 #include <filesystem>
@@ -9,7 +10,18 @@
 
 namespace rpascal {
 
-UnitLoader::UnitLoader() {
+namespace {
+
+std::string toLower(const std::string& str) {
+    std::string result = str;
+    std::transform(result.begin(), result.end(), result.begin(), 
+                   [](char c) { return static_cast<char>(std::tolower(c)); });
+    return result;
+}
+
+} // namespace
+
+UnitLoader::UnitLoader() : searchIndexBuilt_(false), cacheEnabled_(true) {
     // Add current directory as default search path
     addSearchPath(".");
     addSearchPath("./units");
@@ -18,18 +30,13 @@ UnitLoader::UnitLoader() {
 }
 
 std::unique_ptr<Unit> UnitLoader::loadUnit(const std::string& unitName) {
-    // Check if already loaded
+    // Already loaded units stay in the cache - nothing to do
     if (isUnitLoaded(unitName)) {
-        // Return a copy or reference - for now, reload to keep it simple
-        // In a real implementation, we'd return cached unit
+        return nullptr;
     }
     
     // Check if this is a built-in unit (DOS, CRT, System, etc.)
-    std::string lowerUnitName = unitName;
-    std::transform(lowerUnitName.begin(), lowerUnitName.end(), lowerUnitName.begin(), 
-                   [](char c) { return static_cast<char>(std::tolower(c)); });
-    
-    if (lowerUnitName == "dos" || lowerUnitName == "crt" || lowerUnitName == "system" || lowerUnitName == "strings") {
+    if (isBuiltinUnit(unitName)) {
         // Create a synthetic unit for built-in units
         // These units don't need actual parsing - their functions are handled by the compiler
         auto unit = std::make_unique<Unit>(unitName,
@@ -39,86 +46,298 @@ std::unique_ptr<Unit> UnitLoader::loadUnit(const std::string& unitName) {
                                          nullptr);
         
         // Store in cache
-        loadedUnits_[unitName] = std::move(unit);
+        loadedUnits_[toLower(unitName)] = std::move(unit);
         return nullptr; // Return nullptr since we moved to cache
     }
     
+    // Find, lex and parse the unit file
+    std::string unitFile;
+    std::string diagnostics;
+    auto unit = parseUnitFile(unitName, unitFile, diagnostics);
+    std::cerr << diagnostics;
+    if (!unit) {
+        return nullptr;
+    }
+    loadedUnitFiles_.push_back(unitFile);
+    unitFiles_[toLower(unitName)] = std::filesystem::absolute(unitFile).lexically_normal().string();
+    
+    // Store in cache  
+    loadedUnits_[toLower(unitName)] = std::move(unit);
+    
+    // Return nullptr since we moved to cache - caller should check isUnitLoaded()
+    return nullptr;
+}
+
+std::unique_ptr<Unit> UnitLoader::parseUnitFile(const std::string& unitName, std::string& unitFile, std::string& diagnostics) {
     // Find unit file for user-defined units
-    std::string unitFile = findUnitFile(unitName);
+    unitFile = findUnitFile(unitName);
     if (unitFile.empty()) {
-        std::cerr << "Unit file not found: " << unitName << "\n";
+        diagnostics += "Unit file not found: " + unitName + "\n";
         return nullptr;
     }
     
     // Load file content
     std::string content = loadFileContent(unitFile);
     if (content.empty()) {
-        std::cerr << "Failed to load unit file: " << unitFile << "\n";
+        diagnostics += "Failed to load unit file: " + unitFile + "\n";
         return nullptr;
     }
     
+    // Reuse the precompiled token stream when the source is unchanged
+    uint64_t sourceHash = UnitCache::hashContent(content);
+    std::string cachePath = UnitCache::cachePathFor(unitFile);
+    std::vector<Token> tokens;
+    bool fromCache = cacheEnabled_ && loadCachedTokens(cachePath, sourceHash, tokens);
+    
+    if (!fromCache) {
+        Lexer sourceLexer(content);
+        tokens = sourceLexer.tokenizeAll();
+        if (sourceLexer.hasErrors()) {
+            diagnostics += "Lexer errors in unit " + unitName + ":\n";
+            for (const auto& error : sourceLexer.getErrors()) {
+                diagnostics += "  " + error + "\n";
+            }
+            return nullptr;
+        }
+    }
+    
     // Parse unit
-    auto lexer = std::make_unique<Lexer>(content);
+    auto lexer = std::make_unique<Lexer>(fromCache ? std::move(tokens) : tokens);
     auto parser = std::make_unique<Parser>(std::move(lexer));
     
     auto unit = parser->parseUnit();
     if (parser->hasErrors()) {
-        std::cerr << "Parse errors in unit " << unitName << ":\n";
+        diagnostics += "Parse errors in unit " + unitName + ":\n";
         for (const auto& error : parser->getErrors()) {
-            std::cerr << "  " << error << "\n";
+            diagnostics += "  " + error + "\n";
         }
         return nullptr;
     }
     
-    // Store in cache  
-    loadedUnits_[unitName] = std::move(unit);
+    if (cacheEnabled_ && !fromCache && unit) {
+        writeCache(cachePath, sourceHash, std::move(tokens));
+    }
     
-    // Return nullptr since we moved to cache - caller should check isUnitLoaded()
-    return nullptr;
+    return unit;
+}
+
+bool UnitLoader::loadUnitGraph(const std::vector<std::string>& rootUnits) {
+    errors_.clear();
+    loadOrder_.clear();
+    
+    // Discover the uses graph breadth-first; each level's units are independent
+    // of each other's parse, so they are lexed and parsed concurrently
+    std::unordered_map<std::string, std::vector<std::string>> dependencies;
+    std::unordered_map<std::string, std::string> displayNames;
+    std::vector<std::string> frontier;
+    
+    auto enqueue = [&](const std::string& name, std::vector<std::string>& queue) {
+        std::string key = toLower(name);
+        if (displayNames.find(key) == displayNames.end()) {
+            displayNames[key] = name;
+            queue.push_back(name);
+        }
+    };
+    
+    for (const auto& name : rootUnits) {
+        enqueue(name, frontier);
+    }
+    
+    while (!frontier.empty()) {
+        std::vector<std::string> toParse;
+        for (const auto& name : frontier) {
+            if (isUnitLoaded(name)) {
+                continue;
+            }
+            if (isBuiltinUnit(name)) {
+                loadUnit(name);
+            } else {
+                toParse.push_back(name);
+            }
+        }
+        
+        std::vector<std::unique_ptr<Unit>> parsed(toParse.size());
+        std::vector<std::string> unitFiles(toParse.size());
+        std::vector<std::string> diagnostics(toParse.size());
+        runParallel(toParse.size(), [&](size_t i) {
+            parsed[i] = parseUnitFile(toParse[i], unitFiles[i], diagnostics[i]);
+        });
+        
+        // Publish results in a fixed order so diagnostics stay deterministic
+        for (size_t i = 0; i < toParse.size(); ++i) {
+            std::cerr << diagnostics[i];
+            if (parsed[i]) {
+                loadedUnits_[toLower(toParse[i])] = std::move(parsed[i]);
+                loadedUnitFiles_.push_back(unitFiles[i]);
+                unitFiles_[toLower(toParse[i])] = std::filesystem::absolute(unitFiles[i]).lexically_normal().string();
+            }
+        }
+        
+        std::vector<std::string> next;
+        for (const auto& name : frontier) {
+            std::vector<std::string>& deps = dependencies[toLower(name)];
+            Unit* unit = getLoadedUnit(name);
+            if (unit && unit->getUsesClause()) {
+                for (const auto& depName : unit->getUsesClause()->getUnits()) {
+                    deps.push_back(depName);
+                    enqueue(depName, next);
+                }
+            }
+        }
+        frontier = std::move(next);
+    }
+    
+    // Topological order (dependencies first), reporting the first cycle found
+    std::unordered_map<std::string, int> state;  // 0 = new, 1 = in progress, 2 = done
+    std::vector<std::string> path;
+    
+    std::function<bool(const std::string&)> visit = [&](const std::string& name) {
+        std::string key = toLower(name);
+        if (state[key] == 2) {
+            return true;
+        }
+        if (state[key] == 1) {
+            std::string cycle;
+            auto it = std::find_if(path.begin(), path.end(),
+                                   [&](const std::string& p) { return toLower(p) == key; });
+            for (; it != path.end(); ++it) {
+                cycle += *it + " -> ";
+            }
+            addError("Circular unit reference: " + cycle + name);
+            return false;
+        }
+        
+        state[key] = 1;
+        path.push_back(name);
+        for (const auto& depName : dependencies[key]) {
+            if (!visit(depName)) {
+                return false;
+            }
+        }
+        path.pop_back();
+        state[key] = 2;
+        loadOrder_.push_back(displayNames[key]);
+        return true;
+    };
+    
+    for (const auto& name : rootUnits) {
+        if (!visit(name)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool UnitLoader::isUnitLoaded(const std::string& unitName) const {
-    return loadedUnits_.find(unitName) != loadedUnits_.end();
+    return loadedUnits_.find(toLower(unitName)) != loadedUnits_.end();
+}
+
+std::string UnitLoader::getUnitFile(const std::string& unitName) const {
+    auto it = unitFiles_.find(toLower(unitName));
+    return it != unitFiles_.end() ? it->second : std::string();
 }
 
 Unit* UnitLoader::getLoadedUnit(const std::string& unitName) const {
-    auto it = loadedUnits_.find(unitName);
+    auto it = loadedUnits_.find(toLower(unitName));
     return it != loadedUnits_.end() ? it->second.get() : nullptr;
 }
 
 void UnitLoader::addSearchPath(const std::string& path) {
     searchPaths_.push_back(path);
+    searchIndexBuilt_ = false;
+}
+
+void UnitLoader::setSearchPaths(const std::vector<std::string>& paths) {
+    searchPaths_ = paths;
+    searchIndexBuilt_ = false;
 }
 
 void UnitLoader::clearUnits() {
     loadedUnits_.clear();
+    loadedUnitFiles_.clear();
+    unitFiles_.clear();
+    loadOrder_.clear();
+}
+
+void UnitLoader::addError(const std::string& error) {
+    errors_.push_back(error);
 }
 
 std::string UnitLoader::findUnitFile(const std::string& unitName) {
     // Try different file extensions and paths
     std::vector<std::string> extensions = {".pas", ".pp", ".p"};
     
-    for (const auto& searchPath : searchPaths_) {
+    // One directory listing per search path replaces a stat per candidate name
+    for (const DirectoryIndex& index : searchIndex()) {
         for (const auto& ext : extensions) {
-            std::filesystem::path fullPath = std::filesystem::path(searchPath) / (unitName + ext);
-            if (std::filesystem::exists(fullPath)) {
-                return fullPath.string();
+            auto it = index.files.find(toLower(unitName + ext));
+            if (it == index.files.end()) {
+                continue;
             }
             
-            // Also try with lowercase unit name
-            std::string lowerUnitName = unitName;
-            std::transform(lowerUnitName.begin(), lowerUnitName.end(), lowerUnitName.begin(), 
-                          [](char c) { return static_cast<char>(std::tolower(c)); });
-            std::filesystem::path lowerPath = std::filesystem::path(searchPath) / (lowerUnitName + ext);
-            if (std::filesystem::exists(lowerPath)) {
-                return lowerPath.string();
-            }
+            // Prefer the exact spelling, then any case variant
+            const std::vector<std::string>& names = it->second;
+            auto exact = std::find(names.begin(), names.end(), unitName + ext);
+            const std::string& fileName = exact != names.end() ? *exact : names.front();
+            return (std::filesystem::path(index.path) / fileName).string();
         }
     }
     
     return ""; // Not found
 }
 
+const std::vector<UnitLoader::DirectoryIndex>& UnitLoader::searchIndex() {
+    if (searchIndexBuilt_.load(std::memory_order_acquire)) {
+        return searchIndex_;
+    }
+    
+    // The first lookup reads the directories; parses running alongside it wait
+    std::lock_guard<std::mutex> lock(indexMutex_);
+    if (!searchIndexBuilt_.load(std::memory_order_relaxed)) {
+        searchIndex_.clear();
+        for (const auto& searchPath : searchPaths_) {
+            std::error_code ec;
+            if (!std::filesystem::is_directory(searchPath, ec)) {
+                continue;
+            }
+            DirectoryIndex index;
+            index.path = searchPath;
+            for (const auto& entry : std::filesystem::directory_iterator(searchPath, ec)) {
+                std::string fileName = entry.path().filename().string();
+                index.files[toLower(fileName)].push_back(fileName);
+            }
+            searchIndex_.push_back(std::move(index));
+        }
+        searchIndexBuilt_.store(true, std::memory_order_release);
+    }
+    return searchIndex_;
+}
+
+bool UnitLoader::isBuiltinUnit(const std::string& unitName) {
+    std::string lowerUnitName = toLower(unitName);
+    return lowerUnitName == "dos" || lowerUnitName == "crt" || lowerUnitName == "system" || lowerUnitName == "strings" ||
+           lowerUnitName == "threads";
+}
+
+bool UnitLoader::loadCachedTokens(const std::string& cachePath, uint64_t sourceHash, std::vector<Token>& tokens) {
+    UnitCacheEntry entry;
+    if (!UnitCache::read(cachePath, entry) || entry.sourceHash != sourceHash) {
+        return false;
+    }
+    
+    tokens = std::move(entry.tokens);
+    return true;
+}
+
+void UnitLoader::writeCache(const std::string& cachePath, uint64_t sourceHash, std::vector<Token> tokens) {
+    UnitCacheEntry entry;
+    entry.sourceHash = sourceHash;
+    entry.tokens = std::move(tokens);
+    
+    // A failed write only costs a reparse next time
+    UnitCache::write(cachePath, entry);
+}
+
 std::string UnitLoader::loadFileContent(const std::string& filePath) {
     std::ifstream file(filePath);
     if (!file.is_open()) {
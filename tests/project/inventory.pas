@@ -0,0 +1,30 @@
+unit Inventory;
+
+interface
+
+type
+  TItem = record
+    name: string;
+    quantity: integer;
+  end;
+
+function MakeItem(name: string; quantity: integer): TItem;
+procedure Restock(var item: TItem; amount: integer);
+
+implementation
+
+function MakeItem(name: string; quantity: integer): TItem;
+var
+  item: TItem;
+begin
+  item.name := name;
+  item.quantity := quantity;
+  MakeItem := item;
+end;
+
+procedure Restock(var item: TItem; amount: integer);
+begin
+  item.quantity := item.quantity + amount;
+end;
+
+end.
@@ -0,0 +1,16 @@
+unit Pricing;
+
+interface
+
+uses Inventory;
+
+function StockValue(item: TItem; unitPrice: integer): integer;
+
+implementation
+
+function StockValue(item: TItem; unitPrice: integer): integer;
+begin
+  StockValue := item.quantity * unitPrice;
+end;
+
+end.
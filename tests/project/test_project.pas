@@ -0,0 +1,21 @@
+program TestProject;
+
+{ Built by run_tests.sh with --build tests/project: each unit is compiled
+  to its own object file and the program is linked against them }
+
+uses Pricing, Inventory;
+
+var
+  bolts: TItem;
+
+begin
+  writeln('Testing a --build project:');
+  bolts := MakeItem('bolts', 40);
+  writeln(bolts.name, ': ', bolts.quantity);
+  Restock(bolts, 10);
+  writeln(bolts.name, ' after restock: ', bolts.quantity);
+  writeln('Stock value: ', StockValue(bolts, 3));
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,53 @@
+program TestAutoParallel;
+
+{ With --auto-parallel, outer for loops whose iterations are provably
+  independent run on the thread pool; loops with a carried dependence,
+  scalar updates or I/O stay serial, and the output must not change }
+
+var
+  data: array[1..20000] of integer;
+  prefix: array[1..20000] of integer;
+  mixed: array[1..20000] of integer;
+  i, total: integer;
+
+function Mix(x: integer): integer;
+begin
+  Mix := (x * x + 7) mod 1000;
+end;
+
+procedure Show(value: integer);
+begin
+  writeln('Value: ', value);
+end;
+
+begin
+  writeln('Testing --auto-parallel:');
+  
+  for i := 1 to 20000 do
+    data[i] := (i * 37) mod 101;
+  
+  prefix[1] := data[1];
+  for i := 2 to 20000 do
+    prefix[i] := prefix[i - 1] + data[i];
+  writeln('Prefix sum at 20000: ', prefix[20000]);
+  
+  total := 0;
+  for i := 1 to 20000 do
+    total := total + data[i];
+  writeln('Total: ', total);
+  
+  for i := 1 to 20000 do
+    mixed[i] := Mix(data[i]);
+  writeln('mixed[20000]: ', mixed[20000]);
+  
+  { Too few iterations to be worth a parallel loop }
+  for i := 1 to 100 do
+    mixed[i] := 0;
+  writeln('mixed[100]: ', mixed[100]);
+  
+  for i := 1 to 3 do
+    Show(data[i]);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
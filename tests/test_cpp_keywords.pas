@@ -0,0 +1,52 @@
+program TestCppKeywords;
+
+{ C++ keywords are ordinary identifiers in Pascal. The generator spells
+  them with a pas_ prefix wherever a name reaches the C++ source }
+
+const
+  static = 5;
+
+type
+  class = record
+    int: integer;
+    double: real;
+  end;
+  union = (auto, register, volatile);
+  long = array[1..3] of integer;
+
+var
+  this: class;
+  export: integer;
+  char16_t: union;
+  short: long;
+  bitand: integer;
+  signed: integer;
+
+procedure void(unsigned: integer);
+var
+  float: integer;
+begin
+  float := unsigned * 2;
+  writeln('void(', unsigned, ') doubles to ', float);
+end;
+
+function operator(template: integer): integer;
+begin
+  operator := template + static;
+end;
+
+begin
+  writeln('Testing C++ keywords as Pascal identifiers:');
+  this.int := 3;
+  this.double := 1.5;
+  with this do
+    int := int + 1;
+  signed := this.int;
+  export := operator(signed);
+  void(export);
+  char16_t := register;
+  writeln('ord(register) = ', ord(char16_t));
+  for bitand := 1 to 3 do
+    short[bitand] := bitand * static;
+  writeln('this.int = ', this.int, ', this.double = ', this.double:0:1, ', short[3] = ', short[3]);
+end.
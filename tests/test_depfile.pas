@@ -0,0 +1,18 @@
+program TestDepfile;
+
+{ Compiled with -MD: tests/test_depfile.d must list this file, both units
+  and the compiler itself }
+
+uses Geometry, ShapesBase;
+
+var
+  s: TSize;
+
+begin
+  writeln('Testing dependency file output:');
+  s := MakeSize(2, 7);
+  writeln('Perimeter: ', Perimeter(s));
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
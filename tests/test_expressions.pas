@@ -0,0 +1,57 @@
+program TestExpressions;
+
+{ Operator precedence and associativity of the expression parser }
+
+var
+  a, b, c: integer;
+  x: real;
+  p, q, r: boolean;
+  s: string;
+
+function BoolText(b: boolean): string;
+begin
+  if b then
+    BoolText := 'TRUE'
+  else
+    BoolText := 'FALSE';
+end;
+
+begin
+  writeln('Testing expression precedence:');
+  a := 20;
+  b := 6;
+  c := 3;
+  
+  writeln('20 - 6 - 3 = ', a - b - c);
+  writeln('20 div 6 div 3 = ', a div b div c);
+  writeln('2 + 3 * 4 = ', 2 + 3 * 4);
+  writeln('(2 + 3) * 4 = ', (2 + 3) * 4);
+  writeln('20 mod 6 * 3 = ', a mod b * c);
+  writeln('-6 + 20 = ', -b + a);
+  writeln('-(6 + 20) = ', -(b + a));
+  writeln('20 - 6 * 3 - 1 = ', a - b * c - 1);
+  
+  x := 1.5 + 2 * 0.25;
+  writeln('1.5 + 2 * 0.25 = ', x:0:2);
+  x := 10.0 / 4 / 5;
+  writeln('10.0 / 4 / 5 = ', x:0:2);
+  
+  p := true;
+  q := false;
+  r := not p and q;
+  writeln('not p and q = ', BoolText(r));
+  r := p or q and q;
+  writeln('p or q and q = ', BoolText(r));
+  r := not (p and q);
+  writeln('not (p and q) = ', BoolText(r));
+  r := (a > b) and (b > c);
+  writeln('(a > b) and (b > c) = ', BoolText(r));
+  r := a + 1 > b * 3;
+  writeln('a + 1 > b * 3 = ', BoolText(r));
+  
+  s := 'ab' + 'cd' + 'ef';
+  writeln('Concatenation: ', s);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
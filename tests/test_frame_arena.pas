@@ -0,0 +1,44 @@
+program TestFrameArena;
+
+{ Locals larger than --local-heap-threshold live in a per-thread arena
+  instead of on the stack. Each Fill frame below holds a 4 MB array, so
+  recursing four deep would overflow a default 8 MB stack }
+
+const
+  N = 1000000;
+
+type
+  TBuffer = array[1..1000000] of integer;
+
+var
+  total: integer;
+  calls: integer;
+
+function Fill(depth: integer): integer;
+var
+  buffer: TBuffer;
+  saved: TBuffer;
+  i, inner: integer;
+begin
+  calls := calls + 1;
+  for i := 1 to N do
+    buffer[i] := depth;
+  inner := 0;
+  if depth > 1 then
+    inner := Fill(depth - 1);
+  { The callee's frame is gone; ours must be untouched }
+  saved := buffer;
+  Fill := inner + saved[1] + saved[N];
+end;
+
+begin
+  writeln('Testing the frame arena for huge locals:');
+  calls := 0;
+  total := Fill(4);
+  writeln('Fill(4) = ', total, ' in ', calls, ' calls');
+  total := Fill(3);
+  writeln('Fill(3) = ', total, ' in ', calls, ' calls');
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,46 @@
+program TestHeapStats;
+
+{ Compiled with --heap-stats: every New and Dispose is counted per site
+  and per type, and blocks never disposed are listed as leaks at exit }
+
+type
+  PNode = ^TNode;
+  TNode = record
+    value: integer;
+    next: PNode;
+  end;
+
+var
+  head, node: PNode;
+  i, sum: integer;
+  spare: ^integer;
+
+begin
+  writeln('Testing a --heap-stats build:');
+  head := nil;
+  for i := 1 to 10 do
+  begin
+    new(node);
+    node^.value := i;
+    node^.next := head;
+    head := node;
+  end;
+  
+  sum := 0;
+  while head <> nil do
+  begin
+    node := head;
+    sum := sum + node^.value;
+    head := node^.next;
+    dispose(node);
+  end;
+  writeln('Sum of list: ', sum);
+  
+  { Deliberately leaked so the report has one leak to show }
+  new(spare);
+  spare^ := 42;
+  writeln('Spare value: ', spare^);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
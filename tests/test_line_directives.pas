@@ -0,0 +1,31 @@
+program TestLineDirectives;
+
+{ Compiled with -g: the generated C++ carries #line directives pointing
+  back at this file, and the program must behave as without them }
+
+var
+  i, total: integer;
+  name: string;
+
+procedure Greet(who: string);
+begin
+  writeln('Hello, ', who, '!');
+end;
+
+function Square(n: integer): integer;
+begin
+  Square := n * n;
+end;
+
+begin
+  writeln('Testing a -g build:');
+  name := 'debugger';
+  Greet(name);
+  total := 0;
+  for i := 1 to 5 do
+    total := total + Square(i);
+  writeln('Sum of squares 1..5: ', total);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
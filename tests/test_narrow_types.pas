@@ -0,0 +1,61 @@
+program TestNarrowTypes;
+
+{ Enumerations and subranges are stored in their narrowest integer type;
+  they must still print as numbers, promote to integer in arithmetic and
+  count to the end of their range in for loops without wrapping }
+
+type
+  TColor = (Red, Green, Blue);
+  TByteRange = 0..255;
+  TSigned = -100..100;
+  TWide = 0..65535;
+  TPixel = record
+    r, g, b: TByteRange;
+    tone: TSigned;
+    color: TColor;
+  end;
+
+var
+  b: TByteRange;
+  s: TSigned;
+  w: TWide;
+  c: TColor;
+  pixel: TPixel;
+  count, sum: integer;
+
+begin
+  writeln('Testing narrow enum and subrange storage:');
+  
+  b := 200;
+  s := -75;
+  w := 60000;
+  writeln('byte ', b, ', signed ', s, ', wide ', w);
+  writeln('byte + byte = ', b + b);
+  count := ord(s);
+  writeln('signed * 2 = ', count * 2);
+  
+  count := 0;
+  for b := 0 to 255 do
+    count := count + 1;
+  writeln('Iterations over 0..255: ', count);
+  
+  sum := 0;
+  for s := -100 to 100 do
+    sum := sum + ord(s);
+  writeln('Sum over -100..100: ', sum);
+  
+  count := 0;
+  for c := Red to Blue do
+    count := count + ord(c);
+  writeln('Sum of color ordinals: ', count);
+  
+  pixel.r := 255;
+  pixel.g := 128;
+  pixel.b := 7;
+  pixel.tone := -3;
+  pixel.color := Green;
+  writeln('pixel ', pixel.r, ' ', pixel.g, ' ', pixel.b, ' tone ', pixel.tone, ' color ', ord(pixel.color));
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
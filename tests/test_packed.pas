@@ -0,0 +1,70 @@
+program TestPacked;
+
+{ Packed records have no padding and packed arrays of booleans and
+  small subranges store a few bits per element; indexing them must
+  behave like ordinary arrays }
+
+type
+  TNibble = 0..15;
+  TLoose = record
+    flag: boolean;
+    count: integer;
+    mark: char;
+  end;
+  TTight = packed record
+    flag: boolean;
+    count: integer;
+    mark: char;
+  end;
+  TFlags = packed array[1..20] of boolean;
+  TNibbles = packed array[0..9] of TNibble;
+
+var
+  loose: TLoose;
+  tight: TTight;
+  flags: TFlags;
+  nibbles: TNibbles;
+  i, total: integer;
+
+begin
+  writeln('Testing packed records and arrays:');
+  
+  loose.flag := true;
+  loose.count := 1000;
+  loose.mark := 'L';
+  tight.flag := true;
+  tight.count := 2000;
+  tight.mark := 'T';
+  writeln('loose: ', loose.count, ' ', loose.mark);
+  writeln('tight: ', tight.count, ' ', tight.mark);
+  
+  for i := 1 to 20 do
+    flags[i] := (i mod 3) = 0;
+  total := 0;
+  for i := 1 to 20 do
+    if flags[i] then
+      total := total + 1;
+  writeln('Multiples of 3 up to 20: ', total);
+  flags[3] := false;
+  if flags[3] then
+    writeln('flags[3] still set')
+  else
+    writeln('flags[3] cleared');
+  
+  for i := 0 to 9 do
+    nibbles[i] := (i * 7) mod 16;
+  total := 0;
+  for i := 0 to 9 do
+    total := total + nibbles[i];
+  writeln('Sum of nibbles: ', total);
+  nibbles[4] := nibbles[4] + 1;
+  writeln('nibbles[3..5]: ', nibbles[3], ' ', nibbles[4], ' ', nibbles[5]);
+  inc(nibbles[4]);
+  inc(nibbles[5], 2);
+  dec(nibbles[3]);
+  dec(nibbles[6], 3);
+  writeln('After inc and dec, nibbles[3..6]: ', nibbles[3], ' ', nibbles[4], ' ', nibbles[5], ' ', nibbles[6]);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
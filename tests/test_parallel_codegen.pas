@@ -0,0 +1,82 @@
+program TestParallelCodegen;
+
+{ Same routines as test_serial_codegen.pas plus enough unused ones to
+  reach the parallel code generation threshold (8 routines); both must
+  print the same output }
+
+type
+  TPoint = record
+    x, y: integer;
+  end;
+  TPoints = {$SOA} array[1..4] of TPoint;
+
+var
+  points: TPoints;
+
+procedure Fill(var pts: TPoints);
+var
+  i: integer;
+begin
+  for i := 1 to 4 do
+  begin
+    pts[i].x := i;
+    pts[i].y := i * 10;
+  end;
+end;
+
+procedure CopyElement(var pts: TPoints; source, target: integer);
+var
+  p: TPoint;
+begin
+  p := pts[source];
+  pts[target] := p;
+end;
+
+function SumY(var pts: TPoints): integer;
+var
+  i, total: integer;
+begin
+  total := 0;
+  for i := 1 to 4 do
+    total := total + pts[i].y;
+  SumY := total;
+end;
+
+procedure Show(var pts: TPoints);
+var
+  i: integer;
+begin
+  for i := 1 to 4 do
+    with pts[i] do
+      writeln('Point ', i, ': ', x, ', ', y);
+end;
+
+procedure Unused1(var pts: TPoints);
+begin
+  pts[1].x := pts[1].y;
+end;
+
+procedure Unused2(var pts: TPoints);
+begin
+  pts[2].x := pts[2].y;
+end;
+
+procedure Unused3(var pts: TPoints);
+begin
+  pts[3].x := pts[3].y;
+end;
+
+procedure Unused4(var pts: TPoints);
+begin
+  pts[4].x := pts[4].y;
+end;
+
+begin
+  writeln('Testing routines over a {$SOA} array:');
+  Fill(points);
+  CopyElement(points, 2, 4);
+  Show(points);
+  writeln('Sum of y: ', SumY(points));
+  writeln();
+  writeln('All tests completed successfully!');
+end.
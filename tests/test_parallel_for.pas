@@ -0,0 +1,51 @@
+program TestParallelFor;
+
+{ parallel for and the PARALLEL directive run iterations on the thread
+  pool in no particular order; the results below must not depend on
+  that order or on the number of threads }
+
+var
+  squares: array[1..10000] of integer;
+  grid: array[1..10000] of integer;
+  i, j, t: integer;
+  total, smallest, largest, diagonal: integer;
+
+begin
+  writeln('Testing parallel for loops:');
+  
+  parallel for i := 1 to 10000 do
+    squares[i] := (i mod 100) * (i mod 100);
+  
+  total := 0;
+  {$PARALLEL REDUCTION(+: total) PRIVATE(t)}
+  for i := 1 to 10000 do
+  begin
+    t := squares[i] mod 7;
+    total := total + t;
+  end;
+  writeln('Sum of squares mod 7: ', total);
+  
+  smallest := 1000000;
+  largest := -1;
+  {$PARALLEL REDUCTION(min: smallest) REDUCTION(max: largest)}
+  for i := 1 to 10000 do
+  begin
+    if squares[i] + i < smallest then
+      smallest := squares[i] + i;
+    if squares[i] - i > largest then
+      largest := squares[i] - i;
+  end;
+  writeln('Smallest: ', smallest, ', largest: ', largest);
+  
+  { The inner control variable is private automatically }
+  parallel for i := 1 to 100 do
+    for j := 1 to 100 do
+      grid[(i - 1) * 100 + j] := i * j;
+  diagonal := 0;
+  for i := 1 to 100 do
+    diagonal := diagonal + grid[(i - 1) * 100 + i];
+  writeln('Sum of the diagonal: ', diagonal);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,33 @@
+program TestProfile;
+
+{ Compiled with --profile: every routine is timed and the program writes
+  a profile when it exits; its own output must not change }
+
+var
+  i, total: integer;
+
+function Fib(n: integer): integer;
+begin
+  if n < 2 then
+    Fib := n
+  else
+    Fib := Fib(n - 1) + Fib(n - 2);
+end;
+
+procedure Report(caption: string; value: integer);
+begin
+  writeln(caption, ': ', value);
+end;
+
+begin
+  writeln('Testing a --profile build:');
+  total := 0;
+  for i := 1 to 10 do
+    total := total + Fib(i);
+  Report('Sum of Fib(1..10)', total);
+  total := Fib(20);
+  Report('Fib(20)', total);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,82 @@
+program TestRealTypes;
+
+{ single, double, extended and comp keep their own precision, format
+  with :width and :width:decimals like real, and are predeclared names
+  rather than reserved words, so they can be reused as identifiers }
+
+type
+  TSample = record
+    single: integer;
+    value: double;
+  end;
+
+var
+  s: single;
+  d: double;
+  e: extended;
+  c: comp;
+  r: real;
+  i: integer;
+  sample: TSample;
+
+function Comp(a, b: integer): integer;
+begin
+  if a < b then
+    Comp := -1
+  else if a > b then
+    Comp := 1
+  else
+    Comp := 0;
+end;
+
+procedure ShowTwice(n: integer);
+var
+  double: integer;
+begin
+  double := n * 2;
+  writeln('variable named double: ', double);
+end;
+
+begin
+  writeln('Testing single, double, extended and comp:');
+  
+  s := 1.0 / 3.0;
+  d := 1.0 / 3.0;
+  e := 1.0;
+  e := e / 3.0;
+  writeln('single   ', s:0:10);
+  writeln('double   ', d:0:18);
+  writeln('extended ', e:0:18);
+  
+  c := 9007199254740993;
+  writeln('comp     ', c:0:0);
+  c := c + 2;
+  writeln('comp + 2 ', c:0:0);
+  writeln('comp written like a real: ', c);
+  
+  { '/' on integers gives a real in every real type }
+  i := 7;
+  s := i / 2;
+  d := i / 2;
+  r := i / 2;
+  e := i / 4;
+  writeln('7 / 2 as single, double, real: ', s:0:2, ' ', d:0:2, ' ', r:0:2, ', 7 / 4 extended: ', e:0:2);
+  c := 7;
+  d := c / 2;
+  writeln('comp 7 / 2 = ', d:0:2);
+  
+  r := 2.5;
+  writeln('[', r:10, ']');
+  writeln('[', d:10:4, ']');
+  writeln('[', s:8:2, ']');
+  writeln('[', e:12:6, ']');
+  
+  sample.single := 7;
+  sample.value := 0.125;
+  writeln('field named single: ', sample.single, ', value ', sample.value:0:3);
+  writeln('Comp(3, 5) = ', Comp(3, 5));
+  ShowTwice(21);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
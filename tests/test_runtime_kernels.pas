@@ -0,0 +1,114 @@
+program TestRuntimeKernels;
+
+{ The kernels of benchmarks/runtime at sizes small enough for the test
+  suite, with results that can be checked by hand }
+
+type
+  TCharSet = set of char;
+  PNode = ^TNode;
+  TNode = record
+    value: integer;
+    next: PNode;
+  end;
+
+var
+  composite: array[0..1000] of boolean;
+  i, j, count, checksum, p, value, total: integer;
+  source, line, field: string;
+  letters, digits: TCharSet;
+  identifiers, numbers: integer;
+  head, node, nextNode: PNode;
+
+begin
+  writeln('Testing the runtime benchmark kernels:');
+  
+  { Sieve: 168 primes below 1000 }
+  for i := 0 to 1000 do
+    composite[i] := false;
+  count := 0;
+  i := 2;
+  while i * i <= 1000 do
+  begin
+    if not composite[i] then
+    begin
+      j := i * i;
+      while j <= 1000 do
+      begin
+        composite[j] := true;
+        j := j + i;
+      end;
+    end;
+    i := i + 1;
+  end;
+  for i := 2 to 1000 do
+    if not composite[i] then
+      count := count + 1;
+  writeln('Primes below 1000: ', count);
+  
+  { Set-driven scanning }
+  letters := ['a'..'z', 'A'..'Z', '_'];
+  digits := ['0', '1', '2', '3', '4', '5', '6', '7', '8', '9'];
+  source := 'total := total + value_1 * (x1 - 42) / rate;';
+  identifiers := 0;
+  numbers := 0;
+  i := 1;
+  while i <= length(source) do
+  begin
+    if source[i] in letters then
+    begin
+      while (i <= length(source)) and ((source[i] in letters) or (source[i] in digits)) do
+        i := i + 1;
+      identifiers := identifiers + 1;
+    end
+    else if source[i] in digits then
+    begin
+      while (i <= length(source)) and (source[i] in digits) do
+        i := i + 1;
+      numbers := numbers + 1;
+    end
+    else
+      i := i + 1;
+  end;
+  writeln('Identifiers: ', identifiers, ', numbers: ', numbers);
+  
+  { Linked list: sum of 1..100 }
+  head := nil;
+  for i := 1 to 100 do
+  begin
+    new(node);
+    node^.value := i;
+    node^.next := head;
+    head := node;
+  end;
+  checksum := 0;
+  node := head;
+  while node <> nil do
+  begin
+    checksum := checksum + node^.value;
+    node := node^.next;
+  end;
+  while head <> nil do
+  begin
+    nextNode := head^.next;
+    dispose(head);
+    head := nextNode;
+  end;
+  writeln('List sum: ', checksum);
+  
+  { String building and parsing }
+  total := 0;
+  for i := 1 to 10 do
+  begin
+    line := 'item' + inttostr(i) + ',' + inttostr(i * 3) + ',end';
+    p := pos(',', line);
+    line := copy(line, p + 1, length(line) - p);
+    p := pos(',', line);
+    field := copy(line, 1, p - 1);
+    value := strtoint(field);
+    total := total + value;
+  end;
+  writeln('Parsed field sum: ', total);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,61 @@
+program TestSerialCodegen;
+
+{ Same routines as test_parallel_codegen.pas, but too few of them for
+  parallel code generation; both must print the same output }
+
+type
+  TPoint = record
+    x, y: integer;
+  end;
+  TPoints = {$SOA} array[1..4] of TPoint;
+
+var
+  points: TPoints;
+
+procedure Fill(var pts: TPoints);
+var
+  i: integer;
+begin
+  for i := 1 to 4 do
+  begin
+    pts[i].x := i;
+    pts[i].y := i * 10;
+  end;
+end;
+
+procedure CopyElement(var pts: TPoints; source, target: integer);
+var
+  p: TPoint;
+begin
+  p := pts[source];
+  pts[target] := p;
+end;
+
+function SumY(var pts: TPoints): integer;
+var
+  i, total: integer;
+begin
+  total := 0;
+  for i := 1 to 4 do
+    total := total + pts[i].y;
+  SumY := total;
+end;
+
+procedure Show(var pts: TPoints);
+var
+  i: integer;
+begin
+  for i := 1 to 4 do
+    with pts[i] do
+      writeln('Point ', i, ': ', x, ', ', y);
+end;
+
+begin
+  writeln('Testing routines over a {$SOA} array:');
+  Fill(points);
+  CopyElement(points, 2, 4);
+  Show(points);
+  writeln('Sum of y: ', SumY(points));
+  writeln();
+  writeln('All tests completed successfully!');
+end.
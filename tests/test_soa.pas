@@ -0,0 +1,63 @@
+program TestSoa;
+
+{ An array of records marked SOA is stored as one array per field;
+  field access, whole-element copies and with statements on elements
+  must behave exactly like an ordinary array of records }
+
+type
+  TParticle = record
+    x, y: integer;
+    mass: real;
+  end;
+  TParticles = {$SOA} array[1..8] of TParticle;
+  TPlain = array[1..8] of TParticle;
+
+var
+  soa: TParticles;
+  plain: TPlain;
+  p: TParticle;
+  i, sumX, sumY: integer;
+  totalMass: real;
+
+begin
+  writeln('Testing SOA arrays of records:');
+  
+  for i := 1 to 8 do
+  begin
+    soa[i].x := i;
+    soa[i].y := i * i;
+    soa[i].mass := i * 0.5;
+  end;
+  
+  sumX := 0;
+  sumY := 0;
+  totalMass := 0.0;
+  for i := 1 to 8 do
+  begin
+    sumX := sumX + soa[i].x;
+    sumY := sumY + soa[i].y;
+    totalMass := totalMass + soa[i].mass;
+  end;
+  writeln('Sum of x: ', sumX, ', sum of y: ', sumY, ', total mass: ', totalMass:0:1);
+  
+  { Whole-element copies in both directions }
+  p := soa[3];
+  writeln('soa[3] = ', p.x, ' ', p.y, ' ', p.mass:0:1);
+  p.x := 100;
+  soa[8] := p;
+  writeln('soa[8].x after copy: ', soa[8].x, ', y: ', soa[8].y);
+  for i := 1 to 8 do
+    plain[i] := soa[i];
+  soa[1] := plain[8];
+  writeln('soa[1] from plain[8]: ', soa[1].x, ' ', soa[1].y);
+  
+  with soa[2] do
+  begin
+    x := -2;
+    y := -4;
+  end;
+  writeln('soa[2] after with: ', soa[2].x, ' ', soa[2].y);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
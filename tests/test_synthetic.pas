@@ -0,0 +1,396 @@
+program Synthetic;
+
+{ Written by rpascal_bench --emit <dir> --procedures 10 --depth 2
+  --records 3 --units 2 --unit-functions 3; the units are in tests/units.
+  Keeps the benchmark's program shape compiling and its result fixed }
+
+uses SynUnit0, SynUnit1;
+
+type
+  TDigits = set of 0..9;
+  TRec0 = record
+    id: integer;
+    score: integer;
+    name: string;
+  end;
+  TRec1 = record
+    id: integer;
+    score: integer;
+    name: string;
+  end;
+  TRec2 = record
+    id: integer;
+    score: integer;
+    name: string;
+  end;
+
+var
+  total: integer;
+  rec0: TRec0;
+  rec1: TRec1;
+  rec2: TRec2;
+
+function Proc0(x: integer): integer;
+var
+  acc: integer;
+  i0: integer;
+  i1: integer;
+  digits: TDigits;
+begin
+  acc := 0;
+  for i0 := 1 to 3 do
+  begin
+    for i1 := 1 to 3 do
+    begin
+      if (i1 + x) mod 2 = 0 then
+        acc := acc + i1
+      else
+        acc := acc - 1;
+    end;
+  end;
+  digits := [1, 3, 5, 0];
+  case x mod 4 of
+    0: acc := acc + 1;
+    1: acc := acc - 1;
+    2: acc := acc * 2;
+  else
+    acc := acc div 2;
+  end;
+  if (x mod 10) in digits then
+    acc := acc + 3;
+  rec0.id := x;
+  rec0.score := acc;
+  acc := rec0.score + rec0.id;
+  acc := acc + Unit0Fn0(x);
+  Proc0 := acc;
+end;
+
+function Proc1(x: integer): integer;
+var
+  acc: integer;
+  i0: integer;
+  i1: integer;
+  digits: TDigits;
+begin
+  acc := 0;
+  for i0 := 1 to 3 do
+  begin
+    for i1 := 1 to 3 do
+    begin
+      if (i1 + x) mod 2 = 0 then
+        acc := acc + i1
+      else
+        acc := acc - 1;
+    end;
+  end;
+  digits := [1, 3, 5, 1];
+  case x mod 4 of
+    0: acc := acc + 1;
+    1: acc := acc - 1;
+    2: acc := acc * 2;
+  else
+    acc := acc div 2;
+  end;
+  if (x mod 10) in digits then
+    acc := acc + 3;
+  rec1.id := x;
+  rec1.score := acc;
+  acc := rec1.score + rec1.id;
+  acc := acc + Unit1Fn1(x);
+  Proc1 := acc;
+end;
+
+function Proc2(x: integer): integer;
+var
+  acc: integer;
+  i0: integer;
+  i1: integer;
+  digits: TDigits;
+begin
+  acc := 0;
+  for i0 := 1 to 3 do
+  begin
+    for i1 := 1 to 3 do
+    begin
+      if (i1 + x) mod 2 = 0 then
+        acc := acc + i1
+      else
+        acc := acc - 1;
+    end;
+  end;
+  digits := [1, 3, 5, 2];
+  case x mod 4 of
+    0: acc := acc + 1;
+    1: acc := acc - 1;
+    2: acc := acc * 2;
+  else
+    acc := acc div 2;
+  end;
+  if (x mod 10) in digits then
+    acc := acc + 3;
+  rec2.id := x;
+  rec2.score := acc;
+  acc := rec2.score + rec2.id;
+  acc := acc + Unit0Fn2(x);
+  Proc2 := acc;
+end;
+
+function Proc3(x: integer): integer;
+var
+  acc: integer;
+  i0: integer;
+  i1: integer;
+  digits: TDigits;
+begin
+  acc := 0;
+  for i0 := 1 to 3 do
+  begin
+    for i1 := 1 to 3 do
+    begin
+      if (i1 + x) mod 2 = 0 then
+        acc := acc + i1
+      else
+        acc := acc - 1;
+    end;
+  end;
+  digits := [1, 3, 5, 3];
+  case x mod 4 of
+    0: acc := acc + 1;
+    1: acc := acc - 1;
+    2: acc := acc * 2;
+  else
+    acc := acc div 2;
+  end;
+  if (x mod 10) in digits then
+    acc := acc + 3;
+  rec0.id := x;
+  rec0.score := acc;
+  acc := rec0.score + rec0.id;
+  acc := acc + Unit1Fn0(x);
+  Proc3 := acc;
+end;
+
+function Proc4(x: integer): integer;
+var
+  acc: integer;
+  i0: integer;
+  i1: integer;
+  digits: TDigits;
+begin
+  acc := 0;
+  for i0 := 1 to 3 do
+  begin
+    for i1 := 1 to 3 do
+    begin
+      if (i1 + x) mod 2 = 0 then
+        acc := acc + i1
+      else
+        acc := acc - 1;
+    end;
+  end;
+  digits := [1, 3, 5, 4];
+  case x mod 4 of
+    0: acc := acc + 1;
+    1: acc := acc - 1;
+    2: acc := acc * 2;
+  else
+    acc := acc div 2;
+  end;
+  if (x mod 10) in digits then
+    acc := acc + 3;
+  rec1.id := x;
+  rec1.score := acc;
+  acc := rec1.score + rec1.id;
+  acc := acc + Unit0Fn1(x);
+  Proc4 := acc;
+end;
+
+function Proc5(x: integer): integer;
+var
+  acc: integer;
+  i0: integer;
+  i1: integer;
+  digits: TDigits;
+begin
+  acc := 0;
+  for i0 := 1 to 3 do
+  begin
+    for i1 := 1 to 3 do
+    begin
+      if (i1 + x) mod 2 = 0 then
+        acc := acc + i1
+      else
+        acc := acc - 1;
+    end;
+  end;
+  digits := [1, 3, 5, 5];
+  case x mod 4 of
+    0: acc := acc + 1;
+    1: acc := acc - 1;
+    2: acc := acc * 2;
+  else
+    acc := acc div 2;
+  end;
+  if (x mod 10) in digits then
+    acc := acc + 3;
+  rec2.id := x;
+  rec2.score := acc;
+  acc := rec2.score + rec2.id;
+  acc := acc + Unit1Fn2(x);
+  Proc5 := acc;
+end;
+
+function Proc6(x: integer): integer;
+var
+  acc: integer;
+  i0: integer;
+  i1: integer;
+  digits: TDigits;
+begin
+  acc := 0;
+  for i0 := 1 to 3 do
+  begin
+    for i1 := 1 to 3 do
+    begin
+      if (i1 + x) mod 2 = 0 then
+        acc := acc + i1
+      else
+        acc := acc - 1;
+    end;
+  end;
+  digits := [1, 3, 5, 6];
+  case x mod 4 of
+    0: acc := acc + 1;
+    1: acc := acc - 1;
+    2: acc := acc * 2;
+  else
+    acc := acc div 2;
+  end;
+  if (x mod 10) in digits then
+    acc := acc + 3;
+  rec0.id := x;
+  rec0.score := acc;
+  acc := rec0.score + rec0.id;
+  acc := acc + Unit0Fn0(x);
+  Proc6 := acc;
+end;
+
+function Proc7(x: integer): integer;
+var
+  acc: integer;
+  i0: integer;
+  i1: integer;
+  digits: TDigits;
+begin
+  acc := 0;
+  for i0 := 1 to 3 do
+  begin
+    for i1 := 1 to 3 do
+    begin
+      if (i1 + x) mod 2 = 0 then
+        acc := acc + i1
+      else
+        acc := acc - 1;
+    end;
+  end;
+  digits := [1, 3, 5, 7];
+  case x mod 4 of
+    0: acc := acc + 1;
+    1: acc := acc - 1;
+    2: acc := acc * 2;
+  else
+    acc := acc div 2;
+  end;
+  if (x mod 10) in digits then
+    acc := acc + 3;
+  rec1.id := x;
+  rec1.score := acc;
+  acc := rec1.score + rec1.id;
+  acc := acc + Unit1Fn1(x);
+  Proc7 := acc;
+end;
+
+function Proc8(x: integer): integer;
+var
+  acc: integer;
+  i0: integer;
+  i1: integer;
+  digits: TDigits;
+begin
+  acc := 0;
+  for i0 := 1 to 3 do
+  begin
+    for i1 := 1 to 3 do
+    begin
+      if (i1 + x) mod 2 = 0 then
+        acc := acc + i1
+      else
+        acc := acc - 1;
+    end;
+  end;
+  digits := [1, 3, 5, 8];
+  case x mod 4 of
+    0: acc := acc + 1;
+    1: acc := acc - 1;
+    2: acc := acc * 2;
+  else
+    acc := acc div 2;
+  end;
+  if (x mod 10) in digits then
+    acc := acc + 3;
+  rec2.id := x;
+  rec2.score := acc;
+  acc := rec2.score + rec2.id;
+  acc := acc + Unit0Fn2(x);
+  Proc8 := acc;
+end;
+
+function Proc9(x: integer): integer;
+var
+  acc: integer;
+  i0: integer;
+  i1: integer;
+  digits: TDigits;
+begin
+  acc := 0;
+  for i0 := 1 to 3 do
+  begin
+    for i1 := 1 to 3 do
+    begin
+      if (i1 + x) mod 2 = 0 then
+        acc := acc + i1
+      else
+        acc := acc - 1;
+    end;
+  end;
+  digits := [1, 3, 5, 9];
+  case x mod 4 of
+    0: acc := acc + 1;
+    1: acc := acc - 1;
+    2: acc := acc * 2;
+  else
+    acc := acc div 2;
+  end;
+  if (x mod 10) in digits then
+    acc := acc + 3;
+  rec0.id := x;
+  rec0.score := acc;
+  acc := rec0.score + rec0.id;
+  acc := acc + Unit1Fn0(x);
+  Proc9 := acc;
+end;
+
+begin
+  total := 0;
+  total := total + Proc0(0);
+  total := total + Proc1(1);
+  total := total + Proc2(2);
+  total := total + Proc3(3);
+  total := total + Proc4(4);
+  total := total + Proc5(5);
+  total := total + Proc6(6);
+  total := total + Proc7(7);
+  total := total + Proc8(8);
+  total := total + Proc9(9);
+  writeln('total = ', total);
+end.
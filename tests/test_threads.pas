@@ -0,0 +1,71 @@
+program TestThreads;
+
+{ The Threads unit; the uses clause is lower case on purpose, since unit
+  names are case-insensitive }
+
+uses threads;
+
+var
+  hits: integer;
+  total: integer;
+  lock: TCriticalSection;
+  handles: array[1..4] of integer;
+  results: array[1..4] of integer;
+  i: integer;
+  old: integer;
+
+threadvar
+  scratch: integer;
+
+procedure Count(n: integer);
+var
+  k: integer;
+begin
+  for k := 1 to n do
+    InterlockedIncrement(hits);
+end;
+
+procedure Accumulate(id: integer);
+var
+  k: integer;
+begin
+  scratch := 0;
+  for k := 1 to 1000 do
+    scratch := scratch + id;
+  results[id] := scratch;
+  EnterCriticalSection(lock);
+  total := total + scratch;
+  LeaveCriticalSection(lock);
+end;
+
+begin
+  writeln('Testing the Threads unit:');
+  
+  hits := 0;
+  for i := 1 to 4 do
+    handles[i] := BeginThread(Count, 10000);
+  for i := 1 to 4 do
+    WaitForThread(handles[i]);
+  writeln('Interlocked hits: ', hits);
+  
+  InitCriticalSection(lock);
+  total := 0;
+  scratch := 99;
+  for i := 1 to 4 do
+    handles[i] := BeginThread(Accumulate, i);
+  for i := 1 to 4 do
+    WaitForThread(handles[i]);
+  DoneCriticalSection(lock);
+  for i := 1 to 4 do
+    writeln('Thread ', i, ' sum: ', results[i]);
+  writeln('Total under lock: ', total);
+  writeln('Main thread scratch: ', scratch);
+  
+  old := InterlockedExchange(hits, 5);
+  writeln('Exchange returned ', old, ', hits now ', hits);
+  old := InterlockedCompareExchange(hits, 7, 5);
+  writeln('Compare-exchange returned ', old, ', hits now ', hits);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
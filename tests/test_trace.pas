@@ -0,0 +1,55 @@
+program TestTrace;
+
+{ Compiled with --trace: routine calls, file operations and large
+  allocations are recorded, and the output must not change }
+
+type
+  TBig = record
+    data: array[1..20000] of integer;
+  end;
+  PBig = ^TBig;
+
+var
+  f: text;
+  line: string;
+  big: PBig;
+  i: integer;
+
+procedure WriteLines(count: integer);
+var
+  k: integer;
+begin
+  assign(f, 'test_trace.tmp');
+  rewrite(f);
+  for k := 1 to count do
+    writeln(f, 'row', k);
+  close(f);
+end;
+
+function ReadLines(count: integer): integer;
+var
+  k: integer;
+begin
+  assign(f, 'test_trace.tmp');
+  reset(f);
+  for k := 1 to count do
+    readln(f, line);
+  close(f);
+  ReadLines := count;
+end;
+
+begin
+  writeln('Testing a --trace build:');
+  WriteLines(5);
+  i := ReadLines(5);
+  writeln('Lines read back: ', i, ', last: ', line);
+  
+  new(big);
+  for i := 1 to 20000 do
+    big^.data[i] := i;
+  writeln('Last element: ', big^.data[20000]);
+  dispose(big);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,76 @@
+program TestTypeMapping;
+
+{ Type names are mapped to C++ before and after they are defined: PNode
+  refers to TNode before the record exists, and TLevel is an enum used by
+  routines declared after it }
+
+type
+  PNode = ^TNode;
+  TNode = record
+    value: integer;
+    next: PNode;
+  end;
+  TLevel = (low, medium, high);
+  TScores = array[1..3] of integer;
+
+var
+  head, node: PNode;
+  i: integer;
+  scores: TScores;
+  level: TLevel;
+
+function LevelName(l: TLevel): string;
+begin
+  case l of
+    low: LevelName := 'low';
+    medium: LevelName := 'medium';
+    high: LevelName := 'high';
+  end;
+end;
+
+function Total(var s: TScores): integer;
+var
+  k: integer;
+  sum: integer;
+begin
+  sum := 0;
+  for k := 1 to 3 do
+    sum := sum + s[k];
+  Total := sum;
+end;
+
+begin
+  writeln('Testing type mapping:');
+  
+  head := nil;
+  for i := 1 to 3 do
+  begin
+    new(node);
+    node^.value := i * 10;
+    node^.next := head;
+    head := node;
+  end;
+  node := head;
+  while node <> nil do
+  begin
+    writeln('Node: ', node^.value);
+    node := node^.next;
+  end;
+  while head <> nil do
+  begin
+    node := head^.next;
+    dispose(head);
+    head := node;
+  end;
+  
+  for level := low to high do
+    writeln('Level ', ord(level), ': ', LevelName(level));
+  
+  scores[1] := 7;
+  scores[2] := 8;
+  scores[3] := 9;
+  writeln('Total score: ', Total(scores));
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,20 @@
+program TestUnitCache;
+
+{ run_tests.sh compiles this twice: the first compile writes
+  tests/units/textstats.rpu, the second reads the unit back from it }
+
+uses TextStats;
+
+var
+  counts: TWordCount;
+
+begin
+  writeln('Testing a unit loaded through its .rpu file:');
+  counts := CountText('the quick brown fox');
+  writeln('Words: ', counts.words);
+  writeln('Letters: ', counts.letters);
+  writeln('MaxWords: ', MaxWords);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,23 @@
+program TestUnitPaths;
+
+{ Compiled with -I tests/units -I tests/unitpath. palette is found as
+  Palette.pas in the second directory; ShapesBase exists in both and the
+  first directory wins }
+
+uses palette, ShapesBase;
+
+var
+  s: TSize;
+  i: integer;
+
+begin
+  writeln('Testing unit search paths:');
+  for i := 0 to 3 do
+    writeln('Color ', i, ': ', ColorName(i));
+  s.w := 5;
+  s.h := 6;
+  writeln('Area from tests/units: ', Area(s));
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,20 @@
+program TestUnits;
+
+{ Units from tests/units, found through -I. Unit names are case-insensitive:
+  Geometry uses shapesbase, this program spells it SHAPESBASE }
+
+uses Geometry, SHAPESBASE;
+
+var
+  s: TSize;
+
+begin
+  writeln('Testing units:');
+  s := MakeSize(3, 4);
+  writeln('Size: ', s.w, ' x ', s.h);
+  writeln('Area: ', Area(s));
+  writeln('Perimeter: ', Perimeter(s));
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
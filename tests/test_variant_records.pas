@@ -0,0 +1,67 @@
+program TestVariantRecords;
+
+{ Variant cases share storage: writing through one case and reading
+  through another sees the same bytes, and string fields in a case
+  still work }
+
+type
+  TShapeKind = (skCircle, skRect);
+  TShape = record
+    name: string;
+    case kind: TShapeKind of
+      skCircle: (radius: integer);
+      skRect: (width, height: integer);
+  end;
+  
+  THalf = 0..65535;
+  TSplit = record
+    case integer of
+      0: (whole: integer);
+      1: (low, high: THalf);
+  end;
+  
+  TTagged = record
+    id: integer;
+    case isText: boolean of
+      true: (caption: string);
+      false: (amount: integer);
+  end;
+
+var
+  shape: TShape;
+  split: TSplit;
+  tagged: TTagged;
+
+begin
+  writeln('Testing variant records:');
+  
+  shape.name := 'circle';
+  shape.kind := skCircle;
+  shape.radius := 7;
+  writeln(shape.name, ' radius ', shape.radius);
+  { width overlays radius }
+  writeln('width after setting radius: ', shape.width);
+  
+  shape.name := 'rect';
+  shape.kind := skRect;
+  shape.width := 3;
+  shape.height := 4;
+  writeln(shape.name, ' area ', shape.width * shape.height);
+  writeln('radius after setting width: ', shape.radius);
+  
+  split.whole := 65536 * 5 + 9;
+  writeln('low ', split.low, ' high ', split.high);
+  split.high := 2;
+  writeln('whole after setting high: ', split.whole);
+  
+  tagged.id := 1;
+  tagged.isText := true;
+  tagged.caption := 'hello';
+  writeln('caption ', tagged.caption);
+  tagged.isText := false;
+  tagged.amount := 12;
+  writeln('amount ', tagged.amount);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,60 @@
+program TestVectorize;
+
+{ Element-wise loops are annotated for vectorisation and var array
+  parameters that never alias are declared restrict; loops with a
+  carried dependence and aliased parameters must be left alone, and
+  every loop must compute the same results either way }
+
+type
+  TVec = array[1..1000] of real;
+
+var
+  a, b, c: TVec;
+  i: integer;
+  s: real;
+
+procedure Scale(var dst: TVec; var src: TVec; k: real);
+var
+  j: integer;
+begin
+  for j := 1 to 1000 do
+    dst[j] := src[j] * k;
+end;
+
+procedure AddInto(var dst: TVec; var src: TVec);
+var
+  j: integer;
+begin
+  for j := 1 to 1000 do
+    dst[j] := dst[j] + src[j];
+end;
+
+begin
+  writeln('Testing vectorised loops:');
+  
+  for i := 1 to 1000 do
+    a[i] := i;
+  for i := 1 to 1000 do
+    b[i] := a[i] * 2.0 + 1.0;
+  s := 0.0;
+  for i := 1 to 1000 do
+    s := s + b[i];
+  writeln('Sum of b: ', s:0:1);
+  
+  { Carried dependence: each element needs the one before it }
+  for i := 2 to 1000 do
+    a[i] := a[i - 1] + 0.5;
+  writeln('a[1000] after the prefix loop: ', a[1000]:0:1);
+  
+  Scale(c, b, 0.5);
+  writeln('c[10] after Scale: ', c[10]:0:1);
+  
+  { Called with the same array twice, so no restrict for AddInto }
+  AddInto(c, c);
+  writeln('c[10] after AddInto(c, c): ', c[10]:0:1);
+  AddInto(c, b);
+  writeln('c[10] after AddInto(c, b): ', c[10]:0:1);
+  
+  writeln('');
+  writeln('All tests completed successfully!');
+end.
@@ -0,0 +1,20 @@
+unit Palette;
+
+interface
+
+function ColorName(index: integer): string;
+
+implementation
+
+function ColorName(index: integer): string;
+begin
+  case index of
+    0: ColorName := 'black';
+    1: ColorName := 'red';
+    2: ColorName := 'green';
+  else
+    ColorName := 'unknown';
+  end;
+end;
+
+end.
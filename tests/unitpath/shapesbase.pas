@@ -0,0 +1,22 @@
+unit ShapesBase;
+
+{ Shadowed by tests/units/shapesbase.pas, which comes first in the -I
+  order used by test_unit_paths }
+
+interface
+
+type
+  TSize = record
+    w, h: integer;
+  end;
+
+function Area(s: TSize): integer;
+
+implementation
+
+function Area(s: TSize): integer;
+begin
+  Area := -1;
+end;
+
+end.
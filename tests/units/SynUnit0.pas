@@ -0,0 +1,26 @@
+unit SynUnit0;
+
+interface
+
+function Unit0Fn0(x: integer): integer;
+function Unit0Fn1(x: integer): integer;
+function Unit0Fn2(x: integer): integer;
+
+implementation
+
+function Unit0Fn0(x: integer): integer;
+begin
+  Unit0Fn0 := x * 2 + 0;
+end;
+
+function Unit0Fn1(x: integer): integer;
+begin
+  Unit0Fn1 := x * 3 + 0;
+end;
+
+function Unit0Fn2(x: integer): integer;
+begin
+  Unit0Fn2 := x * 4 + 0;
+end;
+
+end.
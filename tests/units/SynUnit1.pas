@@ -0,0 +1,26 @@
+unit SynUnit1;
+
+interface
+
+function Unit1Fn0(x: integer): integer;
+function Unit1Fn1(x: integer): integer;
+function Unit1Fn2(x: integer): integer;
+
+implementation
+
+function Unit1Fn0(x: integer): integer;
+begin
+  Unit1Fn0 := x * 2 + 1;
+end;
+
+function Unit1Fn1(x: integer): integer;
+begin
+  Unit1Fn1 := x * 3 + 1;
+end;
+
+function Unit1Fn2(x: integer): integer;
+begin
+  Unit1Fn2 := x * 4 + 1;
+end;
+
+end.
@@ -0,0 +1,26 @@
+unit Geometry;
+
+interface
+
+uses shapesbase;
+
+function MakeSize(w, h: integer): TSize;
+function Perimeter(s: TSize): integer;
+
+implementation
+
+function MakeSize(w, h: integer): TSize;
+var
+  s: TSize;
+begin
+  s.w := w;
+  s.h := h;
+  MakeSize := s;
+end;
+
+function Perimeter(s: TSize): integer;
+begin
+  Perimeter := 2 * (s.w + s.h);
+end;
+
+end.
@@ -0,0 +1,19 @@
+unit ShapesBase;
+
+interface
+
+type
+  TSize = record
+    w, h: integer;
+  end;
+
+function Area(s: TSize): integer;
+
+implementation
+
+function Area(s: TSize): integer;
+begin
+  Area := s.w * s.h;
+end;
+
+end.
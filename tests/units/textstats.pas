@@ -0,0 +1,42 @@
+unit TextStats;
+
+interface
+
+const
+  MaxWords = 16;
+
+type
+  TWordCount = record
+    words: integer;
+    letters: integer;
+  end;
+
+function CountText(s: string): TWordCount;
+
+implementation
+
+function CountText(s: string): TWordCount;
+var
+  i: integer;
+  inWord: boolean;
+  result: TWordCount;
+begin
+  result.words := 0;
+  result.letters := 0;
+  inWord := false;
+  for i := 1 to length(s) do
+  begin
+    if s[i] = ' ' then
+      inWord := false
+    else
+    begin
+      result.letters := result.letters + 1;
+      if not inWord then
+        result.words := result.words + 1;
+      inWord := true;
+    end;
+  end;
+  CountText := result;
+end;
+
+end.